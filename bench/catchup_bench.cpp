@@ -0,0 +1,103 @@
+// Offline catch-up: coarse fast-forward against stepping every fixed tick.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+#include "garden.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Bed of plants over a soil grid twice its size, like the demo garden
+std::vector<PlantId> populate(Garden& g, int bedW, int bedH, float rain) {
+    g.soil.resize(bedW * 2, bedH * 2);
+    g.soil.params.rainRate = rain;
+    const std::uint16_t carrot = g.plants.addSpecies({.name = "carrot", .growthRate = 0.05f});
+    const std::uint16_t tomato = g.plants.addSpecies({.name = "tomato", .growthRate = 0.03f, .waterUse = 0.02f});
+
+    std::vector<PlantId> ids;
+    std::uint32_t rng = 1;
+    for (int y = 0; y < bedH; ++y) {
+        for (int x = 0; x < bedW; ++x) {
+            rng = rng * 1664525u + 1013904223u;
+            const float water = 0.2f + 0.8f * static_cast<float>(rng >> 8) / 16777216.f;
+            const auto tile = static_cast<std::uint32_t>(g.soil.index(x * 2, y * 2));
+            ids.push_back(g.plants.add((x + y) % 2 ? tomato : carrot, water, 1.f, tile));
+        }
+    }
+    return ids;
+}
+
+// max abs error per plant value; mean abs error over soil tiles
+struct Error {
+    double stage = 0.0, health = 0.0, water = 0.0, moisture = 0.0;
+    bool withinBounds() const { return stage < 0.15 && health < 0.05 && water < 0.05 && moisture < 0.02; }
+};
+
+// Pools reorder as plants sleep and wake, so plants are matched by id
+Error compare(const Garden& a, const Garden& b, const std::vector<PlantId>& ids) {
+    Error e;
+    for (const PlantId id : ids) {
+        const PlantState pa = a.plants.get(id);
+        const PlantState pb = b.plants.get(id);
+        e.stage = std::max(e.stage, static_cast<double>(std::fabs(pa.stage - pb.stage)));
+        e.health = std::max(e.health, static_cast<double>(std::fabs(pa.health - pb.health)));
+        e.water = std::max(e.water, static_cast<double>(std::fabs(pa.water - pb.water)));
+    }
+    const float* ma = a.soil.field(SoilGrid::Field::Moisture);
+    const float* mb = b.soil.field(SoilGrid::Field::Moisture);
+    for (int i = 0; i < a.soil.size(); ++i) e.moisture += std::fabs(ma[i] - mb[i]);
+    e.moisture /= std::max(a.soil.size(), 1);
+    return e;
+}
+
+double ms(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+}  // namespace
+
+int main() {
+    // accuracy: one simulated hour and day of the demo bed, dry and under light rain
+    std::println("accuracy vs fixed {}s ticks (48 plants; max abs error per plant, mean over soil)",
+                 Garden::kTickSeconds);
+    std::println("{:>8} {:>6} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10} {:>8}", "span", "rain", "step s", "stage",
+                 "health", "water", "moisture", "ff ms", "bounds");
+
+    for (double span : {3600.0, 86400.0}) {
+        for (float rain : {0.f, 0.01f}) {
+            Garden reference;
+            const std::vector<PlantId> ids = populate(reference, 12, 4, rain);
+            const auto steps = static_cast<std::int64_t>(std::llround(span / Garden::kTickSeconds));
+            for (std::int64_t i = 0; i < steps; ++i) reference.step();
+
+            for (float step : {60.f, 300.f, 1200.f}) {
+                Garden fast;
+                populate(fast, 12, 4, rain);
+                const auto t0 = Clock::now();
+                fast.fastForward(span, step);
+                const double elapsed = ms(t0);
+
+                const Error e = compare(reference, fast, ids);
+                std::println("{:>7.0f}h {:>6.3f} {:>8.0f} {:>10.4f} {:>10.4f} {:>10.4f} {:>10.4f} {:>10.3f} {:>8}",
+                             span / 3600.0, rain, step, e.stage, e.health, e.water, e.moisture, elapsed,
+                             e.withinBounds() ? "ok" : "OVER");
+            }
+        }
+    }
+
+    // speed: a week away must catch up in well under a second
+    std::println("\none week catch-up at the default {}s step", Garden::kCatchUpStep);
+    std::println("{:>10} {:>12} {:>10}", "plants", "ms", "budget");
+    for (int bedW : {12, 32}) {
+        Garden g;
+        populate(g, bedW, bedW == 12 ? 4 : bedW, 0.01f);
+        const auto t0 = Clock::now();
+        g.catchUpTo(1);
+        g.catchUpTo(1 + 7 * 86400);
+        const double elapsed = ms(t0);
+        std::println("{:>10} {:>12.2f} {:>10}", g.plants.size(), elapsed, elapsed < 1000.0 ? "ok" : "OVER");
+    }
+}
@@ -0,0 +1,93 @@
+// Batch math throughput: SIMD point transforms and rect overlap tests vs scalar.
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+#include "math_batch.h"
+#include "simd.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Lcg {
+    std::uint32_t state = 1;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.f;
+    }
+};
+
+template <class F>
+double bestOfMs(int reps, F&& f) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        const auto t0 = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    return best;
+}
+
+void benchTransform(int count) {
+    Lcg rng;
+    std::vector<float> x(count), y(count), sx(count), sy(count), vx(count), vy(count);
+    for (int i = 0; i < count; ++i) {
+        x[i] = rng.next() * 800.f;
+        y[i] = rng.next() * 600.f;
+    }
+    const Transform2D t = Transform2D::trs({400.f, 300.f}, 0.3f, {1.5f, 0.75f});
+
+    const double scalarMs =
+        bestOfMs(50, [&] { batch::transformPointsScalar(t, x.data(), y.data(), sx.data(), sy.data(), count); });
+    const double simdMs =
+        bestOfMs(50, [&] { batch::transformPoints(t, x.data(), y.data(), vx.data(), vy.data(), count); });
+
+    // same operations in the same order: results must be identical
+    bool same = true;
+    for (int i = 0; i < count; ++i) same = same && sx[i] == vx[i] && sy[i] == vy[i];
+    std::println("{:>10} {:>12.3f} {:>12.3f} {:>9.2f}x {:>14.0f}{}", count, scalarMs, simdMs, scalarMs / simdMs,
+                 count / (simdMs / 1000.0) / 1e6, same ? "" : "  MISMATCH");
+}
+
+void benchOverlap(int count) {
+    Lcg rng;
+    std::vector<float> x(count), y(count), w(count), h(count);
+    for (int i = 0; i < count; ++i) {
+        x[i] = rng.next() * 4000.f;
+        y[i] = rng.next() * 4000.f;
+        w[i] = 8.f + rng.next() * 24.f;
+        h[i] = 8.f + rng.next() * 24.f;
+    }
+    // roughly a screen's worth of a larger world
+    const Rect view{1000.f, 1000.f, 800.f, 600.f};
+    std::vector<int> a(count), b(count);
+    int foundScalar = 0, foundSimd = 0;
+
+    const double scalarMs = bestOfMs(50, [&] {
+        foundScalar = batch::overlappingScalar(view, x.data(), y.data(), w.data(), h.data(), count, a.data());
+    });
+    const double simdMs = bestOfMs(50, [&] {
+        foundSimd = batch::overlapping(view, x.data(), y.data(), w.data(), h.data(), count, b.data());
+    });
+
+    bool same = foundScalar == foundSimd;
+    for (int i = 0; same && i < foundSimd; ++i) same = a[i] == b[i];
+    std::println("{:>10} {:>12.3f} {:>12.3f} {:>9.2f}x {:>14.0f} {:>8}{}", count, scalarMs, simdMs, scalarMs / simdMs,
+                 count / (simdMs / 1000.0) / 1e6, foundSimd, same ? "" : "  MISMATCH");
+}
+}  // namespace
+
+int main() {
+    std::println("batch math benchmark ({} path, best of 50 runs)", simd::kName);
+
+    std::println("\ntransformPoints");
+    std::println("{:>10} {:>12} {:>12} {:>10} {:>14}", "points", "scalar ms", "simd ms", "speedup", "Mpoints/sec");
+    for (int count : {1000, 10000, 100000, 1000000}) benchTransform(count);
+
+    std::println("\noverlapping");
+    std::println("{:>10} {:>12} {:>12} {:>10} {:>14} {:>8}", "rects", "scalar ms", "simd ms", "speedup", "Mrects/sec",
+                 "visible");
+    for (int count : {1000, 10000, 100000, 1000000}) benchOverlap(count);
+}
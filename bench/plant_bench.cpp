@@ -0,0 +1,68 @@
+// Plant simulation throughput: SIMD tick vs the scalar reference.
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <print>
+
+#include "plants.h"
+#include "simd.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+void populate(PlantSim& sim, int count) {
+    sim.clear();
+    if (sim.speciesCount() == 0) {
+        sim.addSpecies({.name = "carrot", .growthRate = 0.05f});
+        sim.addSpecies({.name = "tomato", .growthRate = 0.03f, .waterUse = 0.02f});
+        sim.addSpecies({.name = "sunflower", .growthRate = 0.02f, .maxStage = 6.f});
+        sim.addSpecies({.name = "lettuce", .growthRate = 0.08f, .wiltThreshold = 0.5f});
+    }
+
+    std::uint32_t rng = 1;
+    for (int i = 0; i < count; ++i) {
+        rng = rng * 1664525u + 1013904223u;
+        const float water = static_cast<float>(rng >> 8) / 16777216.f;
+        sim.add(static_cast<std::uint16_t>(i % sim.speciesCount()), water, 1.f - water * 0.5f);
+    }
+}
+
+template <class F>
+double bestOfMs(int reps, F&& f) {
+    double best = 1e30;
+    for (int r = 0; r < reps; ++r) {
+        const auto t0 = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    }
+    return best;
+}
+}  // namespace
+
+int main() {
+    std::println("plant tick benchmark ({} path, best of 50 ticks)", simd::kName);
+    std::println("{:>10} {:>12} {:>12} {:>10} {:>16}", "plants", "scalar ms", "simd ms", "speedup", "plants/sec");
+
+    for (int count : {10000, 100000, 250000, 500000, 1000000}) {
+        PlantSim scalar, vectorized;
+        populate(scalar, count);
+        populate(vectorized, count);
+
+        const double scalarMs = bestOfMs(50, [&] { scalar.tickScalar(0.1f); });
+        const double simdMs = bestOfMs(50, [&] { vectorized.tick(0.1f); });
+
+        // both paths must agree (same operations, same order)
+        double maxErr = 0.0;
+        for (int s = 0; s < scalar.speciesCount(); ++s) {
+            const auto& a = scalar.pool(static_cast<std::uint16_t>(s));
+            const auto& b = vectorized.pool(static_cast<std::uint16_t>(s));
+            for (int i = 0; i < a.size(); ++i) {
+                maxErr = std::max(maxErr, static_cast<double>(std::fabs(a.stage[i] - b.stage[i])));
+                maxErr = std::max(maxErr, static_cast<double>(std::fabs(a.health[i] - b.health[i])));
+            }
+        }
+
+        std::println("{:>10} {:>12.3f} {:>12.3f} {:>9.2f}x {:>16.0f}{}", count, scalarMs, simdMs, scalarMs / simdMs,
+                     count / (simdMs / 1000.0), maxErr > 1e-5 ? "  MISMATCH" : "");
+    }
+}
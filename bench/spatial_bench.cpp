@@ -0,0 +1,203 @@
+// Spatial index queries vs brute force: uniform grid hash and loose quadtree.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <print>
+#include <vector>
+
+#include "math_batch.h"
+#include "spatial.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Lcg {
+    std::uint32_t state = 1;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.f;
+    }
+};
+
+double msSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Entities at a constant density (about one per 40x40 px), 8-32 px across
+struct World {
+    float side;
+    std::vector<SpatialEntry> entries;
+    std::vector<float> x, y, w, h;  // same rects, for the brute-force scans
+
+    explicit World(int count) : side(40.f * std::sqrt(static_cast<float>(count))) {
+        Lcg rng;
+        for (int i = 0; i < count; ++i) {
+            const Rect r{rng.next() * side, rng.next() * side, 8.f + rng.next() * 24.f, 8.f + rng.next() * 24.f};
+            entries.push_back({static_cast<std::uint32_t>(i), r});
+        }
+        sync();
+    }
+
+    // move a tenth of them a little, like a frame of critters wandering
+    std::vector<SpatialEntry> step(Lcg& rng) {
+        std::vector<SpatialEntry> moved;
+        for (std::size_t i = 0; i < entries.size(); i += 10) {
+            entries[i].bounds.x += (rng.next() - 0.5f) * 8.f;
+            entries[i].bounds.y += (rng.next() - 0.5f) * 8.f;
+            moved.push_back(entries[i]);
+        }
+        sync();
+        return moved;
+    }
+
+    void sync() {
+        x.resize(entries.size());
+        y.resize(entries.size());
+        w.resize(entries.size());
+        h.resize(entries.size());
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            x[i] = entries[i].bounds.x;
+            y[i] = entries[i].bounds.y;
+            w[i] = entries[i].bounds.w;
+            h[i] = entries[i].bounds.h;
+        }
+    }
+};
+
+struct Queries {
+    std::vector<Rect> views;   // camera culling
+    std::vector<Vec2> points;  // what is under the cursor
+    std::vector<Vec2> circles; // plants within watering radius
+    static constexpr float kRadius = 48.f;
+
+    Queries(float side, int count) {
+        Lcg rng;
+        rng.state = 7;
+        for (int i = 0; i < count; ++i) {
+            views.push_back({rng.next() * (side - 800.f), rng.next() * (side - 600.f), 800.f, 600.f});
+            points.push_back({rng.next() * side, rng.next() * side});
+            circles.push_back({rng.next() * side, rng.next() * side});
+        }
+    }
+};
+
+// Runs every query and returns a checksum of what came back (count and id sum) so the
+// indexes can be compared with brute force
+struct Totals {
+    std::uint64_t found = 0, idSum = 0;
+    void add(const std::vector<std::uint32_t>& ids) {
+        found += ids.size();
+        for (std::uint32_t id : ids) idSum += id;
+    }
+    bool operator==(const Totals&) const = default;
+};
+
+template <class Index>
+Totals runQueries(const Index& index, const Queries& q, double& viewMs, double& pointMs, double& circleMs) {
+    Totals t;
+    std::vector<std::uint32_t> out;
+    auto t0 = Clock::now();
+    for (const Rect& v : q.views) {
+        out.clear();
+        index.query(v, out);
+        t.add(out);
+    }
+    viewMs = msSince(t0);
+    t0 = Clock::now();
+    for (Vec2 p : q.points) {
+        out.clear();
+        index.queryPoint(p, out);
+        t.add(out);
+    }
+    pointMs = msSince(t0);
+    t0 = Clock::now();
+    for (Vec2 c : q.circles) {
+        out.clear();
+        index.queryRadius(c, Queries::kRadius, out);
+        t.add(out);
+    }
+    circleMs = msSince(t0);
+    return t;
+}
+
+Totals bruteForce(const World& world, const Queries& q, double& viewMs, double& pointMs, double& circleMs) {
+    Totals t;
+    const int n = static_cast<int>(world.entries.size());
+    std::vector<int> hits(n);
+    std::vector<std::uint32_t> out;
+    auto t0 = Clock::now();
+    for (const Rect& v : q.views) {
+        out.clear();
+        const int found = batch::overlapping(v, world.x.data(), world.y.data(), world.w.data(), world.h.data(), n,
+                                             hits.data());
+        out.assign(hits.begin(), hits.begin() + found);
+        t.add(out);
+    }
+    viewMs = msSince(t0);
+    t0 = Clock::now();
+    for (Vec2 p : q.points) {
+        out.clear();
+        for (const SpatialEntry& e : world.entries)
+            if (contains(e.bounds, p)) out.push_back(e.id);
+        t.add(out);
+    }
+    pointMs = msSince(t0);
+    t0 = Clock::now();
+    for (Vec2 c : q.circles) {
+        out.clear();
+        for (const SpatialEntry& e : world.entries) {
+            const Vec2 nearest{std::clamp(c.x, e.bounds.x, e.bounds.x + e.bounds.w),
+                               std::clamp(c.y, e.bounds.y, e.bounds.y + e.bounds.h)};
+            if (lengthSquared(c - nearest) <= Queries::kRadius * Queries::kRadius) out.push_back(e.id);
+        }
+        t.add(out);
+    }
+    circleMs = msSince(t0);
+    return t;
+}
+
+void row(const char* name, double buildMs, double updateMs, double viewMs, double pointMs, double circleMs,
+         bool match) {
+    std::println("  {:<12} {:>10.2f} {:>10.3f} {:>10.3f} {:>10.3f} {:>10.3f}{}", name, buildMs, updateMs, viewMs,
+                 pointMs, circleMs, match ? "" : "  MISMATCH");
+}
+}  // namespace
+
+int main() {
+    constexpr int kQueries = 100;
+    std::println("spatial index benchmark, {} queries of each kind (ms for all of them)", kQueries);
+
+    for (int count : {10000, 100000, 1000000}) {
+        World world(count);
+        const Queries queries(world.side, kQueries);
+        std::println("\n{} entities, {:.0f} px world", count, world.side);
+        std::println("  {:<12} {:>10} {:>10} {:>10} {:>10} {:>10}", "", "build", "update", "view", "point", "radius");
+
+        SpatialHash hash(64.f);
+        LooseQuadtree tree({0.f, 0.f, world.side, world.side});
+        auto t0 = Clock::now();
+        hash.insert(world.entries);
+        const double hashBuild = msSince(t0);
+        t0 = Clock::now();
+        tree.insert(world.entries);
+        const double treeBuild = msSince(t0);
+
+        Lcg rng;
+        const std::vector<SpatialEntry> moved = world.step(rng);
+        t0 = Clock::now();
+        hash.update(moved);
+        const double hashUpdate = msSince(t0);
+        t0 = Clock::now();
+        tree.update(moved);
+        const double treeUpdate = msSince(t0);
+
+        double view, point, circle;
+        const Totals expected = bruteForce(world, queries, view, point, circle);
+        row("brute force", 0.0, 0.0, view, point, circle, true);
+        const Totals fromHash = runQueries(hash, queries, view, point, circle);
+        row("grid hash", hashBuild, hashUpdate, view, point, circle, fromHash == expected);
+        const Totals fromTree = runQueries(tree, queries, view, point, circle);
+        row("quadtree", treeBuild, treeUpdate, view, point, circle, fromTree == expected);
+    }
+}
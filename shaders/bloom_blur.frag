@@ -0,0 +1,21 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uTex;
+uniform vec2 uStep;  // one texel along the blur direction
+
+// 9-tap Gaussian in 5 fetches: the outer pairs sample between texels and let linear
+// filtering weigh them
+const float kOffsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+const float kWeights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+
+void main() {
+    vec3 c = texture(uTex, vUV).rgb * kWeights[0];
+    for (int i = 1; i < 3; ++i) {
+        c += texture(uTex, vUV + uStep * kOffsets[i]).rgb * kWeights[i];
+        c += texture(uTex, vUV - uStep * kOffsets[i]).rgb * kWeights[i];
+    }
+    FragColor = vec4(c, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uTex;
+uniform float uThreshold;
+
+void main() {
+    vec3 c = texture(uTex, vUV).rgb;
+    float luma = dot(c, vec3(0.2126, 0.7152, 0.0722));
+    // soft knee, so the glow does not switch on abruptly
+    float glow = smoothstep(uThreshold, uThreshold + 0.2, luma);
+    FragColor = vec4(c * glow, 1.0);
+}
\ No newline at end of file
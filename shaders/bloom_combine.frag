@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uTex;
+uniform sampler2D uBloom;
+uniform float uIntensity;
+
+void main() {
+    vec3 c = texture(uTex, vUV).rgb + texture(uBloom, vUV).rgb * uIntensity;
+    FragColor = vec4(c, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D uLights;    // two texels per light: (x, y, radius, intensity), (r, g, b, -)
+uniform usampler2D uTiles;    // per tile: first entry in uEntries, count
+uniform usampler2D uEntries;  // light indices, tile after tile
+uniform vec2 uPixelScale;     // window px per light buffer px
+uniform float uWindowH;
+uniform float uTileSize;
+uniform vec3 uAmbient;
+
+const int kDataWidth = 256;   // texels per row of uLights and uEntries
+
+ivec2 texel(uint i) {
+    return ivec2(int(i) % kDataWidth, int(i) / kDataWidth);
+}
+
+void main() {
+    // window pixels from the top left, like the lights themselves
+    vec2 px = vec2(gl_FragCoord.x * uPixelScale.x, uWindowH - gl_FragCoord.y * uPixelScale.y);
+    ivec2 tile = clamp(ivec2(px / uTileSize), ivec2(0), textureSize(uTiles, 0) - 1);
+    uvec2 range = texelFetch(uTiles, tile, 0).xy;
+
+    vec3 light = uAmbient;
+    for (uint k = 0u; k < range.y; ++k) {
+        uint i = texelFetch(uEntries, texel(range.x + k), 0).x;
+        vec4 shape = texelFetch(uLights, texel(2u * i), 0);
+        vec3 color = texelFetch(uLights, texel(2u * i + 1u), 0).rgb;
+        // smooth falloff to exactly zero at the radius
+        float d = length(px - shape.xy) / shape.z;
+        float falloff = clamp(1.0 - d * d, 0.0, 1.0);
+        light += color * (shape.w * falloff * falloff);
+    }
+    FragColor = vec4(light, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#version 330 core
+
+layout (location = 0) in vec2 vertPos;
+
+void main() {
+    // the unit quad stretched over the whole target
+    gl_Position = vec4(vertPos * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330 core
+
+in float vFade;
+
+out vec4 FragColor;
+
+uniform vec4 uColor;
+
+void main() {
+    FragColor = vec4(uColor.rgb, uColor.a * vFade);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 330 core
+
+layout (location = 0) in vec2 vertPos;
+
+// per instance, each from its own array of the particle pool
+layout (location = 2) in float instX;
+layout (location = 3) in float instY;
+layout (location = 4) in float instAge;  // 0 at birth, 1 at death
+
+uniform vec2 uViewport;  // window size in pixels
+uniform float uSize;
+
+out float vFade;
+
+void main() {
+    // the same pixel -> NDC mapping fillRect feeds shape.vert, for a uSize square
+    vec2 scale = vec2(uSize) / uViewport;
+    vec2 pos = vec2(-1.0 + instX / uViewport.x * 2.0, 1.0 - instY / uViewport.y * 2.0 - scale.y);
+    gl_Position = vec4(vertPos.x * scale.x + pos.x, vertPos.y * scale.y - pos.y, 0.0, 1.0);
+    vFade = 1.0 - instAge;
+}
\ No newline at end of file
@@ -0,0 +1,11 @@
+#version 330 core
+
+layout (location = 0) in vec2 vertPos;
+
+out vec2 vUV;
+
+void main() {
+    // the unit quad stretched over the whole target, sampling the whole source
+    gl_Position = vec4(vertPos * 2.0 - 1.0, 0.0, 1.0);
+    vUV = vertPos;
+}
\ No newline at end of file
@@ -0,0 +1,10 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uTex;
+
+void main() {
+    FragColor = vec4(texture(uTex, vUV).rgb, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uTex;
+uniform float uExposure;
+uniform float uContrast;
+uniform float uSaturation;
+uniform vec3 uTint;
+
+void main() {
+    vec3 c = texture(uTex, vUV).rgb * uExposure;
+    c = (c - 0.5) * uContrast + 0.5;
+    float luma = dot(c, vec3(0.2126, 0.7152, 0.0722));
+    c = mix(vec3(luma), c, uSaturation) * uTint;
+    FragColor = vec4(clamp(c, 0.0, 1.0), 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+
+uniform sampler2D uTex;
+uniform float uStrength;
+uniform float uRadius;  // where darkening starts, 1 = the corners
+
+void main() {
+    // 0 at the center, 1 at the corners
+    float d = length(vUV - 0.5) * 1.41421356;
+    float shade = 1.0 - uStrength * smoothstep(uRadius, 1.0 + (1.0 - uRadius), d);
+    FragColor = vec4(texture(uTex, vUV).rgb * shade, 1.0);
+}
\ No newline at end of file
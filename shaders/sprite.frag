@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+in vec4 vTint;
+in float vDistanceField;
+
+uniform sampler2D uTex;
+
+void main() {
+    vec4 texColor = texture(uTex, vUV);
+    if (vDistanceField > 0.5) {
+        // alpha is the distance to the glyph edge, 0.5 on it: antialias over about a pixel
+        float w = max(fwidth(texColor.a) * 0.5, 1e-4);
+        texColor.a = smoothstep(0.5 - w, 0.5 + w, texColor.a);
+    }
+    FragColor = texColor * vTint;
+}
\ No newline at end of file
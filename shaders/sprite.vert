@@ -0,0 +1,24 @@
+#version 330 core
+
+layout (location = 0) in vec2 vertPos;  // already in clip space (SpriteBatch)
+
+layout (location = 1) in vec2 texCoords;
+
+layout (location = 2) in vec4 tint;
+
+layout (location = 3) in float distanceField;
+
+layout (location = 4) in float layer;  // texture array layer; unused by sprite.frag
+
+out vec2 vUV;
+out vec4 vTint;
+out float vDistanceField;
+out float vLayer;
+
+void main() {
+    gl_Position = vec4(vertPos, 0.0, 1.0);
+    vUV = texCoords;
+    vTint = tint;
+    vDistanceField = distanceField;
+    vLayer = layer;
+}
\ No newline at end of file
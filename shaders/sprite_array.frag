@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 vUV;
+in vec4 vTint;
+in float vLayer;
+
+uniform sampler2DArray uTex;
+
+void main() {
+    FragColor = texture(uTex, vec3(vUV, vLayer)) * vTint;
+}
\ No newline at end of file
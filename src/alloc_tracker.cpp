@@ -0,0 +1,392 @@
+#include "alloc_tracker.h"
+
+#include <cstring>
+
+#include "imgui.h"
+
+#if ENABLE_ALLOC_TRACKING
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <print>
+#include <stacktrace>
+#include <unordered_map>
+#include <vector>
+#endif
+
+AllocTracker& AllocTracker::instance() {
+    ALLOC_TAG(Static);
+    static AllocTracker inst;
+    return inst;
+}
+
+AllocCounter& AllocTracker::counter(const char* name) {
+    for (AllocCounter& c : counters)
+        if (std::strcmp(c.name, name) == 0) return c;
+    ALLOC_TAG(Static);
+    AllocCounter& c = counters.emplace_back();
+    c.name = name;
+    return c;
+}
+
+void AllocTracker::beginFrame() {
+#if ENABLE_ALLOC_TRACKING
+    HeapTracking::beginFrame();
+#endif
+    for (AllocCounter& c : counters) {
+        c.lastAllocs = c.allocs;
+        c.lastBytes = c.bytes;
+        c.allocs = c.bytes = 0;
+    }
+}
+
+void AllocTracker::drawDebugUI() {
+    for (const AllocCounter& c : counters) {
+        ImGui::Text("%-10s %4zu allocs %8.1f KB / frame, %8.1f KB live", c.name, c.lastAllocs, c.lastBytes / 1024.0,
+                    c.liveBytes / 1024.0);
+    }
+#if ENABLE_ALLOC_TRACKING
+    ImGui::Text("%-10s %4zu allocs %8.1f KB / frame", "heap", HeapTracking::lastFrameAllocs(),
+                HeapTracking::lastFrameBytes() / 1024.0);
+    for (int t = 0; t < static_cast<int>(AllocTag::Count); ++t) {
+        const auto tag = static_cast<AllocTag>(t);
+        const HeapTracking::TagStats stats = HeapTracking::tagStats(tag);
+        ImGui::Text("  %-8s %6zu blocks %8.1f KB live", HeapTracking::tagName(tag), stats.liveBlocks,
+                    stats.liveBytes / 1024.0);
+    }
+#endif
+}
+
+#if ENABLE_ALLOC_TRACKING
+
+// ----------------------------- heap tracking --------------------------
+
+namespace {
+constexpr int kTagCount = static_cast<int>(AllocTag::Count);
+constexpr std::size_t kStackDepth = 12;
+constexpr std::size_t kStackSlots = 4096;  // power of two
+constexpr std::uint32_t kNoStack = ~0u;
+constexpr int kReportStacks = 16;
+
+// In front of every block; a multiple of 16 so the block after it stays aligned
+struct alignas(16) BlockHeader {
+    BlockHeader* prev;
+    BlockHeader* next;
+    std::size_t size;
+    std::uint64_t sequence;
+    std::uint32_t offset;  // from what malloc returned to this header
+    std::uint32_t stack;
+    AllocTag tag;
+    bool linked;  // on the live list
+};
+
+// Deduplicated call stacks, only ever added to. Entries are the raw return addresses;
+// they are resolved to names only for the leak report.
+struct StackRecord {
+    std::size_t hash = 0;
+    std::uint32_t depth = 0;
+    std::array<std::stacktrace_entry, kStackDepth> frames;
+};
+
+// The tracker's own allocations must not come back through operator new
+template <class T>
+struct MallocAllocator {
+    using value_type = T;
+
+    MallocAllocator() = default;
+    template <class U>
+    MallocAllocator(const MallocAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        if (void* p = std::malloc(n * sizeof(T))) return static_cast<T*>(p);
+        throw std::bad_alloc();
+    }
+    void deallocate(T* p, std::size_t) { std::free(p); }
+
+    template <class U>
+    bool operator==(const MallocAllocator<U>&) const {
+        return true;
+    }
+};
+
+// Everything below is constant-initialized, so it works before main and after exit
+std::mutex heapMutex;
+BlockHeader* liveHead = nullptr;
+StackRecord stacks[kStackSlots];
+std::uint32_t stackCount = 0;
+
+std::atomic<std::uint64_t> nextSequence{0};
+std::atomic<std::size_t> frameAllocs{0}, frameBytes{0}, prevFrameAllocs{0}, prevFrameBytes{0};
+std::atomic<std::size_t> tagBytes[kTagCount], tagBlocks[kTagCount];
+
+thread_local AllocTag threadTag = AllocTag::General;
+// set while the tracker itself runs (capturing or printing stacks); such allocations
+// get a header but are not tracked
+thread_local bool inTracker = false;
+
+BlockHeader* headerOf(void* p) {
+    return static_cast<BlockHeader*>(p) - 1;
+}
+
+std::uint32_t captureStack() {
+    using Trace = std::basic_stacktrace<MallocAllocator<std::stacktrace_entry>>;
+    const Trace trace = Trace::current(1, kStackDepth);
+    if (trace.empty()) return kNoStack;
+
+    std::size_t hash = 1469598103934665603ull;
+    for (const std::stacktrace_entry& frame : trace)
+        hash = (hash ^ std::hash<std::stacktrace_entry>{}(frame)) * 1099511628211ull;
+
+    // open addressing; a full table just stops recording new stacks
+    for (std::size_t i = 0; i < kStackSlots; ++i) {
+        const std::size_t slot = (hash + i) & (kStackSlots - 1);
+        StackRecord& record = stacks[slot];
+        if (record.depth == 0) {
+            if (stackCount + 1 >= kStackSlots) return kNoStack;
+            ++stackCount;
+            record.hash = hash;
+            record.depth = static_cast<std::uint32_t>(trace.size());
+            std::copy(trace.begin(), trace.end(), record.frames.begin());
+            return static_cast<std::uint32_t>(slot);
+        }
+        if (record.hash == hash) return static_cast<std::uint32_t>(slot);
+    }
+    return kNoStack;
+}
+
+void* trackedAllocate(std::size_t size, AllocTag tag, std::size_t align) {
+    align = std::max(align, alignof(BlockHeader));
+    const std::size_t extra = align > alignof(BlockHeader) ? align : 0;
+    void* base = std::malloc(sizeof(BlockHeader) + size + extra);
+    if (!base) return nullptr;
+
+    const auto start = reinterpret_cast<std::uintptr_t>(base) + sizeof(BlockHeader);
+    auto* p = reinterpret_cast<void*>((start + align - 1) & ~(align - 1));
+    BlockHeader* h = headerOf(p);
+    h->size = size;
+    h->offset = static_cast<std::uint32_t>(reinterpret_cast<char*>(h) - static_cast<char*>(base));
+    h->tag = tag;
+    h->linked = false;
+    if (inTracker) return p;
+
+    inTracker = true;
+    h->sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    frameAllocs.fetch_add(1, std::memory_order_relaxed);
+    frameBytes.fetch_add(size, std::memory_order_relaxed);
+    tagBytes[static_cast<int>(tag)].fetch_add(size, std::memory_order_relaxed);
+    tagBlocks[static_cast<int>(tag)].fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard lock(heapMutex);
+        h->stack = captureStack();
+        h->prev = nullptr;
+        h->next = liveHead;
+        if (liveHead) liveHead->prev = h;
+        liveHead = h;
+        h->linked = true;
+    }
+    inTracker = false;
+    return p;
+}
+
+void trackedRelease(void* p) {
+    if (!p) return;
+    BlockHeader* h = headerOf(p);
+    if (h->linked) {
+        tagBytes[static_cast<int>(h->tag)].fetch_sub(h->size, std::memory_order_relaxed);
+        tagBlocks[static_cast<int>(h->tag)].fetch_sub(1, std::memory_order_relaxed);
+        std::lock_guard lock(heapMutex);
+        if (h->prev) h->prev->next = h->next;
+        else liveHead = h->next;
+        if (h->next) h->next->prev = h->prev;
+    }
+    std::free(reinterpret_cast<char*>(h) - h->offset);
+}
+
+void* newOrThrow(std::size_t size, std::size_t align) {
+    if (void* p = trackedAllocate(size, threadTag, align)) return p;
+    throw std::bad_alloc();
+}
+}  // namespace
+
+void* HeapTracking::allocate(std::size_t size, AllocTag tag, std::size_t align) {
+    return trackedAllocate(size, tag, align);
+}
+
+void* HeapTracking::reallocate(void* p, std::size_t size) {
+    if (!p) return trackedAllocate(size, threadTag, alignof(std::max_align_t));
+    const BlockHeader* h = headerOf(p);
+    void* q = trackedAllocate(size, h->tag, alignof(std::max_align_t));
+    if (!q) return nullptr;
+    std::memcpy(q, p, std::min(size, h->size));
+    trackedRelease(p);
+    return q;
+}
+
+void HeapTracking::release(void* p) {
+    trackedRelease(p);
+}
+
+AllocTag HeapTracking::currentTag() {
+    return threadTag;
+}
+
+void HeapTracking::setCurrentTag(AllocTag tag) {
+    threadTag = tag;
+}
+
+const char* HeapTracking::tagName(AllocTag tag) {
+    static const char* const kNames[] = {"general", "renderer", "textures", "scenes", "imgui", "garden", "static"};
+    static_assert(std::size(kNames) == kTagCount);
+    return kNames[static_cast<int>(tag)];
+}
+
+void HeapTracking::beginFrame() {
+    prevFrameAllocs.store(frameAllocs.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    prevFrameBytes.store(frameBytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+std::size_t HeapTracking::lastFrameAllocs() {
+    return prevFrameAllocs.load(std::memory_order_relaxed);
+}
+
+std::size_t HeapTracking::lastFrameBytes() {
+    return prevFrameBytes.load(std::memory_order_relaxed);
+}
+
+HeapTracking::TagStats HeapTracking::tagStats(AllocTag tag) {
+    const int t = static_cast<int>(tag);
+    return {tagBytes[t].load(std::memory_order_relaxed), tagBlocks[t].load(std::memory_order_relaxed)};
+}
+
+std::uint64_t HeapTracking::sequence() {
+    return nextSequence.load(std::memory_order_relaxed);
+}
+
+void HeapTracking::reportLeaks(std::uint64_t baseline) {
+    struct Leak {
+        std::uint32_t stack;
+        AllocTag tag;
+        std::size_t bytes = 0;
+        std::size_t blocks = 0;
+    };
+
+    inTracker = true;
+    std::vector<Leak> leaks;
+    std::size_t totalBytes = 0, totalBlocks = 0;
+    {
+        std::lock_guard lock(heapMutex);
+        std::unordered_map<std::uint64_t, std::size_t> byStack;
+        for (const BlockHeader* h = liveHead; h; h = h->next) {
+            if (h->sequence < baseline || h->tag == AllocTag::Static) continue;
+            const std::uint64_t key = (std::uint64_t{h->stack} << 8) | static_cast<std::uint8_t>(h->tag);
+            const auto [it, added] = byStack.try_emplace(key, leaks.size());
+            if (added) leaks.push_back({h->stack, h->tag});
+            leaks[it->second].bytes += h->size;
+            ++leaks[it->second].blocks;
+            totalBytes += h->size;
+            ++totalBlocks;
+        }
+    }
+
+    if (totalBlocks == 0) {
+        std::println(stderr, "Heap: no leaks");
+        inTracker = false;
+        return;
+    }
+
+    std::sort(leaks.begin(), leaks.end(), [](const Leak& a, const Leak& b) { return a.bytes > b.bytes; });
+    std::println(stderr, "Heap: {} blocks, {:.1f} KB still live from {} call sites", totalBlocks, totalBytes / 1024.0,
+                 leaks.size());
+    for (std::size_t i = 0; i < leaks.size() && i < kReportStacks; ++i) {
+        const Leak& leak = leaks[i];
+        std::println(stderr, "  {} bytes in {} blocks [{}]", leak.bytes, leak.blocks, tagName(leak.tag));
+        if (leak.stack == kNoStack) {
+            std::println(stderr, "    (no stack recorded)");
+            continue;
+        }
+        const StackRecord& record = stacks[leak.stack];
+        for (std::uint32_t f = 0; f < record.depth; ++f) {
+            const std::stacktrace_entry& frame = record.frames[f];
+            if (frame.description().empty())
+                std::println(stderr, "    {:#x}", frame.native_handle());
+            else
+                std::println(stderr, "    {} {}:{}", frame.description(), frame.source_file(), frame.source_line());
+        }
+    }
+    inTracker = false;
+}
+
+LeakCheck::LeakCheck() : baseline(HeapTracking::sequence()) {}
+
+LeakCheck::~LeakCheck() {
+    HeapTracking::reportLeaks(baseline);
+}
+
+// ----------------------------- operator new/delete -----------------------
+
+void* operator new(std::size_t size) {
+    return newOrThrow(size, alignof(std::max_align_t));
+}
+void* operator new[](std::size_t size) {
+    return newOrThrow(size, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    return newOrThrow(size, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align) {
+    return newOrThrow(size, static_cast<std::size_t>(align));
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size, threadTag, alignof(std::max_align_t));
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size, threadTag, alignof(std::max_align_t));
+}
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size, threadTag, static_cast<std::size_t>(align));
+}
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return trackedAllocate(size, threadTag, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* p) noexcept {
+    trackedRelease(p);
+}
+void operator delete[](void* p) noexcept {
+    trackedRelease(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+    trackedRelease(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+    trackedRelease(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept {
+    trackedRelease(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept {
+    trackedRelease(p);
+}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    trackedRelease(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    trackedRelease(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    trackedRelease(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    trackedRelease(p);
+}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    trackedRelease(p);
+}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+    trackedRelease(p);
+}
+
+#endif  // ENABLE_ALLOC_TRACKING
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+// Build with -DENABLE_ALLOC_TRACKING=1 (make ALLOC_TRACKING=1) to route every heap
+// allocation through HeapTracking. Off by default: then none of it is compiled in.
+#ifndef ENABLE_ALLOC_TRACKING
+#define ENABLE_ALLOC_TRACKING 0
+#endif
+
+// Allocation counts for one allocator or subsystem: this frame, the last complete
+// frame, and bytes still live. Main thread only.
+struct AllocCounter {
+    const char* name = "";
+    std::size_t allocs = 0;
+    std::size_t bytes = 0;
+    std::size_t lastAllocs = 0;
+    std::size_t lastBytes = 0;
+    std::size_t liveBytes = 0;
+
+    void onAlloc(std::size_t n) {
+        ++allocs;
+        bytes += n;
+        liveBytes += n;
+    }
+    void onFree(std::size_t n) { liveBytes -= n; }
+};
+
+// Named AllocCounters rolled over once per frame and shown in the Debug window, to see
+// which allocations (if any) the frame loop still makes.
+class AllocTracker {
+   public:
+    // Singleton access
+    static AllocTracker& instance();
+
+    // Delete copy/move
+    AllocTracker(const AllocTracker&) = delete;
+    AllocTracker& operator=(const AllocTracker&) = delete;
+    AllocTracker(AllocTracker&&) = delete;
+    AllocTracker& operator=(AllocTracker&&) = delete;
+
+    // Find or add; the reference stays valid for the program's lifetime
+    AllocCounter& counter(const char* name);
+
+    void beginFrame();
+
+    // ImGui rows (call between ImGui::Begin/End)
+    void drawDebugUI();
+
+   private:
+    AllocTracker() = default;
+
+    std::deque<AllocCounter> counters;
+};
+
+// std allocator that counts into an AllocCounter
+template <class T>
+struct TrackingAllocator {
+    using value_type = T;
+
+    AllocCounter* counter;
+
+    explicit TrackingAllocator(AllocCounter& counter) : counter(&counter) {}
+    template <class U>
+    TrackingAllocator(const TrackingAllocator<U>& other) : counter(other.counter) {}
+
+    T* allocate(std::size_t n) {
+        counter->onAlloc(n * sizeof(T));
+        return std::allocator<T>{}.allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) {
+        counter->onFree(n * sizeof(T));
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <class U>
+    bool operator==(const TrackingAllocator<U>& other) const {
+        return counter == other.counter;
+    }
+};
+
+// Subsystem a heap allocation is charged to in the tracking build. Static is for
+// singletons that live until exit (job queue, trace buffers, these counters): they are
+// still alive when the leak check runs, so it skips them.
+enum class AllocTag : std::uint8_t { General, Renderer, Textures, Scenes, ImGui, Garden, Static, Count };
+
+// Marks the start of the heap baseline when constructed and, in the tracking build,
+// prints every allocation made since then that is still live when destroyed, other
+// than AllocTag::Static ones. Does nothing otherwise.
+class LeakCheck {
+   public:
+#if ENABLE_ALLOC_TRACKING
+    LeakCheck();
+    ~LeakCheck();
+
+   private:
+    std::uint64_t baseline;
+#endif
+};
+
+#if ENABLE_ALLOC_TRACKING
+// Global heap tracking. operator new/delete (and ImGui's and stb_image's allocators) put
+// a small header in front of every block and keep it on a live list with its size, the
+// calling thread's current AllocTag and its call stack, deduplicated into a table.
+namespace HeapTracking {
+struct TagStats {
+    std::size_t liveBytes = 0;
+    std::size_t liveBlocks = 0;
+};
+
+void* allocate(std::size_t size, AllocTag tag, std::size_t align = alignof(std::max_align_t));
+void* reallocate(void* p, std::size_t size);
+void release(void* p);
+
+AllocTag currentTag();
+void setCurrentTag(AllocTag tag);
+const char* tagName(AllocTag tag);
+
+// Roll the per-frame counters over (AllocTracker::beginFrame does this)
+void beginFrame();
+std::size_t lastFrameAllocs();
+std::size_t lastFrameBytes();
+TagStats tagStats(AllocTag tag);
+
+// Allocations are numbered; reportLeaks prints those from baseline on that are still
+// live, grouped by call stack, largest first
+std::uint64_t sequence();
+void reportLeaks(std::uint64_t baseline);
+}  // namespace HeapTracking
+
+// Charges the calling thread's allocations to a tag until the end of the scope
+class AllocTagScope {
+   public:
+    explicit AllocTagScope(AllocTag tag) : previous(HeapTracking::currentTag()) { HeapTracking::setCurrentTag(tag); }
+    ~AllocTagScope() { HeapTracking::setCurrentTag(previous); }
+
+    AllocTagScope(const AllocTagScope&) = delete;
+    AllocTagScope& operator=(const AllocTagScope&) = delete;
+
+   private:
+    AllocTag previous;
+};
+
+#define ALLOC_TAG_CONCAT_INNER(a, b) a##b
+#define ALLOC_TAG_CONCAT(a, b) ALLOC_TAG_CONCAT_INNER(a, b)
+#define ALLOC_TAG(tag) AllocTagScope ALLOC_TAG_CONCAT(allocTag_, __LINE__)(AllocTag::tag)
+#else
+#define ALLOC_TAG(tag) ((void)0)
+#endif
@@ -0,0 +1,116 @@
+#include "animation.h"
+
+#include <algorithm>
+#include <cmath>
+
+Rect FlipbookAtlas::frameUV(int frame) const {
+    const float w = 1.f / static_cast<float>(columns);
+    const float h = 1.f / static_cast<float>(rows);
+    const int col = frame % columns;
+    const int row = frame / columns;
+    // images load flipped (v up), so the top row sits at v = 1 - h
+    return {static_cast<float>(col) * w, 1.f - static_cast<float>(row + 1) * h, w, h};
+}
+
+// ----------------------------- clips ---------------------------------
+
+AnimationSystem::ClipId AnimationSystem::addClip(const AnimationClip& clip) {
+    ClipInfo info{clip.firstFrame, std::max(clip.frameCount, 1), clip.fps, clip.loop, 1,
+                  static_cast<std::uint32_t>(events.size()), static_cast<std::uint32_t>(clip.events.size())};
+    if (info.loop == LoopMode::Loop) info.period = info.frameCount;
+    if (info.loop == LoopMode::PingPong) info.period = std::max(2 * info.frameCount - 2, 1);
+
+    clips.push_back(clip);
+    clipInfo.push_back(info);
+    events.insert(events.end(), clip.events.begin(), clip.events.end());
+    return static_cast<ClipId>(clips.size() - 1);
+}
+
+int AnimationSystem::frameAt(const ClipInfo& c, int step) const {
+    switch (c.loop) {
+        case LoopMode::Once:
+            return c.firstFrame + std::min(step, c.frameCount - 1);
+        case LoopMode::Loop:
+            return c.firstFrame + step % c.period;
+        case LoopMode::PingPong: {
+            const int k = step % c.period;
+            return c.firstFrame + (k < c.frameCount ? k : c.period - k);
+        }
+    }
+    return c.firstFrame;
+}
+
+// ----------------------------- animations ----------------------------
+
+std::uint32_t AnimationSystem::add(ClipId clip, float speed, float startTime) {
+    std::uint32_t id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = static_cast<std::uint32_t>(clipOf.size());
+        clipOf.emplace_back();
+        times.emplace_back();
+        speeds.emplace_back();
+        steps.emplace_back();
+        frames.emplace_back();
+        playing.emplace_back();
+    }
+    speeds[id] = speed;
+    play(id, clip, startTime);
+    ++live;
+    return id;
+}
+
+void AnimationSystem::remove(std::uint32_t animation) {
+    if (animation >= clipOf.size() || clipOf[animation] == kNoClip) return;
+    clipOf[animation] = kNoClip;
+    playing[animation] = 0;
+    freeIds.push_back(animation);
+    --live;
+}
+
+void AnimationSystem::play(std::uint32_t animation, ClipId clip, float startTime) {
+    clipOf[animation] = clip;
+    times[animation] = startTime;
+    steps[animation] = -1;
+    frames[animation] = clipInfo[clip].firstFrame;
+    playing[animation] = 1;
+}
+
+void AnimationSystem::update(float dt, std::vector<AnimationEvent>* raised) {
+    const std::size_t count = clipOf.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (!playing[i]) continue;
+        const ClipInfo& c = clipInfo[clipOf[i]];
+
+        float t = times[i] + dt * speeds[i];
+        int step = std::max(static_cast<int>(std::floor(t * c.fps)), 0);
+        const int prev = steps[i];
+        if (c.loop == LoopMode::Once && step >= c.frameCount) {
+            step = c.frameCount - 1;
+            playing[i] = 0;
+        }
+
+        // every frame entered since the last update raises its events; a long dt
+        // visits each frame of the cycle at most once
+        if (raised && c.eventCount > 0 && step > prev) {
+            const int first = std::max(prev + 1, step - c.period + 1);
+            for (int s = first; s <= step; ++s) {
+                const int local = frameAt(c, s) - c.firstFrame;
+                for (std::uint32_t e = c.firstEvent; e < c.firstEvent + c.eventCount; ++e)
+                    if (events[e].frame == local) raised->push_back({static_cast<std::uint32_t>(i), events[e].id});
+            }
+        }
+
+        // keep looping clocks small, so float time does not lose precision over a session
+        if (c.loop != LoopMode::Once && step >= c.period) {
+            const int cycles = step / c.period;
+            t = std::max(t - static_cast<float>(cycles * c.period) / c.fps, 0.f);
+            step -= cycles * c.period;
+        }
+        times[i] = t;
+        steps[i] = step;
+        frames[i] = frameAt(c, step);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "util.h"
+
+// Equal-sized frames laid out in a grid in one texture, numbered row by row from the
+// image's top left
+struct FlipbookAtlas {
+    int columns = 1;
+    int rows = 1;
+
+    // {u, v, width, height} of one frame, for Renderer::drawSprite
+    Rect frameUV(int frame) const;
+};
+
+enum class LoopMode : std::uint8_t {
+    Once,      // stops on the last frame
+    Loop,      // first frame again after the last
+    PingPong,  // forwards, then backwards, without repeating the end frames
+};
+
+// Raised when playback enters a frame, e.g. a footstep or the top of a sway
+struct ClipEvent {
+    int frame;  // within the clip, 0 is firstFrame
+    std::uint32_t id;
+};
+
+// A run of consecutive atlas frames played at a fixed rate
+struct AnimationClip {
+    const char* name = "clip";
+    int firstFrame = 0;  // in the atlas
+    int frameCount = 1;
+    float fps = 10.f;
+    LoopMode loop = LoopMode::Loop;
+    std::vector<ClipEvent> events = {};
+};
+
+struct AnimationEvent {
+    std::uint32_t animation;
+    std::uint32_t id;  // ClipEvent::id
+};
+
+// Every playing animation, advanced together. State lives in parallel arrays indexed by
+// animation id, and update() is one pass over them against a flat clip table: no
+// per-object virtual calls, and each result is just an atlas frame index for the draw
+// code to turn into a UV sub-rect (FlipbookAtlas::frameUV), so thousands of animated
+// sprites sharing an atlas still go out in one batch.
+class AnimationSystem {
+   public:
+    using ClipId = std::uint16_t;
+
+    ClipId addClip(const AnimationClip& clip);
+    const AnimationClip& clip(ClipId id) const { return clips[id]; }
+
+    // speed scales the clip's fps (>= 0); startTime offsets it, so a field of the
+    // same clip does not move in lockstep
+    std::uint32_t add(ClipId clip, float speed = 1.f, float startTime = 0.f);
+    void remove(std::uint32_t animation);
+    // Restart on another (or the same) clip
+    void play(std::uint32_t animation, ClipId clip, float startTime = 0.f);
+    void setSpeed(std::uint32_t animation, float speed) { speeds[animation] = speed; }
+
+    // Advance everything by dt; events raised along the way are appended to events
+    void update(float dt, std::vector<AnimationEvent>* events = nullptr);
+
+    int frame(std::uint32_t animation) const { return frames[animation]; }  // atlas frame
+    std::span<const int> allFrames() const { return frames; }                // by id
+    bool finished(std::uint32_t animation) const { return !playing[animation]; }
+    int size() const { return live; }
+
+   private:
+    static constexpr ClipId kNoClip = 0xffff;  // a removed animation's slot
+
+    // what update() needs of a clip, with its events flattened into one array
+    struct ClipInfo {
+        int firstFrame, frameCount;
+        float fps;
+        LoopMode loop;
+        int period;  // steps before the frame sequence repeats
+        std::uint32_t firstEvent, eventCount;
+    };
+
+    int frameAt(const ClipInfo& c, int step) const;
+
+    std::vector<AnimationClip> clips;
+    std::vector<ClipInfo> clipInfo;
+    std::vector<ClipEvent> events;  // every clip's, grouped by clip
+
+    // by animation id
+    std::vector<ClipId> clipOf;
+    std::vector<float> times;     // seconds into the clip
+    std::vector<float> speeds;
+    std::vector<int> steps;       // frames entered so far, -1 before the first update
+    std::vector<int> frames;
+    std::vector<std::uint8_t> playing;
+    std::vector<std::uint32_t> freeIds;
+    int live = 0;
+};
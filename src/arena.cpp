@@ -0,0 +1,101 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+constexpr std::size_t alignUp(std::size_t v, std::size_t align) {
+    return (v + align - 1) & ~(align - 1);
+}
+}  // namespace
+
+void* ResourceArena::allocate(std::size_t size, std::size_t align) {
+    constexpr std::size_t kHeader = alignUp(sizeof(Block), alignof(std::max_align_t));
+
+    if (blocks) {
+        const auto base = reinterpret_cast<std::uintptr_t>(blocks) + kHeader;
+        const std::size_t offset = alignUp(base + blocks->offset, align) - base;
+        if (offset + size <= blocks->size) {
+            blocks->offset = offset + size;
+            used += size;
+            return reinterpret_cast<void*>(base + offset);
+        }
+    }
+
+    // new block; oversized requests get a block of their own
+    const std::size_t capacity = std::max(blockSize, size + align);
+    void* mem = ::operator new(kHeader + capacity);
+    blocks = new (mem) Block{blocks, capacity, 0};
+    reserved += capacity;
+
+    const auto base = reinterpret_cast<std::uintptr_t>(blocks) + kHeader;
+    const std::size_t offset = alignUp(base, align) - base;
+    blocks->offset = offset + size;
+    used += size;
+    return reinterpret_cast<void*>(base + offset);
+}
+
+void ResourceArena::release() {
+    // destructors run newest first, like a stack unwinding
+    for (Destructor* d = destructors; d; d = d->next) d->fn(d->obj);
+    destructors = nullptr;
+
+    while (blocks) {
+        Block* next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+    used = reserved = 0;
+}
+
+// ----------------------------- frame arena ---------------------------
+
+FrameArena::FrameArena(std::size_t capacity) {
+    main = static_cast<std::byte*>(::operator new(capacity));
+    mainSize = capacity;
+    current = main;
+    currentSize = capacity;
+}
+
+FrameArena::~FrameArena() {
+    for (std::byte* block : overflow) ::operator delete(block);
+    ::operator delete(main);
+}
+
+void* FrameArena::allocate(std::size_t size, std::size_t align) {
+    ++allocs;
+    used += size;
+
+    const auto base = reinterpret_cast<std::uintptr_t>(current);
+    std::size_t start = alignUp(base + offset, align) - base;
+    if (start + size > currentSize) {
+        // overflow until the next reset grows the main block
+        const std::size_t capacity = std::max(mainSize, size + align);
+        current = static_cast<std::byte*>(::operator new(capacity));
+        currentSize = capacity;
+        overflow.push_back(current);
+        overflowBytes += capacity;
+        const auto fresh = reinterpret_cast<std::uintptr_t>(current);
+        start = alignUp(fresh, align) - fresh;
+    }
+    offset = start + size;
+    return current + start;
+}
+
+void FrameArena::reset() {
+    if (!overflow.empty()) {
+        for (std::byte* block : overflow) ::operator delete(block);
+        ::operator delete(main);
+        mainSize += overflowBytes;
+        main = static_cast<std::byte*>(::operator new(mainSize));
+        overflow.clear();
+        overflowBytes = 0;
+    }
+    current = main;
+    currentSize = mainSize;
+    offset = 0;
+
+    lastUsed = used;
+    lastAllocs = allocs;
+    used = allocs = 0;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Chunked bump allocator that owns the objects made in it.
+// Everything is destroyed (in reverse order) and freed in one shot by release().
+class ResourceArena {
+   public:
+    explicit ResourceArena(std::size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    ~ResourceArena() { release(); }
+
+    // non-copyable, non-movable (objects point into it)
+    ResourceArena(const ResourceArena&) = delete;
+    ResourceArena& operator=(const ResourceArena&) = delete;
+    ResourceArena(ResourceArena&&) = delete;
+    ResourceArena& operator=(ResourceArena&&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+    template <class T, class... Args>
+    T& make(Args&&... args) {
+        T* obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            auto* d = new (allocate(sizeof(Destructor), alignof(Destructor)))
+                Destructor{[](void* p) { static_cast<T*>(p)->~T(); }, obj, destructors};
+            destructors = d;
+        }
+        return *obj;
+    }
+
+    void release();
+
+    std::size_t bytesUsed() const { return used; }
+    std::size_t bytesReserved() const { return reserved; }
+
+   private:
+    struct Block {
+        Block* next;
+        std::size_t size;
+        std::size_t offset;
+    };
+
+    struct Destructor {
+        void (*fn)(void*);
+        void* obj;
+        Destructor* next;
+    };
+
+    std::size_t blockSize;
+    Block* blocks = nullptr;
+    Destructor* destructors = nullptr;
+    std::size_t used = 0;
+    std::size_t reserved = 0;
+};
+
+// Linear allocator for data that only lives until the end of the frame: allocating is a
+// pointer bump and reset() drops everything at once. Nothing is destroyed, so only
+// trivially destructible data belongs here. Running out chains overflow blocks; the next
+// reset replaces them with one block of the combined size, so a steady frame never
+// touches the heap.
+class FrameArena {
+   public:
+    explicit FrameArena(std::size_t capacity = 256 * 1024);
+    ~FrameArena();
+
+    // non-copyable, non-movable (frame data points into it)
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+    FrameArena(FrameArena&&) = delete;
+    FrameArena& operator=(FrameArena&&) = delete;
+
+    void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+    template <class T>
+    T* allocateArray(std::size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "frame data is never destroyed");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset();
+
+    // this frame so far, and the last complete frame
+    std::size_t bytesUsed() const { return used; }
+    std::size_t allocations() const { return allocs; }
+    std::size_t lastFrameBytes() const { return lastUsed; }
+    std::size_t lastFrameAllocations() const { return lastAllocs; }
+    std::size_t capacity() const { return mainSize; }
+
+   private:
+    std::byte* main = nullptr;
+    std::size_t mainSize = 0;
+    std::byte* current = nullptr;  // main, or the newest overflow block
+    std::size_t currentSize = 0;
+    std::size_t offset = 0;
+    std::vector<std::byte*> overflow;
+    std::size_t overflowBytes = 0;
+
+    std::size_t used = 0, allocs = 0;
+    std::size_t lastUsed = 0, lastAllocs = 0;
+};
+
+// Fixed-size slots for objects of one type that are created and destroyed often and must
+// keep their address (RenderTargetPool's targets). create/destroy pop and push a free
+// list; memory grows a chunk of kChunk slots at a time and is only returned when the pool
+// dies. Objects still alive then are not destroyed.
+template <class T, std::size_t kChunk = 256>
+class ObjectPool {
+   public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template <class... Args>
+    T* create(Args&&... args) {
+        if (!freeList) grow();
+        Slot* slot = freeList;
+        freeList = slot->next;
+        ++live;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(T* obj) {
+        if (!obj) return;
+        obj->~T();
+        Slot* slot = reinterpret_cast<Slot*>(obj);
+        slot->next = freeList;
+        freeList = slot;
+        --live;
+    }
+
+    std::size_t size() const { return live; }
+    std::size_t capacity() const { return chunks.size() * kChunk; }
+
+   private:
+    union Slot {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    void grow() {
+        auto& chunk = chunks.emplace_back(std::make_unique<Slot[]>(kChunk));
+        // threaded so the first slot is handed out first
+        for (std::size_t i = kChunk; i-- > 0;) {
+            chunk[i].next = freeList;
+            freeList = &chunk[i];
+        }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    Slot* freeList = nullptr;
+    std::size_t live = 0;
+};
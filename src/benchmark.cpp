@@ -0,0 +1,616 @@
+#include "benchmark.h"
+
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <functional>
+#include <memory>
+#include <print>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "animation.h"
+#include "cached_layer.h"
+#include "font.h"
+#include "lighting.h"
+#include "particles.h"
+#include "post_process.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "scene.h"
+#include "ui.h"
+#include "util.h"
+
+// ----------------------------- utils ---------------------------------
+
+namespace {
+// deterministic so every run draws the exact same frames
+struct Lcg {
+    unsigned int state = 12345u;
+    float next() {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / 16777216.f;
+    }
+};
+
+constexpr float kFixedDt = 1.f / 60.f;
+constexpr float kViewW = 800.f;
+constexpr float kViewH = 600.f;
+
+struct Sprite {
+    Rect rect;
+    Vec2 vel;
+    Color color;
+};
+
+std::vector<Sprite> makeSprites(int count, float size) {
+    Lcg rng;
+    std::vector<Sprite> sprites(count);
+    for (Sprite& s : sprites) {
+        s.rect = {rng.next() * (kViewW - size), rng.next() * (kViewH - size), size, size};
+        s.vel = {(rng.next() - 0.5f) * 200.f, (rng.next() - 0.5f) * 200.f};
+        s.color = {rng.next(), rng.next(), rng.next(), 1.f};
+    }
+    return sprites;
+}
+
+void moveSprites(std::vector<Sprite>& sprites, float dt) {
+    for (Sprite& s : sprites) {
+        s.rect.x += s.vel.x * dt;
+        s.rect.y += s.vel.y * dt;
+        if (s.rect.x < 0.f || s.rect.x > kViewW - s.rect.w) s.vel.x = -s.vel.x;
+        if (s.rect.y < 0.f || s.rect.y > kViewH - s.rect.h) s.vel.y = -s.vel.y;
+    }
+}
+}  // namespace
+
+// ----------------------------- scripted scenes -----------------------
+
+namespace {
+// N untextured sprites
+class SpriteBenchScene : public Scene {
+   public:
+    explicit SpriteBenchScene(int count) : sprites(makeSprites(count, 16.f)) {}
+    void update(float dt) override { moveSprites(sprites, dt); }
+    void draw(Renderer& r) override {
+        r.useShader(r.shapeShader);
+        for (const Sprite& s : sprites) {
+            r.setColor(s.color);
+            r.fillRect(s.rect);
+        }
+    }
+
+   private:
+    std::vector<Sprite> sprites;
+};
+
+// N textured sprites sharing one texture
+class TexturedSpriteBenchScene : public Scene {
+   public:
+    explicit TexturedSpriteBenchScene(int count) : sprites(makeSprites(count, 32.f)) {}
+    void update(float dt) override { moveSprites(sprites, dt); }
+    void draw(Renderer& r) override {
+        r.useShader(r.textureShader);
+        r.setColor({1, 1, 1, 1});
+        for (const Sprite& s : sprites) r.fillTextureRect(s.rect, texture);
+    }
+
+   private:
+    std::vector<Sprite> sprites;
+    Texture texture = Texture("textures/texture_01.png");
+};
+
+// N textured sprites animating through a 4x4 flipbook, batched: one draw call where
+// textured_sprites_N makes N
+class AnimatedSpriteBenchScene : public Scene {
+   public:
+    explicit AnimatedSpriteBenchScene(int count) : sprites(makeSprites(count, 32.f)) {
+        const auto clip = animations.addClip({.name = "bench", .frameCount = 16, .fps = 12.f});
+        for (int i = 0; i < count; ++i) animations.add(clip, 1.f, 0.01f * static_cast<float>(i));
+    }
+    void update(float dt) override {
+        moveSprites(sprites, dt);
+        animations.update(dt);
+    }
+    void draw(Renderer& r) override {
+        const std::span<const int> frames = animations.allFrames();
+        for (std::size_t i = 0; i < sprites.size(); ++i)
+            r.drawSprite(texture, sprites[i].rect, kAtlas.frameUV(frames[i]), sprites[i].color);
+        r.flushSprites();
+    }
+
+   private:
+    static constexpr FlipbookAtlas kAtlas{4, 4};
+    std::vector<Sprite> sprites;
+    AnimationSystem animations;
+    Texture texture = Texture("textures/texture_01.png");
+};
+
+// N batched sprites, each picking one of kKinds same-sized images at random (a garden
+// of mixed plants): as separate textures the batch flushes at nearly every sprite, as
+// layers of one texture array it stays a single draw
+class VariedSpriteBenchScene : public Scene {
+   public:
+    VariedSpriteBenchScene(int count, bool array) : sprites(makeSprites(count, 32.f)), kinds(count), array(array) {
+        Lcg rng;
+        for (int& k : kinds) k = static_cast<int>(rng.next() * kKinds) % kKinds;
+        layers.create(kSide, kSide, kKinds);
+        std::vector<unsigned char> pixels(kSide * kSide * 4);
+        for (int k = 0; k < kKinds; ++k) {
+            // a checker in a color of its own
+            for (int y = 0; y < kSide; ++y)
+                for (int x = 0; x < kSide; ++x) {
+                    unsigned char* p = &pixels[(y * kSide + x) * 4];
+                    const bool dark = ((x / 8) + (y / 8)) % 2 != 0;
+                    p[0] = static_cast<unsigned char>((k & 1 ? 255 : 80) >> dark);
+                    p[1] = static_cast<unsigned char>((k & 2 ? 255 : 80) >> dark);
+                    p[2] = static_cast<unsigned char>((k & 4 ? 255 : 80) >> dark);
+                    p[3] = 255;
+                }
+            textures[k].create(kSide, kSide);
+            textures[k].update(pixels.data());
+            layers.setLayer(k, pixels.data());
+        }
+    }
+    void update(float dt) override { moveSprites(sprites, dt); }
+    void draw(Renderer& r) override {
+        for (std::size_t i = 0; i < sprites.size(); ++i) {
+            if (array)
+                r.drawSprite(layers, kinds[i], sprites[i].rect, {0, 0, 1, 1});
+            else
+                r.drawSprite(textures[kinds[i]], sprites[i].rect, {0, 0, 1, 1});
+        }
+        r.flushSprites();
+    }
+
+   private:
+    static constexpr int kKinds = 8;
+    static constexpr int kSide = 32;
+    std::vector<Sprite> sprites;
+    std::vector<int> kinds;
+    bool array;
+    Texture textures[kKinds];
+    TextureArray layers;
+};
+
+// N moving text labels: fixed strings (shaping cache hits) or a timer per label that
+// changes every frame (a miss each)
+class LabelBenchScene : public Scene {
+   public:
+    LabelBenchScene(int count, FontMode mode, bool changing)
+        : mode(mode), changing(changing), sprites(makeSprites(count, 16.f)) {
+        for (int i = 0; i < count; ++i) labels.push_back(std::format("Plant #{}", i));
+    }
+    void load() override {
+        font.build(mode);
+        font.upload();
+    }
+    void update(float dt) override {
+        moveSprites(sprites, dt);
+        time += dt;
+    }
+    void draw(Renderer& r) override {
+        char buf[32];
+        for (std::size_t i = 0; i < sprites.size(); ++i) {
+            const Vec2 pos{sprites[i].rect.x, sprites[i].rect.y};
+            if (changing) {
+                const auto end = std::format_to_n(buf, sizeof(buf), "{:.2f} s", time + static_cast<float>(i));
+                r.drawText(font, {buf, end.out}, pos, 16.f, sprites[i].color);
+            } else {
+                r.drawText(font, labels[i], pos, 16.f, sprites[i].color);
+            }
+        }
+        r.flushSprites();
+    }
+
+   private:
+    FontMode mode;
+    bool changing;
+    std::vector<Sprite> sprites;
+    std::vector<std::string> labels;
+    float time = 0.f;
+    Font font;
+};
+
+// interleaved shape/texture layers: worst case for shader switches
+class MixedLayerBenchScene : public Scene {
+   public:
+    MixedLayerBenchScene(int layers, int perLayer) : layers(layers), sprites(makeSprites(layers * perLayer, 24.f)) {}
+    void update(float dt) override { moveSprites(sprites, dt); }
+    void draw(Renderer& r) override {
+        const int perLayer = static_cast<int>(sprites.size()) / layers;
+        for (int l = 0; l < layers; ++l) {
+            const bool textured = (l % 2) == 0;
+            r.useShader(textured ? r.textureShader : r.shapeShader);
+            r.setColor({1, 1, 1, 1});
+            for (int i = l * perLayer; i < (l + 1) * perLayer; ++i) {
+                if (textured) {
+                    r.fillTextureRect(sprites[i].rect, texture);
+                } else {
+                    r.setColor(sprites[i].color);
+                    r.fillRect(sprites[i].rect);
+                }
+            }
+        }
+    }
+
+   private:
+    int layers;
+    std::vector<Sprite> sprites;
+    Texture texture = Texture("textures/texture_01.png");
+};
+
+// static w x h tile map scrolled by a camera
+class TileMapBenchScene : public Scene {
+   public:
+    TileMapBenchScene(int w, int h) : w(w), h(h), tiles(w * h) {
+        Lcg rng;
+        for (auto& t : tiles) t = static_cast<unsigned char>(rng.next() * 4.f);
+    }
+    void update(float dt) override { scroll += dt * 60.f; }
+    void draw(Renderer& r) override {
+        const float tile = std::max(kViewW / w, kViewH / h);
+        const float offset = scroll - static_cast<int>(scroll / tile) * tile;
+
+        r.useShader(r.textureShader);
+        r.setColor({1, 1, 1, 1});
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                if (tiles[y * w + x] == 0) r.fillTextureRect({x * tile - offset, y * tile, tile, tile}, texture);
+
+        r.useShader(r.shapeShader);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                const unsigned char t = tiles[y * w + x];
+                if (t == 0) continue;
+                r.setColor({0.2f * t, 0.6f, 0.2f, 1.f});
+                r.fillRect({x * tile - offset, y * tile, tile, tile});
+            }
+        }
+    }
+
+   private:
+    int w, h;
+    std::vector<unsigned char> tiles;
+    float scroll = 0.f;
+    Texture texture = Texture("textures/texture_01.png");
+};
+
+// A still tilemap drawn through the sprite batch: every frame, once into a cached layer
+// that is then only composited, or cached with one tile changing per frame (a partial
+// repaint of just that tile)
+enum class TileCache { None, Static, OneTile };
+
+class CachedTileMapBenchScene : public Scene {
+   public:
+    CachedTileMapBenchScene(int w, int h, TileCache cache) : w(w), h(h), cache(cache), tiles(w * h) {
+        for (auto& t : tiles) t = static_cast<unsigned char>(rng.next() * 4.f);
+    }
+    void update(float) override {
+        if (cache != TileCache::OneTile) return;
+        const int i = static_cast<int>(rng.next() * static_cast<float>(tiles.size() - 1));
+        tiles[i] = static_cast<unsigned char>((tiles[i] + 1) % 4);
+        layer.invalidate(tileRect(i % w, i / w));
+    }
+    void draw(Renderer& r) override {
+        if (cache == TileCache::None) {
+            drawTiles(r);
+            return;
+        }
+        if (r.beginLayer(layer)) {
+            drawTiles(r);
+            r.endLayer(layer);
+        }
+        r.drawLayer(layer);
+    }
+
+   private:
+    Rect tileRect(int x, int y) const {
+        const float tile = std::max(kViewW / w, kViewH / h);
+        return {x * tile, y * tile, tile, tile};
+    }
+
+    // textured tiles first, then the flat ones, so the batch switches texture once
+    void drawTiles(Renderer& r) {
+        for (int pass = 0; pass < 2; ++pass) {
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    const unsigned char t = tiles[y * w + x];
+                    const Rect rect = tileRect(x, y);
+                    if ((t == 0) != (pass == 0) || (cache != TileCache::None && !layer.needsRepaint(rect))) continue;
+                    if (t == 0)
+                        r.drawSprite(texture, rect, {0, 0, 1, 1});
+                    else
+                        r.drawSprite(r.whiteTexture(), rect, {0, 0, 1, 1}, {0.2f * t, 0.6f, 0.2f, 1.f});
+                }
+            }
+        }
+        r.flushSprites();
+    }
+
+    int w, h;
+    TileCache cache;
+    Lcg rng;
+    std::vector<unsigned char> tiles;
+    CachedLayer layer;
+    Texture texture = Texture("textures/texture_01.png");
+};
+
+// steady rain over the whole view, count particles alive at any time
+class ParticleBenchScene : public Scene {
+   public:
+    explicit ParticleBenchScene(int count) {
+        particles.addEmitter({.type = particles.addType(particles::kRain), .area = {0, kViewH, kViewW, 0},
+                              .velocity = {-20, -400}, .spread = {10, 50},
+                              .rate = static_cast<float>(count) / particles::kRain.lifetime});
+    }
+    void load() override {
+        // measure the steady state, not the first second of filling up
+        for (float t = 0.f; t < particles::kRain.lifetime; t += kFixedDt) particles.update(kFixedDt);
+    }
+    void update(float dt) override { particles.update(dt); }
+    void draw(Renderer& r) override { r.drawParticles(particles); }
+
+   private:
+    ParticleSystem particles;
+};
+
+// N moving lights over a screen of sprites at night, the light buffer at a given scale
+class LightBenchScene : public Scene {
+   public:
+    LightBenchScene(int count, LightQuality quality)
+        : sprites(makeSprites(1000, 24.f)), lights(makeSprites(count, 0.f)) {
+        lighting.quality = quality;
+        lighting.ambient = sunlight(0.0);
+    }
+    void update(float dt) override {
+        moveSprites(sprites, dt);
+        moveSprites(lights, dt);
+    }
+    void draw(Renderer& r) override {
+        r.useShader(r.shapeShader);
+        for (const Sprite& s : sprites) {
+            r.setColor(s.color);
+            r.fillRect(s.rect);
+        }
+        lighting.clear();
+        for (const Sprite& l : lights)
+            lighting.add({.pos = {l.rect.x, l.rect.y}, .radius = 96.f, .color = l.color, .intensity = 0.8f});
+        r.drawLights(lighting);
+    }
+
+   private:
+    std::vector<Sprite> sprites;
+    std::vector<Sprite> lights;
+    LightingSystem lighting;
+};
+
+// Moving sprites through a post-processing setup, to price the chain and the world's
+// resolution against drawing straight into the window
+class PostBenchScene : public Scene {
+   public:
+    explicit PostBenchScene(PostSettings settings) : settings(std::move(settings)), sprites(makeSprites(2000, 24.f)) {}
+    void update(float dt) override { moveSprites(sprites, dt); }
+    void draw(Renderer& r) override {
+        // takes effect from the next frame; the warm-up covers it
+        r.postSettings() = settings;
+        r.useShader(r.shapeShader);
+        for (const Sprite& s : sprites) {
+            r.setColor(s.color);
+            r.fillRect(s.rect);
+        }
+    }
+
+   private:
+    PostSettings settings;
+    std::vector<Sprite> sprites;
+};
+
+// A full inventory screen (side x side slots, each with a count and a tooltip), as a
+// retained tree that never changes, one whose first slot's count changes every frame,
+// and the same quads and text resubmitted through the sprite batch every frame
+enum class UiBenchMode { Static, Changing, Immediate };
+
+class UiBenchScene : public Scene {
+   public:
+    UiBenchScene(int side, UiBenchMode mode) : side(side), mode(mode) {}
+    void load() override {
+        font.build(FontMode::Sdf);
+        font.upload();
+        const float pitch = kViewH / static_cast<float>(side);
+        const UiId panel = ui.addPanel(ui.root(), {0.f, 0.f, kViewH, kViewH});
+        const UiId grid = ui.addGrid(panel, {0.f, 0.f, kViewH, kViewH}, side, {pitch - 2.f, pitch - 2.f}, 2.f);
+        for (int i = 0; i < side * side; ++i) {
+            counts.push_back(std::to_string(i % 100));
+            slots.push_back(ui.addButton(grid, {}, counts.back()));
+            ui.addTooltip(slots.back(), std::format("Seed #{}", i));
+        }
+    }
+    void update(float) override { ++frame; }
+    void draw(Renderer& r) override {
+        if (mode == UiBenchMode::Changing) {
+            char buf[8];
+            const auto end = std::format_to_n(buf, sizeof(buf), "{}", frame % 100);
+            ui.setText(slots[0], {buf, end.out});
+        }
+        // unchanged, this is only a flag check; immediate mode uses it for the slot rects
+        ui.update(r.windowSize());
+        if (mode != UiBenchMode::Immediate) {
+            r.drawUi(ui);
+            return;
+        }
+
+        // what the tree would cost without retention
+        const Rect solid = font.solidUV();
+        const UiStyle style;
+        for (int i = 0; i < side * side; ++i) {
+            const Rect s = ui.screenRect(slots[i]);
+            r.drawSprite(font.texture(), s, solid, style.button);
+            const Vec2 text = font.measure(counts[i], style.textSize);
+            r.drawText(font, counts[i], center(s) - text * 0.5f, style.textSize, style.text);
+        }
+        r.flushSprites();
+    }
+
+   private:
+    int side;
+    UiBenchMode mode;
+    Font font;
+    UiTree ui{font};
+    std::vector<UiId> slots;
+    std::vector<std::string> counts;
+    int frame = 0;
+};
+
+struct BenchCase {
+    std::string name;
+    std::function<std::unique_ptr<Scene>()> make;
+};
+
+std::vector<BenchCase> benchCases() {
+    std::vector<BenchCase> cases;
+    for (int n : {100, 1000, 10000}) {
+        cases.push_back({"sprites_" + std::to_string(n), [n] { return std::make_unique<SpriteBenchScene>(n); }});
+        cases.push_back(
+            {"textured_sprites_" + std::to_string(n), [n] { return std::make_unique<TexturedSpriteBenchScene>(n); }});
+        cases.push_back(
+            {"animated_sprites_" + std::to_string(n), [n] { return std::make_unique<AnimatedSpriteBenchScene>(n); }});
+    }
+    for (int n : {1000, 10000}) {
+        cases.push_back({"varied_sprites_" + std::to_string(n) + "_textures",
+                         [n] { return std::make_unique<VariedSpriteBenchScene>(n, false); }});
+        cases.push_back({"varied_sprites_" + std::to_string(n) + "_array",
+                         [n] { return std::make_unique<VariedSpriteBenchScene>(n, true); }});
+    }
+    cases.push_back({"mixed_layers_8x500", [] { return std::make_unique<MixedLayerBenchScene>(8, 500); }});
+    for (int n : {16, 64, 128}) {
+        cases.push_back({"tilemap_" + std::to_string(n) + "x" + std::to_string(n),
+                         [n] { return std::make_unique<TileMapBenchScene>(n, n); }});
+    }
+    cases.push_back({"tilemap_128x128_uncached",
+                     [] { return std::make_unique<CachedTileMapBenchScene>(128, 128, TileCache::None); }});
+    cases.push_back({"tilemap_128x128_cached",
+                     [] { return std::make_unique<CachedTileMapBenchScene>(128, 128, TileCache::Static); }});
+    cases.push_back({"tilemap_128x128_cached_one_tile",
+                     [] { return std::make_unique<CachedTileMapBenchScene>(128, 128, TileCache::OneTile); }});
+    for (int n : {1000, 5000}) {
+        const std::string count = std::to_string(n);
+        cases.push_back({"labels_bitmap_" + count,
+                         [n] { return std::make_unique<LabelBenchScene>(n, FontMode::Bitmap, false); }});
+        cases.push_back(
+            {"labels_sdf_" + count, [n] { return std::make_unique<LabelBenchScene>(n, FontMode::Sdf, false); }});
+        cases.push_back({"labels_changing_" + count,
+                         [n] { return std::make_unique<LabelBenchScene>(n, FontMode::Sdf, true); }});
+    }
+    for (int n : {10000, 100000}) {
+        cases.push_back(
+            {"particles_" + std::to_string(n / 1000) + "k", [n] { return std::make_unique<ParticleBenchScene>(n); }});
+    }
+    for (int n : {64, 512}) {
+        const std::string count = std::to_string(n);
+        cases.push_back(
+            {"lights_" + count + "_full", [n] { return std::make_unique<LightBenchScene>(n, LightQuality::Full); }});
+        cases.push_back(
+            {"lights_" + count + "_half", [n] { return std::make_unique<LightBenchScene>(n, LightQuality::Half); }});
+        cases.push_back({"lights_" + count + "_quarter",
+                         [n] { return std::make_unique<LightBenchScene>(n, LightQuality::Quarter); }});
+    }
+    cases.push_back({"post_none", [] { return std::make_unique<PostBenchScene>(PostSettings{}); }});
+    cases.push_back({"post_half_resolution",
+                     [] { return std::make_unique<PostBenchScene>(PostSettings{.resolutionScale = 0.5f}); }});
+    const std::vector<PostEffect> chain = {PostEffect::Bloom, PostEffect::ColorGrade, PostEffect::Vignette};
+    cases.push_back(
+        {"post_full_chain", [chain] { return std::make_unique<PostBenchScene>(PostSettings{.chain = chain}); }});
+    cases.push_back({"post_full_chain_half_resolution", [chain] {
+                         return std::make_unique<PostBenchScene>(PostSettings{.chain = chain, .resolutionScale = 0.5f});
+                     }});
+    cases.push_back({"ui_inventory_static", [] { return std::make_unique<UiBenchScene>(20, UiBenchMode::Static); }});
+    cases.push_back(
+        {"ui_inventory_changing", [] { return std::make_unique<UiBenchScene>(20, UiBenchMode::Changing); }});
+    cases.push_back(
+        {"ui_inventory_immediate", [] { return std::make_unique<UiBenchScene>(20, UiBenchMode::Immediate); }});
+    return cases;
+}
+
+struct BenchResult {
+    std::string name;
+    Profiler::FrameStats stats;
+    double meanDrawCalls = 0.0;
+    int frames = 0;
+};
+}  // namespace
+
+// ----------------------------- runner --------------------------------
+
+bool runBenchmarks(Renderer& r, const BenchmarkOptions& options) {
+    using Clock = std::chrono::steady_clock;
+
+    // measure the engine, not the display
+    r.framePacer().setMode(PresentMode::Uncapped);
+
+    std::vector<BenchResult> results;
+    std::vector<float> frameMs(options.frames);
+
+    for (const BenchCase& c : benchCases()) {
+        std::unique_ptr<Scene> scene = c.make();
+        scene->load();
+
+        long long drawCalls = 0;
+        Clock::time_point last = Clock::now();
+        for (int f = -options.warmupFrames; f < options.frames; ++f) {
+            if (glfwWindowShouldClose(r.windowHandle())) return false;
+
+            r.beginFrame();
+            glClearColor(0.573f, 0.953f, 1.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            scene->update(kFixedDt);
+            scene->draw(r);
+            const int calls = r.drawCallCount();
+            r.endFrame();
+
+            const Clock::time_point now = Clock::now();
+            if (f >= 0) {
+                frameMs[f] = std::chrono::duration<float, std::milli>(now - last).count();
+                drawCalls += calls;
+            }
+            last = now;
+        }
+
+        scene->unload();
+        r.postSettings() = {};  // a case's post setup must not leak into the next
+
+        BenchResult res{c.name, Profiler::computeStats(frameMs.data(), options.frames),
+                        static_cast<double>(drawCalls) / options.frames, options.frames};
+        std::println("{:<24} mean {:.3f} ms  p50 {:.3f}  p95 {:.3f}  p99 {:.3f}  draw calls {:.0f}", res.name,
+                     res.stats.meanMs, res.stats.p50Ms, res.stats.p95Ms, res.stats.p99Ms, res.meanDrawCalls);
+        results.push_back(std::move(res));
+    }
+
+    FILE* f = std::fopen(options.reportPath, "wb");
+    if (!f) {
+        std::println(stderr, "Could not open benchmark report at path {}", options.reportPath);
+        return false;
+    }
+
+    std::print(f, "{{\n  \"frames\": {},\n  \"warmup_frames\": {},\n  \"results\": [\n", options.frames,
+               options.warmupFrames);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& res = results[i];
+        std::print(f,
+                   "    {{\"scene\": \"{}\", \"mean_ms\": {:.4f}, \"p50_ms\": {:.4f}, \"p95_ms\": {:.4f}, "
+                   "\"p99_ms\": {:.4f}, \"max_ms\": {:.4f}, \"draw_calls\": {:.1f}}}{}\n",
+                   res.name, res.stats.meanMs, res.stats.p50Ms, res.stats.p95Ms, res.stats.p99Ms, res.stats.maxMs,
+                   res.meanDrawCalls, i + 1 < results.size() ? "," : "");
+    }
+    std::print(f, "  ]\n}}\n");
+    std::fclose(f);
+
+    std::println("Wrote benchmark report to {}", options.reportPath);
+    return true;
+}
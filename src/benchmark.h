@@ -0,0 +1,14 @@
+#pragma once
+
+class Renderer;
+
+// Scripted, reproducible frame-time benchmarks (run with `out --bench`).
+struct BenchmarkOptions {
+    const char* reportPath = "bench_report.json";
+    int frames = 600;       // measured frames per scene
+    int warmupFrames = 60;  // discarded before measuring
+};
+
+// Runs every scripted scene and writes a JSON report. Returns false if the
+// run was aborted (window closed) or the report could not be written.
+bool runBenchmarks(Renderer& r, const BenchmarkOptions& options);
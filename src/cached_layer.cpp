@@ -0,0 +1,20 @@
+#include "cached_layer.h"
+
+#include <algorithm>
+
+void CachedLayer::invalidate(Rect r) {
+    if (full || r.w <= 0.f || r.h <= 0.f) return;
+    if (region.w <= 0.f) {
+        region = r;
+        return;
+    }
+    const float x0 = std::min(region.x, r.x), y0 = std::min(region.y, r.y);
+    const float x1 = std::max(region.x + region.w, r.x + r.w), y1 = std::max(region.y + region.h, r.y + r.h);
+    region = {x0, y0, x1 - x0, y1 - y0};
+}
+
+void CachedLayer::markClean() {
+    full = false;
+    region = {0.f, 0.f, 0.f, 0.f};
+    ++repaintCount;
+}
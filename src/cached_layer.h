@@ -0,0 +1,41 @@
+#pragma once
+
+#include "render_target.h"
+#include "util.h"
+
+// A layer that rarely changes (background, tilemap, fences) kept in its own texture and
+// composited every frame; it is only redrawn where something invalidated it:
+//
+//     if (r.beginLayer(layer)) {      // false, and nothing to do, while it is clean
+//         ... draw what overlaps layer.dirtyRect() ...
+//         r.endLayer(layer);
+//     }
+//     r.drawLayer(layer);
+//
+// Invalidations accumulate into one bounding rect until the next repaint, which is
+// cleared and clipped to it. A new layer, or one whose target changed size, repaints
+// whole.
+class CachedLayer {
+   public:
+    void invalidate() { full = true; }
+    void invalidate(Rect r);  // window pixels from the top left, like sprites
+
+    bool dirty() const { return full || region.w > 0.f; }
+    bool fullyDirty() const { return full; }
+    // Window pixels to repaint (the whole window when fully dirty)
+    Rect dirtyRect(Vec2 viewport) const { return full ? Rect{0.f, 0.f, viewport.x, viewport.y} : region; }
+    // Whether something at r must be drawn in this repaint; anything else can be skipped
+    bool needsRepaint(Rect r) const { return full || (region.w > 0.f && overlaps(region, r)); }
+
+    // For Renderer: the texture, and marking a repaint done
+    RenderTarget& target() { return target_; }
+    void markClean();
+
+    int repaints() const { return repaintCount; }
+
+   private:
+    RenderTarget target_;
+    Rect region = {0.f, 0.f, 0.f, 0.f};
+    bool full = true;
+    int repaintCount = 0;
+};
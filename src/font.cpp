@@ -0,0 +1,229 @@
+#include "font.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "animation.h"
+
+// ----------------------------- glyphs --------------------------------
+
+namespace {
+// font8x8_basic (public domain): U+0020..U+007E, one byte per row from the top, bit 0
+// is the leftmost pixel
+constexpr std::uint8_t kGlyphs[95][8] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // space
+    {0x18, 0x3C, 0x3C, 0x18, 0x18, 0x00, 0x18, 0x00},  // !
+    {0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // "
+    {0x36, 0x36, 0x7F, 0x36, 0x7F, 0x36, 0x36, 0x00},  // #
+    {0x0C, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x0C, 0x00},  // $
+    {0x00, 0x63, 0x33, 0x18, 0x0C, 0x66, 0x63, 0x00},  // %
+    {0x1C, 0x36, 0x1C, 0x6E, 0x3B, 0x33, 0x6E, 0x00},  // &
+    {0x06, 0x06, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00},  // '
+    {0x18, 0x0C, 0x06, 0x06, 0x06, 0x0C, 0x18, 0x00},  // (
+    {0x06, 0x0C, 0x18, 0x18, 0x18, 0x0C, 0x06, 0x00},  // )
+    {0x00, 0x66, 0x3C, 0xFF, 0x3C, 0x66, 0x00, 0x00},  // *
+    {0x00, 0x0C, 0x0C, 0x3F, 0x0C, 0x0C, 0x00, 0x00},  // +
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x06},  // ,
+    {0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x00, 0x00},  // -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00},  // .
+    {0x60, 0x30, 0x18, 0x0C, 0x06, 0x03, 0x01, 0x00},  // /
+    {0x3E, 0x63, 0x73, 0x7B, 0x6F, 0x67, 0x3E, 0x00},  // 0
+    {0x0C, 0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x3F, 0x00},  // 1
+    {0x1E, 0x33, 0x30, 0x1C, 0x06, 0x33, 0x3F, 0x00},  // 2
+    {0x1E, 0x33, 0x30, 0x1C, 0x30, 0x33, 0x1E, 0x00},  // 3
+    {0x38, 0x3C, 0x36, 0x33, 0x7F, 0x30, 0x78, 0x00},  // 4
+    {0x3F, 0x03, 0x1F, 0x30, 0x30, 0x33, 0x1E, 0x00},  // 5
+    {0x1C, 0x06, 0x03, 0x1F, 0x33, 0x33, 0x1E, 0x00},  // 6
+    {0x3F, 0x33, 0x30, 0x18, 0x0C, 0x0C, 0x0C, 0x00},  // 7
+    {0x1E, 0x33, 0x33, 0x1E, 0x33, 0x33, 0x1E, 0x00},  // 8
+    {0x1E, 0x33, 0x33, 0x3E, 0x30, 0x18, 0x0E, 0x00},  // 9
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x00},  // :
+    {0x00, 0x0C, 0x0C, 0x00, 0x00, 0x0C, 0x0C, 0x06},  // ;
+    {0x18, 0x0C, 0x06, 0x03, 0x06, 0x0C, 0x18, 0x00},  // <
+    {0x00, 0x00, 0x3F, 0x00, 0x00, 0x3F, 0x00, 0x00},  // =
+    {0x06, 0x0C, 0x18, 0x30, 0x18, 0x0C, 0x06, 0x00},  // >
+    {0x1E, 0x33, 0x30, 0x18, 0x0C, 0x00, 0x0C, 0x00},  // ?
+    {0x3E, 0x63, 0x7B, 0x7B, 0x7B, 0x03, 0x1E, 0x00},  // @
+    {0x0C, 0x1E, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x00},  // A
+    {0x3F, 0x66, 0x66, 0x3E, 0x66, 0x66, 0x3F, 0x00},  // B
+    {0x3C, 0x66, 0x03, 0x03, 0x03, 0x66, 0x3C, 0x00},  // C
+    {0x1F, 0x36, 0x66, 0x66, 0x66, 0x36, 0x1F, 0x00},  // D
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x46, 0x7F, 0x00},  // E
+    {0x7F, 0x46, 0x16, 0x1E, 0x16, 0x06, 0x0F, 0x00},  // F
+    {0x3C, 0x66, 0x03, 0x03, 0x73, 0x66, 0x7C, 0x00},  // G
+    {0x33, 0x33, 0x33, 0x3F, 0x33, 0x33, 0x33, 0x00},  // H
+    {0x1E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},  // I
+    {0x78, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E, 0x00},  // J
+    {0x67, 0x66, 0x36, 0x1E, 0x36, 0x66, 0x67, 0x00},  // K
+    {0x0F, 0x06, 0x06, 0x06, 0x46, 0x66, 0x7F, 0x00},  // L
+    {0x63, 0x77, 0x7F, 0x7F, 0x6B, 0x63, 0x63, 0x00},  // M
+    {0x63, 0x67, 0x6F, 0x7B, 0x73, 0x63, 0x63, 0x00},  // N
+    {0x1C, 0x36, 0x63, 0x63, 0x63, 0x36, 0x1C, 0x00},  // O
+    {0x3F, 0x66, 0x66, 0x3E, 0x06, 0x06, 0x0F, 0x00},  // P
+    {0x1E, 0x33, 0x33, 0x33, 0x3B, 0x1E, 0x38, 0x00},  // Q
+    {0x3F, 0x66, 0x66, 0x3E, 0x36, 0x66, 0x67, 0x00},  // R
+    {0x1E, 0x33, 0x07, 0x0E, 0x38, 0x33, 0x1E, 0x00},  // S
+    {0x3F, 0x2D, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},  // T
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x3F, 0x00},  // U
+    {0x33, 0x33, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00},  // V
+    {0x63, 0x63, 0x63, 0x6B, 0x7F, 0x77, 0x63, 0x00},  // W
+    {0x63, 0x63, 0x36, 0x1C, 0x1C, 0x36, 0x63, 0x00},  // X
+    {0x33, 0x33, 0x33, 0x1E, 0x0C, 0x0C, 0x1E, 0x00},  // Y
+    {0x7F, 0x63, 0x31, 0x18, 0x4C, 0x66, 0x7F, 0x00},  // Z
+    {0x1E, 0x06, 0x06, 0x06, 0x06, 0x06, 0x1E, 0x00},  // [
+    {0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x40, 0x00},  // backslash
+    {0x1E, 0x18, 0x18, 0x18, 0x18, 0x18, 0x1E, 0x00},  // ]
+    {0x08, 0x1C, 0x36, 0x63, 0x00, 0x00, 0x00, 0x00},  // ^
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF},  // _
+    {0x0C, 0x0C, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00},  // `
+    {0x00, 0x00, 0x1E, 0x30, 0x3E, 0x33, 0x6E, 0x00},  // a
+    {0x07, 0x06, 0x06, 0x3E, 0x66, 0x66, 0x3B, 0x00},  // b
+    {0x00, 0x00, 0x1E, 0x33, 0x03, 0x33, 0x1E, 0x00},  // c
+    {0x38, 0x30, 0x30, 0x3E, 0x33, 0x33, 0x6E, 0x00},  // d
+    {0x00, 0x00, 0x1E, 0x33, 0x3F, 0x03, 0x1E, 0x00},  // e
+    {0x1C, 0x36, 0x06, 0x0F, 0x06, 0x06, 0x0F, 0x00},  // f
+    {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x1F},  // g
+    {0x07, 0x06, 0x36, 0x6E, 0x66, 0x66, 0x67, 0x00},  // h
+    {0x0C, 0x00, 0x0E, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},  // i
+    {0x30, 0x00, 0x30, 0x30, 0x30, 0x33, 0x33, 0x1E},  // j
+    {0x07, 0x06, 0x66, 0x36, 0x1E, 0x36, 0x67, 0x00},  // k
+    {0x0E, 0x0C, 0x0C, 0x0C, 0x0C, 0x0C, 0x1E, 0x00},  // l
+    {0x00, 0x00, 0x33, 0x7F, 0x7F, 0x6B, 0x63, 0x00},  // m
+    {0x00, 0x00, 0x1F, 0x33, 0x33, 0x33, 0x33, 0x00},  // n
+    {0x00, 0x00, 0x1E, 0x33, 0x33, 0x33, 0x1E, 0x00},  // o
+    {0x00, 0x00, 0x3B, 0x66, 0x66, 0x3E, 0x06, 0x0F},  // p
+    {0x00, 0x00, 0x6E, 0x33, 0x33, 0x3E, 0x30, 0x78},  // q
+    {0x00, 0x00, 0x3B, 0x6E, 0x66, 0x06, 0x0F, 0x00},  // r
+    {0x00, 0x00, 0x3E, 0x03, 0x1E, 0x30, 0x1F, 0x00},  // s
+    {0x08, 0x0C, 0x3E, 0x0C, 0x0C, 0x2C, 0x18, 0x00},  // t
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x33, 0x6E, 0x00},  // u
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x1E, 0x0C, 0x00},  // v
+    {0x00, 0x00, 0x63, 0x6B, 0x7F, 0x7F, 0x36, 0x00},  // w
+    {0x00, 0x00, 0x63, 0x36, 0x1C, 0x36, 0x63, 0x00},  // x
+    {0x00, 0x00, 0x33, 0x33, 0x33, 0x3E, 0x30, 0x1F},  // y
+    {0x00, 0x00, 0x3F, 0x19, 0x0C, 0x26, 0x3F, 0x00},  // z
+    {0x38, 0x0C, 0x0C, 0x07, 0x0C, 0x0C, 0x38, 0x00},  // {
+    {0x18, 0x18, 0x18, 0x00, 0x18, 0x18, 0x18, 0x00},  // |
+    {0x07, 0x0C, 0x0C, 0x38, 0x0C, 0x0C, 0x07, 0x00},  // }
+    {0x6E, 0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},  // ~
+};
+
+constexpr int kFirstChar = 32;
+constexpr int kGlyphCount = 95;
+constexpr int kGlyphSize = 8;
+constexpr FlipbookAtlas kGrid{16, 6};  // glyph cells, in character order; the spare last one is solid
+constexpr int kSolidCell = kGrid.columns * kGrid.rows - 1;
+
+// Glyphs sit in their cell with a one glyph pixel border: room for the distance field
+// to fall off, and nothing for linear filtering to bleed in from the neighbours
+constexpr int kPadding = 1;
+constexpr int kCellGlyphPixels = kGlyphSize + 2 * kPadding;
+constexpr int kSdfScale = 4;                  // atlas pixels per glyph pixel in Sdf mode
+constexpr float kSdfSpread = kSdfScale * 1.f;  // distances beyond this clamp
+
+bool glyphPixel(int glyph, int x, int y) {
+    if (x < 0 || x >= kGlyphSize || y < 0 || y >= kGlyphSize) return false;
+    return (kGlyphs[glyph][y] >> x) & 1;
+}
+}  // namespace
+
+// ----------------------------- atlas ---------------------------------
+
+void Font::build(FontMode mode) {
+    mode_ = mode;
+    cache.clear();
+    const int scale = mode == FontMode::Sdf ? kSdfScale : 1;
+    const int cell = kCellGlyphPixels * scale;
+    atlasW = kGrid.columns * cell;
+    atlasH = kGrid.rows * cell;
+    pixels.assign(static_cast<std::size_t>(atlasW) * atlasH * 4, 0);
+
+    for (int g = 0; g < kGlyphCount; ++g) {
+        const int cellX = g % kGrid.columns * cell;
+        const int cellY = g / kGrid.columns * cell;
+        // inside test in atlas pixels, relative to the cell
+        auto inside = [&](int x, int y) {
+            return glyphPixel(g, x / scale - kPadding, y / scale - kPadding) && x >= 0 && y >= 0;
+        };
+
+        for (int y = 0; y < cell; ++y) {
+            for (int x = 0; x < cell; ++x) {
+                std::uint8_t value;
+                if (mode == FontMode::Bitmap) {
+                    value = inside(x, y) ? 255 : 0;
+                } else {
+                    // distance to the nearest pixel on the other side of the edge, signed
+                    // (positive inside) and mapped so the edge itself is 0.5
+                    const bool in = inside(x, y);
+                    const int reach = static_cast<int>(kSdfSpread) + 1;
+                    float nearest = kSdfSpread + 0.5f;
+                    for (int dy = -reach; dy <= reach; ++dy)
+                        for (int dx = -reach; dx <= reach; ++dx)
+                            if (inside(x + dx, y + dy) != in)
+                                nearest = std::min(nearest, std::sqrt(static_cast<float>(dx * dx + dy * dy)));
+                    const float d = std::clamp(nearest - 0.5f, 0.f, kSdfSpread) * (in ? 1.f : -1.f);
+                    value = static_cast<std::uint8_t>(std::lround((0.5f + 0.5f * d / kSdfSpread) * 255.f));
+                }
+                // rows go up unflipped (v up), like the other generated atlases
+                const int py = atlasH - 1 - (cellY + y);
+                std::uint8_t* p = &pixels[(static_cast<std::size_t>(py) * atlasW + cellX + x) * 4];
+                p[0] = p[1] = p[2] = 255;
+                p[3] = value;
+            }
+        }
+    }
+
+    const int solidX = kSolidCell % kGrid.columns * cell;
+    const int solidY = kSolidCell / kGrid.columns * cell;
+    for (int y = 0; y < cell; ++y) {
+        const int py = atlasH - 1 - (solidY + y);
+        std::fill_n(&pixels[(static_cast<std::size_t>(py) * atlasW + solidX) * 4], cell * 4, std::uint8_t{255});
+    }
+}
+
+Rect Font::solidUV() const {
+    // the middle of the cell, clear of whatever filtering pulls in from its neighbours
+    const Rect cell = kGrid.frameUV(kSolidCell);
+    return {cell.x + cell.w * 0.25f, cell.y + cell.h * 0.25f, cell.w * 0.5f, cell.h * 0.5f};
+}
+
+bool Font::upload() {
+    if (pixels.empty() || !texture_.create(atlasW, atlasH)) return false;
+    texture_.update(pixels.data());
+    if (mode_ == FontMode::Bitmap) {
+        glBindTexture(GL_TEXTURE_2D, texture_.id());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    pixels = {};
+    return true;
+}
+
+// ----------------------------- layout --------------------------------
+
+const ShapedText& Font::shape(std::string_view text) {
+    if (auto it = cache.find(text); it != cache.end()) return it->second;
+    if (static_cast<int>(cache.size()) >= kMaxCachedStrings) cache.clear();
+
+    ShapedText shaped;
+    constexpr float pad = static_cast<float>(kPadding) / kGlyphSize;
+    constexpr float cell = static_cast<float>(kCellGlyphPixels) / kGlyphSize;
+    float x = 0.f, y = 0.f;
+    int lines = 1;
+    for (const char ch : text) {
+        if (ch == '\n') {
+            x = 0.f;
+            y += kLineHeight;
+            ++lines;
+            continue;
+        }
+        int glyph = static_cast<unsigned char>(ch) - kFirstChar;
+        if (glyph < 0 || glyph >= kGlyphCount) glyph = '?' - kFirstChar;
+        if (glyph != 0) shaped.quads.push_back({{x - pad, y - pad, cell, cell}, kGrid.frameUV(glyph)});
+        x += 1.f;  // monospaced, with the spacing built into the glyphs
+        shaped.extent.x = std::max(shaped.extent.x, x);
+    }
+    shaped.extent.y = 1.f + static_cast<float>(lines - 1) * kLineHeight;
+    return cache.emplace(text, std::move(shaped)).first->second;
+}
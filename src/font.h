@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "texture.h"
+#include "util.h"
+
+enum class FontMode : std::uint8_t {
+    Bitmap,  // the glyph pixels as they are: crisp at whole multiples of their size
+    Sdf,     // signed distance field: smooth edges at any size
+};
+
+// A string laid out at size 1 (one glyph is 1 unit tall), from its top left
+struct ShapedText {
+    struct Quad {
+        Rect rect;  // includes the glyph's padding
+        Rect uv;
+    };
+    std::vector<Quad> quads;
+    Vec2 extent = {0.f, 0.f};  // width and height at size 1
+};
+
+// Printable ASCII from the built-in 8x8 pixel font, rasterized into one atlas texture.
+// Laid-out strings are cached by content, so labels that do not change every frame
+// cost a hash lookup; Renderer::drawText turns them into sprite batch quads.
+class Font {
+   public:
+    static constexpr float kLineHeight = 1.25f;  // in glyph heights
+    static constexpr int kMaxCachedStrings = 16384;  // past this the cache starts over
+
+    // CPU only, safe in Scene::preload
+    void build(FontMode mode);
+    // Main thread: the atlas goes to the GPU and its pixels are freed
+    bool upload();
+
+    const Texture& texture() const { return texture_; }
+    FontMode mode() const { return mode_; }
+    // An opaque white patch of the atlas, so flat quads can share a draw with the text
+    Rect solidUV() const;
+
+    const ShapedText& shape(std::string_view text);
+    Vec2 measure(std::string_view text, float size) { return shape(text).extent * size; }
+    int cachedStrings() const { return static_cast<int>(cache.size()); }
+    void clearCache() { cache.clear(); }
+
+   private:
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    FontMode mode_ = FontMode::Bitmap;
+    std::vector<std::uint8_t> pixels;  // RGBA: white, coverage or distance in alpha
+    int atlasW = 0, atlasH = 0;
+    Texture texture_;
+    std::unordered_map<std::string, ShapedText, StringHash, std::equal_to<>> cache;
+};
@@ -0,0 +1,115 @@
+#include "frame_pacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "imgui.h"
+
+namespace {
+constexpr int kLatencyWindow = 120;  // frames per max-latency window
+constexpr double kLatencyAlpha = 0.05;
+}  // namespace
+
+void FramePacer::setMode(PresentMode mode) {
+    mode_ = mode;
+    if (mode_ == PresentMode::AdaptiveVSync && !adaptiveSupported()) mode_ = PresentMode::VSync;
+    deadline = {};
+    applySwapInterval();
+}
+
+bool FramePacer::adaptiveSupported() const {
+    return glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear");
+}
+
+void FramePacer::setTargetFps(double fps) {
+    targetFps_ = std::clamp(fps, 10.0, 1000.0);
+}
+
+void FramePacer::applySwapInterval() {
+    switch (mode_) {
+        case PresentMode::VSync:
+            glfwSwapInterval(1);
+            break;
+        case PresentMode::AdaptiveVSync:
+            glfwSwapInterval(-1);
+            break;
+        case PresentMode::Uncapped:
+        case PresentMode::Limited:
+            glfwSwapInterval(0);
+            break;
+    }
+}
+
+void FramePacer::waitForDeadline() {
+    if (mode_ != PresentMode::Limited) return;
+
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps_));
+    deadline += period;
+
+    Clock::time_point now = Clock::now();
+    if (now >= deadline) {
+        // late (or first frame): resync instead of trying to catch up
+        deadline = now;
+        return;
+    }
+
+    // coarse sleep, leaving a margin for OS timer granularity...
+    const auto margin =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(spinMarginMs));
+    const Clock::time_point wake = deadline - margin;
+    if (now < wake) {
+        std::this_thread::sleep_until(wake);
+        now = Clock::now();
+
+        // ...and learn how late the OS wakes us up
+        const double oversleepMs = std::chrono::duration<double, std::milli>(now - wake).count();
+        spinMarginMs = std::clamp(0.9 * spinMarginMs + 0.1 * (oversleepMs + 0.25), 0.25, 16.0);
+    }
+
+    // ...then spin the remainder
+    while (Clock::now() < deadline) std::this_thread::yield();
+}
+
+void FramePacer::markInputSampled() {
+    inputSampled = Clock::now();
+}
+
+void FramePacer::markInputEvent(Clock::time_point time) {
+    inputEvent = time;
+}
+
+void FramePacer::markPresented() {
+    if (inputEvent != Clock::time_point{}) {
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - inputEvent).count();
+        eventLatencyEmaMs =
+            eventLatencyEmaMs == 0.0 ? ms : eventLatencyEmaMs + kLatencyAlpha * (ms - eventLatencyEmaMs);
+        inputEvent = {};
+    }
+    if (inputSampled == Clock::time_point{}) return;
+
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - inputSampled).count();
+    latencyEmaMs = latencyEmaMs == 0.0 ? ms : latencyEmaMs + kLatencyAlpha * (ms - latencyEmaMs);
+    latencyRunningMaxMs = std::max(latencyRunningMaxMs, ms);
+    if (++latencyWindowFrames >= kLatencyWindow) {
+        latencyWindowMaxMs = latencyRunningMaxMs;
+        latencyRunningMaxMs = 0.0;
+        latencyWindowFrames = 0;
+    }
+}
+
+void FramePacer::drawDebugUI() {
+    static const char* const kModes[] = {"VSync", "Adaptive VSync", "Uncapped", "Limited"};
+
+    int current = static_cast<int>(mode_);
+    if (ImGui::Combo("Present", &current, kModes, 4)) setMode(static_cast<PresentMode>(current));
+    if (mode_ == PresentMode::Limited) {
+        float fps = static_cast<float>(targetFps_);
+        if (ImGui::SliderFloat("Target FPS", &fps, 10.f, 360.f, "%.0f")) setTargetFps(fps);
+        ImGui::Text("spin margin: %.2f ms", spinMarginMs);
+    }
+    if (!adaptiveSupported()) ImGui::TextDisabled("adaptive vsync not supported");
+    ImGui::Text("input->present: %.2f ms (max %.2f)", latencyEmaMs, latencyWindowMaxMs);
+    ImGui::Text("event->present: %.2f ms", eventLatencyEmaMs);
+}
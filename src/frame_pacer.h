@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+
+struct GLFWwindow;
+
+enum class PresentMode {
+    VSync,          // swap interval 1
+    AdaptiveVSync,  // swap interval -1 (tear instead of stalling on a late frame)
+    Uncapped,       // swap interval 0, no limiter
+    Limited,        // swap interval 0 + sleep/spin limiter at targetFps
+};
+
+// Owns the swap interval and frame limiter, and measures input-to-present latency.
+class FramePacer {
+   public:
+    FramePacer() = default;
+
+    void setMode(PresentMode mode);
+    PresentMode mode() const { return mode_; }
+    bool adaptiveSupported() const;
+
+    void setTargetFps(double fps);
+    double targetFps() const { return targetFps_; }
+
+    // Call right before glfwSwapBuffers; blocks until the next deadline in Limited mode.
+    void waitForDeadline();
+
+    // Latency bookkeeping: input becomes visible at poll time, and is on screen once
+    // the frame that consumed it has been swapped.
+    void markInputSampled();
+    // The first input event the frame consumed, if it had one (timestamped by Input)
+    void markInputEvent(std::chrono::steady_clock::time_point time);
+    void markPresented();
+
+    double latencyMs() const { return latencyEmaMs; }
+    double latencyMaxMs() const { return latencyWindowMaxMs; }
+    // From key/button event to present, over frames that had an event
+    double eventLatencyMs() const { return eventLatencyEmaMs; }
+
+    // ImGui controls (call between ImGui::Begin/End)
+    void drawDebugUI();
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    PresentMode mode_ = PresentMode::VSync;
+    double targetFps_ = 60.0;
+
+    Clock::time_point deadline{};
+    double spinMarginMs = 1.5;  // adapts to observed oversleep (coarse OS timers can need ~16 ms)
+
+    Clock::time_point inputSampled{};
+    double latencyEmaMs = 0.0;
+    double latencyRunningMaxMs = 0.0;  // max over the current window
+    double latencyWindowMaxMs = 0.0;   // max over the last complete window
+    int latencyWindowFrames = 0;
+    Clock::time_point inputEvent{};
+    double eventLatencyEmaMs = 0.0;
+
+    void applySwapInterval();
+};
@@ -0,0 +1,115 @@
+#include "garden.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "trace.h"
+
+int Garden::advance(float dt) {
+    accumulator = std::min(accumulator + dt, kTickSeconds * kMaxTicksPerAdvance);
+
+    int ticks = 0;
+    while (accumulator >= kTickSeconds) {
+        step();
+        accumulator -= kTickSeconds;
+        ++ticks;
+    }
+    return ticks;
+}
+
+void Garden::step() {
+    plants.wakeDue(tick);
+    soil.tick(kTickSeconds, &plants.soilDraw());
+    plants.update(&soil, kTickSeconds, tick);
+    time += kTickSeconds;
+    ++tick;
+    if (tickHashes) tickHashes->push_back(stateHash());
+}
+
+double Garden::fastForward(double seconds, float maxStep) {
+    seconds = std::clamp(seconds, 0.0, kMaxCatchUpSeconds);
+    if (seconds <= 0.0) return 0.0;
+    TRACE_SCOPE("garden fast-forward");
+    plants.wakeAll();
+
+    // start near tick resolution and widen: the fast transients (refilling, wilting) come
+    // first, and once they have played out the state drifts slowly
+    float dt = std::min(kCatchUpFirstStep, maxStep);
+    for (double left = seconds; left > 0.0; left -= dt, dt = std::min(dt * kCatchUpGrowth, maxStep)) {
+        dt = static_cast<float>(std::min<double>(dt, left));
+        if (soil.size() > 0) {
+            soil.fastForward(dt, plants.drawCatchUp(soil, dt));
+            plants.fastForward(&soil, dt);
+        } else {
+            plants.fastForward(nullptr, dt);
+        }
+    }
+
+    // keep the tick count in step with simulated time
+    time += seconds;
+    tick += static_cast<std::uint64_t>(std::llround(seconds / kTickSeconds));
+    return seconds;
+}
+
+double Garden::catchUpTo(std::int64_t unixSeconds) {
+    const std::int64_t last = lastWallClock;
+    lastWallClock = unixSeconds;
+    if (last == 0 || unixSeconds <= last) return 0.0;
+    return fastForward(static_cast<double>(unixSeconds - last));
+}
+
+void Garden::apply(const GardenCommand& command) {
+    const float* a = command.args;
+    switch (command.type) {
+        case GardenCommand::Type::WaterSoil:
+            soil.addWater(a[0], a[1], a[2], a[3]);
+            break;
+        case GardenCommand::Type::SetRain:
+            soil.params.rainRate = a[0];
+            break;
+        case GardenCommand::Type::Skip:
+            fastForward(a[0]);
+            break;
+    }
+}
+
+namespace {
+// FNV-1a, folding in a value's bytes
+struct Hasher {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+
+    void bytes(const void* data, std::size_t size) {
+        const auto* b = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) h = (h ^ b[i]) * 0x100000001b3ull;
+    }
+    template <class T>
+    void value(const T& v) {
+        bytes(&v, sizeof(T));
+    }
+};
+}  // namespace
+
+std::uint64_t Garden::stateHash() const {
+    TRACE_SCOPE("garden hash");
+    Hasher hash;
+    hash.value(tick);
+    hash.value(accumulator);
+    const std::size_t tiles = static_cast<std::size_t>(soil.size()) * sizeof(float);
+    for (auto f : {SoilGrid::Field::Moisture, SoilGrid::Field::Nitrogen, SoilGrid::Field::Temperature})
+        if (tiles > 0) hash.bytes(soil.field(f), tiles);
+
+    // plant values as seen from outside, so sleeping and awake plants hash alike
+    for (int s = 0; s < plants.speciesCount(); ++s) {
+        const auto species = static_cast<std::uint16_t>(s);
+        const PlantSim::Pool& p = plants.pool(species);
+        for (int i = 0; i < p.size(); ++i) {
+            const PlantState state = plants.stateAt(species, i);
+            hash.value(p.owner[i]);
+            hash.value(state.stage);
+            hash.value(state.water);
+            hash.value(state.nutrients);
+            hash.value(state.health);
+        }
+    }
+    return hash.h;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "plants.h"
+#include "soil.h"
+
+// Player actions on the garden. Going through Garden::apply between ticks, rather than
+// poking at the soil or plants directly, is what lets a replay repeat them.
+struct GardenCommand {
+    enum class Type : std::uint8_t { WaterSoil, SetRain, Skip };
+    Type type = Type::WaterSoil;
+    float args[4] = {};  // WaterSoil: x, y, radius, amount; SetRain: rate; Skip: seconds
+};
+
+// All simulated garden state, advanced on a fixed tick so results don't depend on frame rate
+class Garden {
+   public:
+    static constexpr float kTickSeconds = 0.1f;
+    static constexpr int kMaxTicksPerAdvance = 8;  // drop time rather than spiral after a hitch
+    // offline catch-up: steps start short and widen geometrically up to kCatchUpStep
+    static constexpr float kCatchUpFirstStep = 1.f;
+    static constexpr float kCatchUpGrowth = 1.2f;
+    static constexpr float kCatchUpStep = 300.f;
+    static constexpr double kMaxCatchUpSeconds = 30.0 * 86400.0;  // longer absences are clipped
+
+    // Run as many fixed ticks as fit in dt (plus leftover time). Returns ticks run.
+    int advance(float dt);
+    void step();
+
+    // Skip ahead with coarse closed-form steps instead of fixed ticks (a week takes
+    // milliseconds). Returns the simulated seconds, clipped to kMaxCatchUpSeconds.
+    double fastForward(double seconds, float maxStep = kCatchUpStep);
+    // Fast-forward over the real time since lastWallClock, then stamp it. The first
+    // call only stamps.
+    double catchUpTo(std::int64_t unixSeconds);
+
+    void apply(const GardenCommand& command);
+    // Hash of everything the simulation reads, to catch a replay diverging
+    std::uint64_t stateHash() const;
+
+    PlantSim plants;
+    SoilGrid soil;
+    double time = 0.0;  // simulated seconds
+    std::uint64_t tick = 0;
+    std::int64_t lastWallClock = 0;  // unix seconds, 0 = never stamped
+    std::vector<std::uint64_t>* tickHashes = nullptr;  // when set, every tick appends stateHash()
+
+   private:
+    float accumulator = 0.f;
+};
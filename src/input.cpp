@@ -0,0 +1,125 @@
+#include "input.h"
+
+#include <GLFW/glfw3.h>
+
+#include <bit>
+
+static_assert(Input::kKeyCount == GLFW_KEY_LAST + 1);
+static_assert(Input::kMouseButtons == GLFW_MOUSE_BUTTON_LAST + 1);
+
+// ----------------------------- event ring ----------------------------
+
+bool Input::EventRing::push(const Event& e) {
+    const std::uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == kCapacity) return false;
+    events[t & (kCapacity - 1)] = e;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+bool Input::EventRing::pop(Event& e) {
+    const std::uint32_t h = head.load(std::memory_order_relaxed);
+    if (h == tail.load(std::memory_order_acquire)) return false;
+    e = events[h & (kCapacity - 1)];
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+// ----------------------------- input ---------------------------------
+
+Input::Input() {
+    for (auto& keys : bindings) keys.fill(-1);
+    bind(kActionQuit, GLFW_KEY_ESCAPE);
+    bind(kActionSceneGame, GLFW_KEY_F1);
+    bind(kActionSceneGame2, GLFW_KEY_F2);
+    bind(kActionPause, GLFW_KEY_F3);
+    bind(kActionResume, GLFW_KEY_F4);
+}
+
+void Input::attach(GLFWwindow* window) {
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetWindowFocusCallback(window, focusCallback);
+    glfwSetCursorPosCallback(window, cursorCallback);
+}
+
+void Input::keyCallback(GLFWwindow*, int key, int, int action, int) {
+    if (action != GLFW_REPEAT) instance().push(key, action == GLFW_PRESS);
+}
+
+void Input::mouseButtonCallback(GLFWwindow*, int button, int action, int) {
+    instance().push(mouseButton(button), action == GLFW_PRESS);
+}
+
+void Input::focusCallback(GLFWwindow*, int focused) {
+    // the release events for keys held while switching away never arrive
+    if (!focused) instance().push(kReleaseAll, false);
+}
+
+void Input::cursorCallback(GLFWwindow*, double x, double y) {
+    instance().push(kCursorMove, false, static_cast<float>(x), static_cast<float>(y));
+}
+
+void Input::push(int code, bool down, float x, float y) {
+    if (!valid(code) && code != kReleaseAll && code != kCursorMove) return;
+    if (!ring.push({static_cast<std::uint16_t>(code), down, x, y, Clock::now()}))
+        dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Input::beginFrame() {
+    pressedKeys.reset();
+    releasedKeys.reset();
+    hadEvent = false;
+
+    for (Event e; ring.pop(e);) {
+        if (!hadEvent) {
+            firstEvent = e.time;
+            hadEvent = true;
+        }
+        if (e.code == kCursorMove) {
+            cursorPos = {e.x, e.y};
+        } else if (e.code == kReleaseAll) {
+            releasedKeys |= heldKeys;
+            heldKeys.reset();
+        } else if (e.down) {
+            if (!heldKeys[e.code]) pressedKeys.set(e.code);
+            heldKeys.set(e.code);
+        } else {
+            if (heldKeys[e.code]) releasedKeys.set(e.code);
+            heldKeys.reset(e.code);
+        }
+    }
+
+    heldActions = pressedActions = releasedActions = 0;
+    for (int a = 0; a < kActionCount; ++a) {
+        for (int key : bindings[a]) {
+            if (key < 0) continue;
+            const auto bit = static_cast<std::uint8_t>(1u << a);
+            if (heldKeys[key]) heldActions |= bit;
+            if (pressedKeys[key]) pressedActions |= bit;
+            if (releasedKeys[key]) releasedActions |= bit;
+        }
+    }
+}
+
+void Input::bind(InputAction action, int key) {
+    if (!valid(key)) return;
+    auto& keys = bindings[std::countr_zero(static_cast<unsigned>(action))];
+    for (int& k : keys) {
+        if (k == key) return;
+        if (k < 0) {
+            k = key;
+            return;
+        }
+    }
+    keys.back() = key;  // full: the newest binding replaces the last
+}
+
+void Input::unbind(InputAction action) {
+    bindings[std::countr_zero(static_cast<unsigned>(action))].fill(-1);
+}
+
+bool Input::firstEventTime(Clock::time_point& time) const {
+    if (hadEvent) time = firstEvent;
+    return hadEvent;
+}
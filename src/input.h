@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+
+#include "util.h"
+
+struct GLFWwindow;
+
+// Engine-level actions, as bits so a frame's worth fits in a byte (and in a replay)
+enum InputAction : std::uint8_t {
+    kActionQuit = 1 << 0,
+    kActionSceneGame = 1 << 1,
+    kActionSceneGame2 = 1 << 2,
+    kActionPause = 1 << 3,
+    kActionResume = 1 << 4,
+};
+
+// Keyboard, mouse button and cursor input, event-driven. GLFW callbacks push timestamped
+// events into a lock-free ring; beginFrame drains it once per frame into held / pressed /
+// released bit sets and the cursor position, so gameplay and the UI read input in O(1)
+// without calling into the platform.
+// A tap that starts and ends within one frame still reports pressed and released.
+// Keys are GLFW key codes; mouse buttons are mouseButton(GLFW_MOUSE_BUTTON_*).
+class Input {
+   public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr int kKeyCount = 349;  // GLFW_KEY_LAST + 1
+    static constexpr int kMouseButtons = 8;
+    static constexpr int kActionCount = 8;
+    static constexpr int kBindingsPerAction = 2;
+
+    // Singleton access
+    static Input& instance() {
+        static Input inst;
+        return inst;
+    }
+
+    // Delete copy/move
+    Input(const Input&) = delete;
+    Input& operator=(const Input&) = delete;
+    Input(Input&&) = delete;
+    Input& operator=(Input&&) = delete;
+
+    // Install the GLFW callbacks. Call before ImGui_ImplGlfw_InitForOpenGL so ImGui
+    // chains to them.
+    void attach(GLFWwindow* window);
+
+    // Apply the events since the last call; once per frame, after polling
+    void beginFrame();
+
+    static constexpr int mouseButton(int button) { return kKeyCount + button; }
+    bool held(int key) const { return valid(key) && heldKeys[key]; }
+    bool pressed(int key) const { return valid(key) && pressedKeys[key]; }
+    bool released(int key) const { return valid(key) && releasedKeys[key]; }
+    // Window pixels from the top left, as of the last cursor event applied
+    Vec2 cursor() const { return cursorPos; }
+
+    // Action mapping: up to kBindingsPerAction keys per action
+    void bind(InputAction action, int key);
+    void unbind(InputAction action);
+    std::uint8_t actionsHeld() const { return heldActions; }
+    std::uint8_t actionsPressed() const { return pressedActions; }
+    std::uint8_t actionsReleased() const { return releasedActions; }
+
+    // When this frame's first event happened (for input-to-present latency); false if
+    // the frame had none
+    bool firstEventTime(Clock::time_point& time) const;
+    int droppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+   private:
+    Input();
+
+    static constexpr int kCodes = kKeyCount + kMouseButtons;
+    static constexpr std::uint16_t kReleaseAll = 0xffff;  // focus lost: nothing stays held
+    static constexpr std::uint16_t kCursorMove = 0xfffe;  // x, y are the new position
+
+    struct Event {
+        std::uint16_t code;
+        bool down;
+        float x, y;
+        Clock::time_point time;
+    };
+
+    // Single-producer (callbacks) / single-consumer (beginFrame) ring
+    struct EventRing {
+        static constexpr std::uint32_t kCapacity = 256;  // power of two
+        std::array<Event, kCapacity> events;
+        std::atomic<std::uint32_t> head{0};  // next to pop
+        std::atomic<std::uint32_t> tail{0};  // next to push
+
+        bool push(const Event& e);
+        bool pop(Event& e);
+    };
+
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+    static void focusCallback(GLFWwindow* window, int focused);
+    static void cursorCallback(GLFWwindow* window, double x, double y);
+    void push(int code, bool down, float x = 0.f, float y = 0.f);
+
+    static bool valid(int code) { return code >= 0 && code < kCodes; }
+
+    EventRing ring;
+    std::atomic<int> dropped{0};
+
+    std::bitset<kCodes> heldKeys, pressedKeys, releasedKeys;
+    Vec2 cursorPos = {0.f, 0.f};
+    std::array<std::array<int, kBindingsPerAction>, kActionCount> bindings;
+    std::uint8_t heldActions = 0, pressedActions = 0, releasedActions = 0;
+    Clock::time_point firstEvent{};
+    bool hadEvent = false;
+};
@@ -0,0 +1,100 @@
+#include "jobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "trace.h"
+
+namespace {
+thread_local bool onWorker = false;
+}  // namespace
+
+JobSystem::JobSystem() {
+    // leave one core for the main (render) thread
+    const int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    workers.reserve(count);
+    for (int i = 0; i < count; ++i) workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& w : workers) w.join();
+}
+
+void JobSystem::push(std::move_only_function<void()> job) {
+    {
+        std::lock_guard lock(mutex);
+        ALLOC_TAG(Static);  // the queue's blocks, kept until exit
+        queue.push_back(std::move(job));
+    }
+    cv.notify_one();
+}
+
+void JobSystem::workerLoop(int index) {
+    const std::string name = "worker " + std::to_string(index);
+    Trace::setThreadName(name.c_str());
+    onWorker = true;
+
+    for (;;) {
+        std::move_only_function<void()> job;
+        {
+            std::unique_lock lock(mutex);
+            cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping && queue.empty()) return;
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        job();
+    }
+}
+
+void JobSystem::ForState::run() {
+    int finished = 0;
+    for (int c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks; ++finished) {
+        const int begin = c * grain;
+        (*fn)(begin, std::min(begin + grain, count));
+    }
+    if (finished > 0 && remaining.fetch_sub(finished, std::memory_order_acq_rel) == finished) remaining.notify_all();
+}
+
+std::shared_ptr<JobSystem::ForState> JobSystem::idleForState() {
+    std::lock_guard lock(mutex);
+    for (const auto& state : forStates)
+        if (state.use_count() == 1) {
+            std::atomic_thread_fence(std::memory_order_acquire);  // after the last helper's writes
+            return state;
+        }
+    ALLOC_TAG(Static);
+    return forStates.emplace_back(std::make_shared<ForState>());
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int begin, int end)>& fn) {
+    if (count <= 0) return;
+    grain = std::max(grain, 1);
+
+    const int chunks = (count + grain - 1) / grain;
+    const int helpers = std::min(chunks - 1, workerCount());
+    if (helpers <= 0 || onWorker) {
+        fn(0, count);
+        return;
+    }
+
+    // chunks are claimed dynamically so a slow worker doesn't hold everyone up, and
+    // only finished chunks are waited for: a helper stuck behind a long job in the queue
+    // just finds nothing left when it gets to run
+    const std::shared_ptr<ForState> state = idleForState();
+    state->fn = &fn;
+    state->count = count;
+    state->grain = grain;
+    state->chunks = chunks;
+    state->next.store(0, std::memory_order_relaxed);
+    state->remaining.store(chunks, std::memory_order_relaxed);
+    for (int i = 0; i < helpers; ++i) push([state] { state->run(); });
+    state->run();
+    for (int left; (left = state->remaining.load(std::memory_order_acquire)) != 0;) state->remaining.wait(left);
+}
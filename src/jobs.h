@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "alloc_tracker.h"
+
+// Fixed pool of worker threads for background work (asset decoding, simulation).
+// Jobs must not touch GL: the context is only current on the main thread.
+class JobSystem {
+   public:
+    // Singleton access
+    static JobSystem& instance() {
+        ALLOC_TAG(Static);  // the workers and queue live until exit
+        static JobSystem inst;
+        return inst;
+    }
+
+    // Delete copy/move
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    JobSystem(JobSystem&&) = delete;
+    JobSystem& operator=(JobSystem&&) = delete;
+
+    template <class F>
+    auto submit(F&& f) -> std::future<std::invoke_result_t<F>> {
+        std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(f));
+        auto future = task.get_future();
+        push([task = std::move(task)]() mutable { task(); });
+        return future;
+    }
+
+    // Split [0, count) into chunks of `grain` run on the workers and the calling thread.
+    // Blocks until every chunk is done, but never on a worker that is busy elsewhere: the
+    // caller takes whatever chunks no worker has started. Called from a job, it runs
+    // serially on that worker.
+    void parallelFor(int count, int grain, const std::function<void(int begin, int end)>& fn);
+
+    int workerCount() const { return static_cast<int>(workers.size()); }
+
+   private:
+    JobSystem();
+    ~JobSystem();
+
+    // One parallelFor's progress. Shared with its helper jobs, which may only get to run
+    // after the call returned; they then find no chunk left and drop their reference.
+    struct ForState {
+        const std::function<void(int, int)>* fn = nullptr;  // valid while chunks remain
+        int count = 0, grain = 1, chunks = 0;
+        std::atomic<int> next{0};       // next chunk to claim
+        std::atomic<int> remaining{0};  // chunks not finished yet
+        void run();
+    };
+
+    void push(std::move_only_function<void()> job);
+    void workerLoop(int index);
+    std::shared_ptr<ForState> idleForState();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::move_only_function<void()>> queue;
+    bool stopping = false;
+    std::vector<std::shared_ptr<ForState>> forStates;  // reused once no helper holds one
+};
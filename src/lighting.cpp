@@ -0,0 +1,78 @@
+#include "lighting.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "profiler.h"
+
+float sunHeight(double timeOfDay) {
+    const double hours = std::fmod(timeOfDay / 3600.0, 24.0);
+    return static_cast<float>(std::sin((hours - 6.0) / 12.0 * 3.14159265358979));
+}
+
+Color sunlight(double timeOfDay) {
+    constexpr Color kNight{0.12f, 0.14f, 0.3f, 1.f};
+    constexpr Color kDusk{0.95f, 0.55f, 0.35f, 1.f};
+    constexpr Color kDay{1.f, 1.f, 1.f, 1.f};
+
+    const float height = sunHeight(timeOfDay);
+    auto mix = [](Color a, Color b, float t) {
+        t = std::clamp(t, 0.f, 1.f);
+        return Color{a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, 1.f};
+    };
+    // night -> dusk while the sun is just below the horizon, dusk -> day as it rises
+    if (height < 0.f) return mix(kNight, kDusk, 1.f + height / 0.15f);
+    return mix(kDusk, kDay, height / 0.35f);
+}
+
+void LightingSystem::add(const Light& light) {
+    if (static_cast<int>(lights.size()) < kMaxLights) lights.push_back(light);
+}
+
+void LightingSystem::cull(Vec2 viewport) {
+    PROFILE_SCOPE("light culling");
+    tilesX_ = std::max(1, static_cast<int>(std::ceil(viewport.x / kTileSize)));
+    tilesY_ = std::max(1, static_cast<int>(std::ceil(viewport.y / kTileSize)));
+    ranges.assign(static_cast<std::size_t>(tilesX_) * tilesY_ * 2, 0u);
+    spans.clear();
+    entries.clear();
+
+    // which tiles each light's square reaches, and how many entries each tile needs
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < lights.size(); ++i) {
+        const Light& l = lights[i];
+        if (l.radius <= 0.f || l.intensity <= 0.f) continue;
+        if (l.pos.x + l.radius < 0.f || l.pos.y + l.radius < 0.f || l.pos.x - l.radius >= viewport.x ||
+            l.pos.y - l.radius >= viewport.y)
+            continue;
+        TileSpan s{static_cast<std::uint32_t>(i),
+                   std::max(0, static_cast<int>((l.pos.x - l.radius) / kTileSize)),
+                   std::max(0, static_cast<int>((l.pos.y - l.radius) / kTileSize)),
+                   std::min(tilesX_ - 1, static_cast<int>((l.pos.x + l.radius) / kTileSize)),
+                   std::min(tilesY_ - 1, static_cast<int>((l.pos.y + l.radius) / kTileSize))};
+        const std::size_t covered = static_cast<std::size_t>(s.x1 - s.x0 + 1) * (s.y1 - s.y0 + 1);
+        if (total + covered > kMaxTileEntries) continue;
+        total += covered;
+        spans.push_back(s);
+        for (int y = s.y0; y <= s.y1; ++y)
+            for (int x = s.x0; x <= s.x1; ++x) ++ranges[2 * (static_cast<std::size_t>(y) * tilesX_ + x) + 1];
+    }
+
+    // counts -> first entries, then fill in the same order
+    std::uint32_t next = 0;
+    maxPerTile = 0;
+    for (std::size_t t = 0; t < ranges.size(); t += 2) {
+        ranges[t] = next;
+        next += ranges[t + 1];
+        maxPerTile = std::max(maxPerTile, static_cast<int>(ranges[t + 1]));
+        ranges[t + 1] = 0;
+    }
+    entries.resize(total);
+    for (const TileSpan& s : spans)
+        for (int y = s.y0; y <= s.y1; ++y)
+            for (int x = s.x0; x <= s.x1; ++x) {
+                std::uint32_t* range = &ranges[2 * (static_cast<std::size_t>(y) * tilesX_ + x)];
+                entries[range[0] + range[1]++] = s.light;
+            }
+    visible = static_cast<int>(spans.size());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "util.h"
+
+// A point light in window pixels from the top left, like sprites and the UI
+struct Light {
+    Vec2 pos = {0.f, 0.f};
+    float radius = 64.f;  // px where it has faded to nothing
+    Color color = {1.f, 1.f, 1.f, 1.f};
+    float intensity = 1.f;
+};
+
+// Light buffer resolution: the window's size divided by this
+enum class LightQuality : std::uint8_t { Full = 1, Half = 2, Quarter = 4 };
+
+// The sun at a time of day (seconds since midnight): -1 at midnight, 0 on the horizon at
+// 6:00 and 18:00, 1 at noon
+float sunHeight(double timeOfDay);
+// Ambient light for it: dark blue at night, warm around sunrise and sunset, white at noon
+Color sunlight(double timeOfDay);
+
+// Lights for one frame. Submitted like sprites (clear, then add every frame), then
+// binned into screen tiles so the light pass only evaluates, per pixel, the lights
+// that reach its tile (Renderer::drawLights). Light adds to the ambient; the sum
+// multiplies the scene.
+class LightingSystem {
+   public:
+    static constexpr int kTileSize = 32;            // window px per culling tile
+    static constexpr int kMaxLights = 2048;         // adds beyond this are dropped
+    static constexpr int kMaxTileEntries = 1 << 16;  // light-in-tile pairs; lights past it are dropped
+
+    Color ambient = {1.f, 1.f, 1.f, 1.f};
+    LightQuality quality = LightQuality::Half;
+
+    void clear() { lights.clear(); }
+    void add(const Light& light);
+    std::span<const Light> all() const { return lights; }
+
+    // Bins the lights into the tiles of a window this size; off-screen ones go nowhere
+    void cull(Vec2 viewport);
+    int tilesX() const { return tilesX_; }
+    int tilesY() const { return tilesY_; }
+    // Per tile, row by row from the top left: first entry in tileLights() and count
+    std::span<const std::uint32_t> tileRanges() const { return ranges; }
+    std::span<const std::uint32_t> tileLights() const { return entries; }
+
+    int visibleLights() const { return visible; }
+    int maxLightsPerTile() const { return maxPerTile; }
+
+   private:
+    struct TileSpan {
+        std::uint32_t light;
+        int x0, y0, x1, y1;  // tiles covered, inclusive
+    };
+
+    std::vector<Light> lights;
+    std::vector<TileSpan> spans;
+    std::vector<std::uint32_t> ranges, entries;
+    int tilesX_ = 0, tilesY_ = 0;
+    int visible = 0, maxPerTile = 0;
+};
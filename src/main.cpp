@@ -1,12 +1,55 @@
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <exception>
 #include <print>
+#include <string_view>
 
+#include "benchmark.h"
 #include "renderer.h"
+#include "replay.h"
+
+int main(int argc, char** argv) {
+    // --bench [report.json] [--frames N]
+    // --present vsync|adaptive|uncapped|limited [--fps N]
+    // --record replay.bin | --replay replay.bin [--headless]
+    bool bench = false;
+    const char* recordPath = nullptr;
+    const char* replayPath = nullptr;
+    bool headless = false;
+    BenchmarkOptions benchOptions;
+    PresentMode present = PresentMode::VSync;
+    double targetFps = 60.0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg == "--bench") {
+            bench = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') benchOptions.reportPath = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            benchOptions.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--present" && i + 1 < argc) {
+            const std::string_view mode = argv[++i];
+            present = mode == "adaptive"   ? PresentMode::AdaptiveVSync
+                      : mode == "uncapped" ? PresentMode::Uncapped
+                      : mode == "limited"  ? PresentMode::Limited
+                                           : PresentMode::VSync;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            targetFps = std::atof(argv[++i]);
+            present = PresentMode::Limited;
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--headless") {
+            headless = true;
+        }
+    }
+
+    // garden-only playback at full speed, no window or GL
+    if (replayPath && headless) return Replay::runHeadless(replayPath) ? EXIT_SUCCESS : EXIT_FAILURE;
 
-int main() {
     if (!glfwInit()) {
         std::println(stderr, "Failed to initialize GLFW");
         std::exit(EXIT_FAILURE);
@@ -24,7 +67,6 @@ int main() {
         std::exit(EXIT_FAILURE);
     }
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(1);  // vsync
 
     // glad
     if (!gladLoadGL(glfwGetProcAddress)) {
@@ -37,7 +79,15 @@ int main() {
     // create renderer
     try {
         Renderer renderer(window);
+        if (bench) return runBenchmarks(renderer, benchOptions) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+        renderer.framePacer().setTargetFps(targetFps);
+        renderer.framePacer().setMode(present);
+
+        if (recordPath && !Replay::instance().startRecording(recordPath)) return EXIT_FAILURE;
+        if (replayPath && !Replay::instance().startPlayback(replayPath)) return EXIT_FAILURE;
         renderer.run();
+        Replay::instance().stop();
         return EXIT_SUCCESS;
     } catch (const std::exception& e) {
         std::println(stderr, "Fatal error: %s\n", e.what());
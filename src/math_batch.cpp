@@ -0,0 +1,74 @@
+#include "math_batch.h"
+
+#include <bit>
+
+#include "simd.h"
+
+// ----------------------------- kernels -------------------------------
+
+namespace {
+template <class V>
+int transformRange(const Transform2D& t, const float* x, const float* y, float* outX, float* outY, int begin,
+                   int end) {
+    const V a = V::set1(t.a), b = V::set1(t.b), c = V::set1(t.c), d = V::set1(t.d);
+    const V tx = V::set1(t.tx), ty = V::set1(t.ty);
+
+    int i = begin;
+    for (; i + V::width <= end; i += V::width) {
+        // both loads before either store, so the outputs may alias the inputs
+        const V px = V::load(x + i);
+        const V py = V::load(y + i);
+        (a * px + c * py + tx).store(outX + i);
+        (b * px + d * py + ty).store(outY + i);
+    }
+    return i;
+}
+
+template <class V>
+int overlapRange(const Rect& q, const float* x, const float* y, const float* w, const float* h, int begin, int end,
+                 int* indices, int& found) {
+    const V left = V::set1(q.x), right = V::set1(q.x + q.w);
+    const V top = V::set1(q.y), bottom = V::set1(q.y + q.h);
+
+    int i = begin;
+    for (; i + V::width <= end; i += V::width) {
+        const V rx = V::load(x + i);
+        const V ry = V::load(y + i);
+        const auto inX = V::both(rx < right, left < rx + V::load(w + i));
+        const auto inY = V::both(ry < bottom, top < ry + V::load(h + i));
+
+        // one bit per lane; usually zero, so the loop below rarely runs
+        for (auto bits = static_cast<unsigned>(V::bits(V::both(inX, inY))); bits != 0; bits &= bits - 1)
+            indices[found++] = i + std::countr_zero(bits);
+    }
+    return i;
+}
+}  // namespace
+
+// ----------------------------- entry points --------------------------
+
+void batch::transformPoints(const Transform2D& t, const float* x, const float* y, float* outX, float* outY,
+                            int count) {
+    const int done = transformRange<simd::Float>(t, x, y, outX, outY, 0, count);
+    transformRange<simd::F1>(t, x, y, outX, outY, done, count);
+}
+
+void batch::transformPointsScalar(const Transform2D& t, const float* x, const float* y, float* outX, float* outY,
+                                  int count) {
+    transformRange<simd::F1>(t, x, y, outX, outY, 0, count);
+}
+
+int batch::overlapping(const Rect& query, const float* x, const float* y, const float* w, const float* h, int count,
+                       int* indices) {
+    int found = 0;
+    const int done = overlapRange<simd::Float>(query, x, y, w, h, 0, count, indices, found);
+    overlapRange<simd::F1>(query, x, y, w, h, done, count, indices, found);
+    return found;
+}
+
+int batch::overlappingScalar(const Rect& query, const float* x, const float* y, const float* w, const float* h,
+                             int count, int* indices) {
+    int found = 0;
+    overlapRange<simd::F1>(query, x, y, w, h, 0, count, indices, found);
+    return found;
+}
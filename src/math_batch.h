@@ -0,0 +1,24 @@
+#pragma once
+
+#include "util.h"
+
+// Math over many values at once, on structure-of-arrays data so each call runs a full
+// simd::Float at a time (SSE2, or AVX with make ARCH=-mavx2; scalar elsewhere). The
+// *Scalar versions do the same one element at a time, as a reference for tests and
+// benchmarks.
+namespace batch {
+
+// (outX[i], outY[i]) = t.apply((x[i], y[i])). The outputs may alias the inputs.
+void transformPoints(const Transform2D& t, const float* x, const float* y, float* outX, float* outY, int count);
+void transformPointsScalar(const Transform2D& t, const float* x, const float* y, float* outX, float* outY,
+                           int count);
+
+// Rects given as x/y/w/h arrays; writes the index of every one that overlaps query
+// (see overlaps() in util.h) to indices, in order, and returns how many there were.
+// indices must have room for count entries.
+int overlapping(const Rect& query, const float* x, const float* y, const float* w, const float* h, int count,
+                int* indices);
+int overlappingScalar(const Rect& query, const float* x, const float* y, const float* w, const float* h, int count,
+                      int* indices);
+
+}  // namespace batch
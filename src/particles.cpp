@@ -0,0 +1,131 @@
+#include "particles.h"
+
+#include <algorithm>
+
+#include "jobs.h"
+#include "profiler.h"
+#include "simd.h"
+
+// ----------------------------- kernel --------------------------------
+
+namespace {
+// Particles per job; small pools run on the calling thread alone
+constexpr int kGrain = 16384;
+
+// Semi-implicit Euler for particles [begin, end), a full vector at a time
+template <class V>
+int integrateRange(ParticleSystem::Pool& p, const ParticleType& type, float dt, int begin, int end) {
+    const V vdt = V::set1(dt);
+    const V damping = V::set1(std::max(0.f, 1.f - type.drag * dt));
+    const V ax = V::set1(type.acceleration.x * dt);
+    const V ay = V::set1(type.acceleration.y * dt);
+
+    float* x = p.x.data();
+    float* y = p.y.data();
+    float* vx = p.vx.data();
+    float* vy = p.vy.data();
+    float* age = p.age.data();
+    const float* aging = p.aging.data();
+
+    int i = begin;
+    for (; i + V::width <= end; i += V::width) {
+        const V nvx = V::load(vx + i) * damping + ax;
+        const V nvy = V::load(vy + i) * damping + ay;
+        (V::load(x + i) + nvx * vdt).store(x + i);
+        (V::load(y + i) + nvy * vdt).store(y + i);
+        nvx.store(vx + i);
+        nvy.store(vy + i);
+        (V::load(age + i) + V::load(aging + i) * vdt).store(age + i);
+    }
+    return i;
+}
+
+// Swap-remove everything past its lifetime
+void compact(ParticleSystem::Pool& p) {
+    int n = p.size();
+    for (int i = 0; i < n;) {
+        if (p.age[i] < 1.f) {
+            ++i;
+            continue;
+        }
+        --n;
+        p.x[i] = p.x[n];
+        p.y[i] = p.y[n];
+        p.vx[i] = p.vx[n];
+        p.vy[i] = p.vy[n];
+        p.age[i] = p.age[n];
+        p.aging[i] = p.aging[n];
+    }
+    for (auto* v : {&p.x, &p.y, &p.vx, &p.vy, &p.age, &p.aging}) v->resize(n);
+}
+}  // namespace
+
+// ----------------------------- system --------------------------------
+
+std::uint16_t ParticleSystem::addType(const ParticleType& type) {
+    types.push_back(type);
+    pools.emplace_back();
+    return static_cast<std::uint16_t>(types.size() - 1);
+}
+
+int ParticleSystem::addEmitter(const ParticleEmitter& emitter) {
+    emitters.push_back(emitter);
+    return static_cast<int>(emitters.size() - 1);
+}
+
+void ParticleSystem::burst(std::uint16_t type, Rect area, Vec2 velocity, Vec2 spread, int count) {
+    spawn(type, area, velocity, spread, count);
+}
+
+float ParticleSystem::random() {
+    rng = rng * 1664525u + 1013904223u;
+    return static_cast<float>(rng >> 8) / 16777216.f;
+}
+
+void ParticleSystem::spawn(std::uint16_t type, Rect area, Vec2 velocity, Vec2 spread, int count) {
+    Pool& p = pools[type];
+    count = std::min(count, kMaxPerType - p.size());
+    const ParticleType& t = types[type];
+    for (int i = 0; i < count; ++i) {
+        p.x.push_back(area.x + random() * area.w);
+        p.y.push_back(area.y + random() * area.h);
+        p.vx.push_back(velocity.x + (random() * 2.f - 1.f) * spread.x);
+        p.vy.push_back(velocity.y + (random() * 2.f - 1.f) * spread.y);
+        p.age.push_back(0.f);
+        p.aging.push_back(1.f / (t.lifetime * (1.f + (random() * 2.f - 1.f) * t.lifetimeJitter)));
+    }
+}
+
+void ParticleSystem::update(float dt) {
+    for (ParticleEmitter& e : emitters) {
+        e.pending += e.rate * dt;
+        const int count = static_cast<int>(e.pending);
+        e.pending -= static_cast<float>(count);
+        if (count > 0) spawn(e.type, e.area, e.velocity, e.spread, count);
+    }
+
+    for (std::size_t t = 0; t < types.size(); ++t) {
+        Pool& p = pools[t];
+        if (p.size() == 0) continue;
+
+        // one scope per type, so each effect's cost shows up on its own
+        PROFILE_SCOPE(types[t].name);
+        const ParticleType& type = types[t];
+        JobSystem::instance().parallelFor(p.size(), kGrain, [&](int begin, int end) {
+            const int done = integrateRange<simd::Float>(p, type, dt, begin, end);
+            integrateRange<simd::F1>(p, type, dt, done, end);
+        });
+        compact(p);
+    }
+}
+
+void ParticleSystem::clear() {
+    for (Pool& p : pools) p = {};
+    for (ParticleEmitter& e : emitters) e.pending = 0.f;
+}
+
+int ParticleSystem::size() const {
+    int total = 0;
+    for (const Pool& p : pools) total += p.size();
+    return total;
+}
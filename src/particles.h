@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "util.h"
+
+// What every particle of one kind shares; one pool, and one draw, per type.
+// Positions are in the same pixel space as Renderer::fillRect.
+struct ParticleType {
+    const char* name = "particles";  // also its profiler scope: must outlive the system
+    Color color = {1.f, 1.f, 1.f, 1.f};
+    float size = 4.f;            // px
+    float lifetime = 2.f;        // seconds
+    float lifetimeJitter = 0.f;  // +- fraction of lifetime, so a burst does not vanish at once
+    Vec2 acceleration = {0.f, 0.f};
+    float drag = 0.f;            // share of velocity lost per second
+};
+
+// Presets for the garden's weather and tools
+namespace particles {
+inline constexpr ParticleType kRain{.name = "rain", .color = {0.6f, 0.7f, 1.f, 0.6f}, .size = 2.f, .lifetime = 1.6f,
+                                    .lifetimeJitter = 0.2f, .acceleration = {0.f, -300.f}};
+inline constexpr ParticleType kSpray{.name = "spray", .color = {0.5f, 0.7f, 1.f, 0.8f}, .size = 3.f,
+                                     .lifetime = 0.8f, .lifetimeJitter = 0.3f, .acceleration = {0.f, -400.f},
+                                     .drag = 0.5f};
+inline constexpr ParticleType kPollen{.name = "pollen", .color = {1.f, 0.9f, 0.3f, 0.9f}, .size = 3.f,
+                                      .lifetime = 4.f, .lifetimeJitter = 0.5f, .drag = 0.8f};
+inline constexpr ParticleType kLeaves{.name = "leaves", .color = {0.8f, 0.45f, 0.1f, 1.f}, .size = 6.f,
+                                      .lifetime = 8.f, .lifetimeJitter = 0.25f, .acceleration = {4.f, -12.f},
+                                      .drag = 0.6f};
+}  // namespace particles
+
+// Spawns particles of one type at a steady rate, anywhere inside area
+struct ParticleEmitter {
+    std::uint16_t type = 0;
+    Rect area = {0.f, 0.f, 0.f, 0.f};
+    Vec2 velocity = {0.f, 0.f};
+    Vec2 spread = {0.f, 0.f};  // +- added to velocity per particle
+    float rate = 0.f;          // particles per second; 0 pauses the emitter
+    float pending = 0.f;       // fraction of a particle carried to the next update
+};
+
+// Particles for effects that do not feed back into the game (rain, spray, pollen).
+// Each type's particles are stored structure-of-arrays, so update streams over
+// contiguous floats with simd::Float on the job system's workers, and the position and
+// age arrays upload to the GPU as they are for one instanced draw per type
+// (Renderer::drawParticles).
+class ParticleSystem {
+   public:
+    static constexpr int kMaxPerType = 1 << 18;  // spawns beyond this are dropped
+
+    // index i across the arrays is one particle
+    struct Pool {
+        std::vector<float> x, y;
+        std::vector<float> vx, vy;
+        std::vector<float> age;    // 0 at birth, 1 at death
+        std::vector<float> aging;  // 1 / lifetime
+        int size() const { return static_cast<int>(x.size()); }
+    };
+
+    std::uint16_t addType(const ParticleType& type);
+    const ParticleType& type(std::uint16_t id) const { return types[id]; }
+    int typeCount() const { return static_cast<int>(types.size()); }
+    const Pool& pool(std::uint16_t type) const { return pools[type]; }
+
+    // Emitters are never removed; set rate to 0 to stop one
+    int addEmitter(const ParticleEmitter& emitter);
+    ParticleEmitter& emitter(int index) { return emitters[index]; }
+
+    // count particles at once, e.g. a watering can's splash
+    void burst(std::uint16_t type, Rect area, Vec2 velocity, Vec2 spread, int count);
+
+    // Emit, move and age everything, then drop the particles that died
+    void update(float dt);
+    void clear();
+    int size() const;
+
+   private:
+    float random();  // 0..1
+    void spawn(std::uint16_t type, Rect area, Vec2 velocity, Vec2 spread, int count);
+
+    std::vector<ParticleType> types;
+    std::vector<Pool> pools;
+    std::vector<ParticleEmitter> emitters;
+    std::uint32_t rng = 12345u;
+};
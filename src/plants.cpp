@@ -0,0 +1,547 @@
+#include "plants.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "simd.h"
+#include "soil.h"
+#include "trace.h"
+
+// ----------------------------- kernel --------------------------------
+
+namespace {
+// One growth step for plants [begin, end) of a pool. Branch-free so the same
+// code runs one plant at a time (simd::F1) or a full vector at a time.
+template <class V>
+int tickRange(PlantSim::Pool& p, const PlantSpecies& s, float dt, int begin, int end) {
+    const V zero = V::set1(0.f);
+    const V one = V::set1(1.f);
+    const V invWilt = V::set1(1.f / s.wiltThreshold);
+    const V invNutrient = V::set1(1.f / s.nutrientThreshold);
+    const V growth = V::set1(s.growthRate * dt);
+    const V maxStage = V::set1(s.maxStage);
+    const V waterUse = V::set1(s.waterUse * dt);
+    const V nutrientUse = V::set1(s.nutrientUse);
+    const V recover = V::set1(s.recoverRate * dt);
+    const V damage = V::set1(s.wiltDamage * dt);
+
+    float* stage = p.stage.data();
+    float* water = p.water.data();
+    float* nutrients = p.nutrients.data();
+    float* health = p.health.data();
+
+    int i = begin;
+    for (; i + V::width <= end; i += V::width) {
+        V st = V::load(stage + i);
+        V w = V::load(water + i);
+        V n = V::load(nutrients + i);
+        V h = V::load(health + i);
+
+        // 0..1 sufficiency factors
+        const V wf = min(w * invWilt, one);
+        const V nf = min(n * invNutrient, one);
+
+        // grow, capped at the final stage
+        const V grown = min(st + growth * wf * nf * h, maxStage);
+        const V delta = grown - st;
+        st = grown;
+
+        // consume
+        w = max(w - waterUse, zero);
+        n = max(n - delta * nutrientUse, zero);
+
+        // heal while watered, wilt proportionally to the shortfall otherwise
+        const V dh = select(wf >= one, recover, zero - damage * (one - wf));
+        h = simd::clamp(h + dh, zero, one);
+
+        st.store(stage + i);
+        w.store(water + i);
+        n.store(nutrients + i);
+        h.store(health + i);
+    }
+    return i;
+}
+
+// Move water and nitrogen from each plant's tile into plants [begin, end) of a pool
+void absorbRange(PlantSim::Pool& p, const PlantSpecies& s, float* moisture, float* nitrogen, float dt, int begin,
+                 int end) {
+    const float rate = std::min(s.uptakeRate * dt, 1.f);
+    for (int i = begin; i < end; ++i) {
+        const std::uint32_t t = p.tile[i];
+        const float w = std::min(moisture[t] * rate, 1.f - p.water[i]);
+        const float n = std::min(nitrogen[t] * rate * 0.1f, 1.f - p.nutrients[i]);
+        p.water[i] += w;
+        moisture[t] -= w;
+        p.nutrients[i] += n;
+        nitrogen[t] -= n;
+    }
+}
+
+// ----------------------------- sleeping ------------------------------
+
+constexpr std::uint64_t kNever = std::numeric_limits<std::uint64_t>::max();
+constexpr float kTopUpSlack = 1e-5f;  // float noise allowed when checking a plant is topped up
+
+// Per-tick change of a sleeping plant: growth until full size, and without soil its
+// water and nutrients run down
+struct SleepRates {
+    float stage, water, nutrients;
+};
+
+SleepRates sleepRates(const PlantSpecies& s, float stage, float dt, bool soilFed) {
+    const float growth = stage < s.maxStage ? s.growthRate * dt : 0.f;
+    return {growth, soilFed ? 0.f : -s.waterUse * dt, soilFed ? 0.f : -s.nutrientUse * growth};
+}
+
+// Values of a plant that slept at the given ones, ticks later
+void extrapolate(const PlantSpecies& s, float dt, bool soilFed, std::uint64_t ticks, float& stage, float& water,
+                 float& nutrients) {
+    const SleepRates r = sleepRates(s, stage, dt, soilFed);
+    const auto k = static_cast<float>(ticks);
+    stage = std::min(stage + r.stage * k, s.maxStage);
+    water = std::clamp(water + r.water * k, 0.f, 1.f);
+    nutrients = std::clamp(nutrients + r.nutrients * k, 0.f, 1.f);
+}
+
+// Ticks a plant can sleep before its next event, counted from values that are still
+// linear: crossing into a new stage, the tick that would overshoot full size, and
+// without soil the first tick below the wilt or nutrient threshold
+std::uint64_t ticksUntilEvent(const PlantSpecies& s, float dt, bool soilFed, float stage, float water,
+                              float nutrients) {
+    double ticks = std::numeric_limits<double>::infinity();
+    const SleepRates r = sleepRates(s, stage, dt, soilFed);
+    if (r.stage > 0.f) {
+        const float next = std::floor(stage) + 1.f;
+        ticks = next < s.maxStage ? std::ceil((next - stage) / r.stage) : std::floor((s.maxStage - stage) / r.stage);
+    }
+    if (r.water < 0.f) ticks = std::min(ticks, std::floor((water - s.wiltThreshold) / -r.water) + 1.0);
+    if (r.nutrients < 0.f) ticks = std::min(ticks, std::floor((nutrients - s.nutrientThreshold) / -r.nutrients) + 1.0);
+    return ticks < 1e15 ? static_cast<std::uint64_t>(std::max(ticks, 0.0)) : kNever;
+}
+
+// Mean of a tile and its in-bounds 4-neighbours
+float neighbourhood(const SoilGrid& soil, const float* values, int t) {
+    const int x = t % soil.width(), y = t / soil.width();
+    float sum = std::max(values[t], 0.f);
+    int count = 1;
+    auto add = [&](int nx, int ny) {
+        if (nx < 0 || ny < 0 || nx >= soil.width() || ny >= soil.height()) return;
+        sum += std::max(values[soil.index(nx, ny)], 0.f);
+        ++count;
+    };
+    add(x - 1, y);
+    add(x + 1, y);
+    add(x, y - 1);
+    add(x, y + 1);
+    return sum / count;
+}
+
+constexpr int kSubSteps = 4;  // midpoint steps per water phase when fast-forwarding
+
+// Integrate one plant over [0, dt] given a constant net water drain (negative: refilling).
+void integratePlant(const PlantSpecies& s, float dt, float drain, float& water, float nf, float& health,
+                    float& stage) {
+    const float w0 = water;
+    auto wf = [&](float t) { return std::min(std::clamp(w0 - drain * t, 0.f, 1.f) / s.wiltThreshold, 1.f); };
+    auto dh = [&](float f) { return f >= 1.f ? s.recoverRate : -s.wiltDamage * (1.f - f); };
+
+    // split where water crosses the wilt threshold and zero: the rates are smooth in between
+    float cuts[3] = {dt, dt, dt};
+    if (drain != 0.f) {
+        cuts[0] = std::clamp((w0 - s.wiltThreshold) / drain, 0.f, dt);
+        cuts[1] = std::clamp(w0 / drain, 0.f, dt);
+    }
+
+    float t0 = 0.f;
+    for (float t1 : cuts) {
+        if (t1 <= t0) continue;
+        const float step = (t1 - t0) / kSubSteps;
+        for (int k = 0; k < kSubSteps; ++k) {
+            const float a = t0 + k * step;
+            const float hm = std::clamp(health + dh(wf(a)) * step * 0.5f, 0.f, 1.f);
+            const float fm = wf(a + step * 0.5f);
+            stage += s.growthRate * fm * nf * hm * step;
+            health = std::clamp(health + dh(fm) * step, 0.f, 1.f);
+        }
+        t0 = t1;
+    }
+
+    stage = std::min(stage, s.maxStage);
+    water = std::clamp(w0 - drain * dt, 0.f, 1.f);
+}
+}  // namespace
+
+// ----------------------------- plants --------------------------------
+
+std::uint16_t PlantSim::addSpecies(const PlantSpecies& species) {
+    speciesTable.push_back(species);
+    pools.emplace_back();
+    return static_cast<std::uint16_t>(speciesTable.size() - 1);
+}
+
+PlantId PlantSim::add(std::uint16_t species, float water, float nutrients, std::uint32_t tile) {
+    std::uint32_t slotIndex;
+    if (!freeSlots.empty()) {
+        slotIndex = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slotIndex = static_cast<std::uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+
+    Pool& p = pools[species];
+    Slot& slot = slots[slotIndex];
+    slot.species = species;
+    slot.index = static_cast<std::uint32_t>(p.size());
+    slot.used = true;
+
+    p.stage.push_back(0.f);
+    p.water.push_back(water);
+    p.nutrients.push_back(nutrients);
+    p.health.push_back(1.f);
+    p.tile.push_back(tile);
+    p.owner.push_back(slotIndex);
+    p.sleptAt.push_back(0);
+    p.wakeAt.push_back(kNever);
+
+    // new plants start awake
+    swapPlants(p, p.size() - 1, p.awake);
+    ++p.awake;
+
+    ++liveCount;
+    return {slotIndex, slot.generation};
+}
+
+void PlantSim::remove(PlantId id) {
+    if (!alive(id)) return;
+
+    wakeSlot(id.index);
+    Slot& slot = slots[id.index];
+    Pool& p = pools[slot.species];
+
+    // swap-remove keeps the pool dense: to the end of the awake range, then to the end
+    swapPlants(p, static_cast<int>(slot.index), p.awake - 1);
+    --p.awake;
+    swapPlants(p, static_cast<int>(slot.index), p.size() - 1);
+    p.stage.pop_back();
+    p.water.pop_back();
+    p.nutrients.pop_back();
+    p.health.pop_back();
+    p.tile.pop_back();
+    p.owner.pop_back();
+    p.sleptAt.pop_back();
+    p.wakeAt.pop_back();
+
+    slot.used = false;
+    ++slot.generation;
+    freeSlots.push_back(id.index);
+    --liveCount;
+}
+
+void PlantSim::clear() {
+    for (Pool& p : pools) p = {};
+    slots.clear();
+    freeSlots.clear();
+    liveCount = 0;
+    wheel.clear();
+    draw = {};
+    soilFed = false;
+}
+
+bool PlantSim::alive(PlantId id) const {
+    return id.index < slots.size() && slots[id.index].used && slots[id.index].generation == id.generation;
+}
+
+PlantState PlantSim::get(PlantId id) const {
+    if (!alive(id)) return {};
+    const Slot& slot = slots[id.index];
+    return stateAt(slot.species, static_cast<int>(slot.index));
+}
+
+PlantState PlantSim::stateAt(std::uint16_t species, int i) const {
+    const Pool& p = pools[species];
+    PlantState state{species, p.stage[i], p.water[i], p.nutrients[i], p.health[i]};
+    if (i >= p.awake)
+        extrapolate(speciesTable[species], tickDt, soilFed, now - p.sleptAt[i], state.stage, state.water,
+                    state.nutrients);
+    return state;
+}
+
+int PlantSim::awakeCount() const {
+    int count = 0;
+    for (const Pool& p : pools) count += p.awake;
+    return count;
+}
+
+void PlantSim::addWater(PlantId id, float amount) {
+    if (!alive(id)) return;
+    wakeSlot(id.index);
+    const Slot& slot = slots[id.index];
+    float& w = pools[slot.species].water[slot.index];
+    w = std::min(w + amount, 1.f);
+}
+
+void PlantSim::addNutrients(PlantId id, float amount) {
+    if (!alive(id)) return;
+    wakeSlot(id.index);
+    const Slot& slot = slots[id.index];
+    float& n = pools[slot.species].nutrients[slot.index];
+    n = std::min(n + amount, 1.f);
+}
+
+void PlantSim::absorb(SoilGrid& soil, float dt) {
+    TRACE_SCOPE("plants absorb");
+    float* moisture = soil.moisture();
+    float* nitrogen = soil.nitrogen();
+
+    // scattered by tile, so several plants can share one; kept scalar and single-threaded
+    for (std::size_t s = 0; s < pools.size(); ++s)
+        absorbRange(pools[s], speciesTable[s], moisture, nitrogen, dt, 0, pools[s].size());
+}
+
+void PlantSim::tick(float dt) {
+    TRACE_SCOPE("plants tick");
+    for (std::size_t s = 0; s < pools.size(); ++s) {
+        Pool& p = pools[s];
+        const int done = tickRange<simd::Float>(p, speciesTable[s], dt, 0, p.size());
+        tickRange<simd::F1>(p, speciesTable[s], dt, done, p.size());
+    }
+}
+
+void PlantSim::tickScalar(float dt) {
+    for (std::size_t s = 0; s < pools.size(); ++s)
+        tickRange<simd::F1>(pools[s], speciesTable[s], dt, 0, pools[s].size());
+}
+
+// ----------------------------- scheduling ----------------------------
+
+void PlantSim::wakeDue(std::uint64_t tick) {
+    TRACE_SCOPE("plants wake");
+    now = tick;
+
+    // entries go stale when their plant woke early or was removed
+    wheel.advance(tick, [this](std::uint32_t slot, std::uint64_t due) {
+        if (slot >= slots.size() || !slots[slot].used) return;
+        const Pool& p = pools[slots[slot].species];
+        const int i = static_cast<int>(slots[slot].index);
+        if (i >= p.awake && p.wakeAt[i] == due) wake(slots[slot].species, i);
+    });
+
+    // the last soil tick found tiles too dry or poor to keep feeding their sleepers
+    if (draw.anyStarved) {
+        for (std::size_t s = 0; s < pools.size(); ++s) {
+            Pool& p = pools[s];
+            for (int i = p.awake; i < p.size(); ++i)
+                if (draw.starved[p.tile[i]]) wake(static_cast<std::uint16_t>(s), i);
+        }
+        std::ranges::fill(draw.starved, 0);
+        std::ranges::fill(draw.starvedRows, 0);
+        draw.anyStarved = false;
+    }
+}
+
+void PlantSim::update(SoilGrid* soil, float dt, std::uint64_t tick) {
+    TRACE_SCOPE("plants update");
+    const bool fed = soil && soil->size() > 0;
+    if (fed != soilFed || dt != tickDt || (fed && static_cast<int>(draw.moisture.size()) != soil->size())) {
+        // sleepers extrapolate with the old rules; start over
+        wakeAll();
+        soilFed = fed;
+        tickDt = dt;
+        draw = {};
+        if (fed) draw.resize(soil->size(), soil->height());
+    }
+
+    for (std::size_t s = 0; s < pools.size(); ++s) {
+        Pool& p = pools[s];
+        const PlantSpecies& sp = speciesTable[s];
+        if (fed) absorbRange(p, sp, soil->moisture(), soil->nitrogen(), dt, 0, p.awake);
+        const int done = tickRange<simd::Float>(p, sp, dt, 0, p.awake);
+        tickRange<simd::F1>(p, sp, dt, done, p.awake);
+    }
+    now = tick + 1;
+
+    for (std::size_t s = 0; s < pools.size(); ++s) {
+        const Pool& p = pools[s];
+        for (int i = p.awake - 1; i >= 0; --i) trySleep(static_cast<std::uint16_t>(s), i, soil);
+    }
+}
+
+void PlantSim::wakeAll() {
+    for (std::size_t s = 0; s < pools.size(); ++s) {
+        Pool& p = pools[s];
+        while (p.awake < p.size()) wake(static_cast<std::uint16_t>(s), p.awake);
+    }
+    wheel.clear();
+}
+
+bool PlantSim::trySleep(std::uint16_t species, int i, const SoilGrid* soil) {
+    Pool& p = pools[species];
+    const PlantSpecies& sp = speciesTable[species];
+    if (p.health[i] < 1.f) return false;
+
+    const bool growing = p.stage[i] < sp.maxStage;
+    const float growth = growing ? sp.growthRate * tickDt : 0.f;
+    if (soilFed) {
+        // topped up by absorb, and the tile can keep it up alongside its other sleepers
+        const std::uint32_t t = p.tile[i];
+        if (p.water[i] < 1.f - sp.waterUse * tickDt - kTopUpSlack) return false;
+        if (p.nutrients[i] < 1.f - sp.nutrientUse * growth - kTopUpSlack) return false;
+        if (soil->field(SoilGrid::Field::Moisture)[t] < draw.moistureFloor[t] + sp.waterUse / sp.uptakeRate)
+            return false;
+        if (growing && soil->field(SoilGrid::Field::Nitrogen)[t] <
+                           draw.nitrogenFloor[t] + sp.nutrientUse * sp.growthRate / (sp.uptakeRate * 0.1f))
+            return false;
+    } else if (p.water[i] < sp.wiltThreshold || (growing && p.nutrients[i] < sp.nutrientThreshold)) {
+        return false;
+    }
+
+    // not worth it for an event next tick
+    const std::uint64_t ticks = ticksUntilEvent(sp, tickDt, soilFed, p.stage[i], p.water[i], p.nutrients[i]);
+    if (ticks < 2) return false;
+
+    swapPlants(p, i, p.awake - 1);
+    const int j = --p.awake;
+    p.sleptAt[j] = now;
+    p.wakeAt[j] = ticks == kNever ? kNever : now + ticks;
+    if (p.wakeAt[j] != kNever) wheel.schedule(p.owner[j], p.wakeAt[j]);
+    if (soilFed) addDraw(sp, p.tile[j], growing, 1.f);
+    return true;
+}
+
+void PlantSim::wake(std::uint16_t species, int i) {
+    Pool& p = pools[species];
+    const PlantSpecies& sp = speciesTable[species];
+    if (soilFed) addDraw(sp, p.tile[i], p.stage[i] < sp.maxStage, -1.f);
+    extrapolate(sp, tickDt, soilFed, now - p.sleptAt[i], p.stage[i], p.water[i], p.nutrients[i]);
+    p.wakeAt[i] = kNever;
+    swapPlants(p, i, p.awake);
+    ++p.awake;
+}
+
+void PlantSim::resetSchedule() {
+    for (Pool& p : pools) {
+        p.sleptAt.assign(p.size(), 0);
+        p.wakeAt.assign(p.size(), kNever);
+        p.awake = p.size();
+    }
+    wheel.clear();
+    draw = {};
+    soilFed = false;
+}
+
+void PlantSim::wakeSlot(std::uint32_t slot) {
+    const Slot& s = slots[slot];
+    if (static_cast<int>(s.index) >= pools[s.species].awake) wake(s.species, static_cast<int>(s.index));
+}
+
+void PlantSim::addDraw(const PlantSpecies& sp, std::uint32_t tile, bool growing, float sign) {
+    draw.moisture[tile] += sign * sp.waterUse;
+    draw.moistureFloor[tile] += sign * sp.waterUse / sp.uptakeRate;
+    if (growing) {
+        draw.nitrogen[tile] += sign * sp.nutrientUse * sp.growthRate;
+        draw.nitrogenFloor[tile] += sign * sp.nutrientUse * sp.growthRate / (sp.uptakeRate * 0.1f);
+    }
+    draw.sleepers[tile] += sign > 0.f ? 1 : -1;
+
+    // reset rather than let float sums drift once the tile has no sleepers
+    if (draw.sleepers[tile] == 0) {
+        draw.moisture[tile] = draw.nitrogen[tile] = 0.f;
+        draw.moistureFloor[tile] = draw.nitrogenFloor[tile] = 0.f;
+    }
+}
+
+void PlantSim::swapPlants(Pool& p, int a, int b) {
+    if (a == b) return;
+    std::swap(p.stage[a], p.stage[b]);
+    std::swap(p.water[a], p.water[b]);
+    std::swap(p.nutrients[a], p.nutrients[b]);
+    std::swap(p.health[a], p.health[b]);
+    std::swap(p.tile[a], p.tile[b]);
+    std::swap(p.owner[a], p.owner[b]);
+    std::swap(p.sleptAt[a], p.sleptAt[b]);
+    std::swap(p.wakeAt[a], p.wakeAt[b]);
+    slots[p.owner[a]].index = static_cast<std::uint32_t>(a);
+    slots[p.owner[b]].index = static_cast<std::uint32_t>(b);
+}
+
+// ----------------------------- catch-up ------------------------------
+
+float* PlantSim::drawCatchUp(SoilGrid& soil, float dt) {
+    float* moisture = soil.moisture();
+    float* nitrogen = soil.nitrogen();
+    demands.resize(pools.size());
+    tileWater.assign(soil.size(), 0.f);
+
+    for (std::size_t s = 0; s < pools.size(); ++s) {
+        const PlantSpecies& sp = speciesTable[s];
+        const Pool& p = pools[s];
+        Demand& d = demands[s];
+        d.water.resize(p.size());
+        d.nitrogen.resize(p.size());
+
+        // uptake is proportional to how wet the soil is, which caps the draw from dry soil
+        // (judged around the tile: the last step may have emptied the tile itself);
+        // nitrogen uptake is slow, so its draw stays within the tile's current stock
+        const float nitrogenShare = 1.f - std::exp(-sp.uptakeRate * 0.1f * dt);
+        for (int i = 0; i < p.size(); ++i) {
+            const std::uint32_t t = p.tile[i];
+            d.water[i] = std::min(sp.waterUse * dt + (1.f - p.water[i]),
+                                  sp.uptakeRate * dt * neighbourhood(soil, moisture, static_cast<int>(t)));
+            d.nitrogen[i] = std::min(std::max(nitrogen[t], 0.f) * nitrogenShare,
+                                     1.f - p.nutrients[i] + sp.nutrientUse * sp.growthRate * dt);
+            nitrogen[t] -= d.nitrogen[i];
+            tileWater[t] += d.water[i];
+        }
+    }
+    return tileWater.data();
+}
+
+void PlantSim::fastForward(SoilGrid* soil, float dt) {
+    if (dt <= 0.f) return;
+    TRACE_SCOPE("plants fast-forward");
+
+    float* moisture = soil ? soil->moisture() : nullptr;
+    float* nitrogen = soil ? soil->nitrogen() : nullptr;
+
+    // Tiles left below zero gave water they didn't have. Diffusion is linear and the soil
+    // spread the draw the same way as the water, so a tile's debt over its spread draw is
+    // the share it couldn't cover; pulling that back through the transposed diffusion
+    // gives the uncovered share of each drawing tile. tileWater becomes that share.
+    if (moisture) {
+        for (int t = 0; t < soil->size(); ++t) {
+            const bool owed = moisture[t] < 0.f && tileWater[t] > 0.f;
+            tileWater[t] = owed ? std::min(-moisture[t] / tileWater[t], 1.f) : 0.f;
+            moisture[t] = std::max(moisture[t], 0.f);
+            nitrogen[t] = std::max(nitrogen[t], 0.f);
+        }
+        soil->diffuseLikeMoisture(tileWater.data(), dt, true);
+    }
+
+    for (std::size_t s = 0; s < pools.size(); ++s) {
+        const PlantSpecies& sp = speciesTable[s];
+        Pool& p = pools[s];
+
+        for (int i = 0; i < p.size(); ++i) {
+            float w = p.water[i], h = p.health[i], st = p.stage[i];
+            const float n = p.nutrients[i];
+            const float st0 = st;
+
+            float supply = 0.f, nitrogenSupply = 0.f;
+            if (moisture) {
+                supply = demands[s].water[i] * std::clamp(1.f - tileWater[p.tile[i]], 0.f, 1.f);
+                nitrogenSupply = demands[s].nitrogen[i];
+            }
+
+            // nutrients change slowly: hold their factor for the step
+            const float nf = std::min(n / sp.nutrientThreshold, 1.f);
+            integratePlant(sp, dt, sp.waterUse - supply / dt, w, nf, h, st);
+
+            p.water[i] = w;
+            p.nutrients[i] = std::clamp(n + nitrogenSupply - sp.nutrientUse * (st - st0), 0.f, 1.f);
+            p.health[i] = h;
+            p.stage[i] = st;
+        }
+    }
+}
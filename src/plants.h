@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "soil.h"
+#include "timing_wheel.h"
+
+// Growth rules shared by every plant of a species
+struct PlantSpecies {
+    const char* name = "plant";
+    float growthRate = 0.05f;         // stages per second with ideal water/nutrients
+    float maxStage = 4.f;             // fully grown
+    float waterUse = 0.01f;           // water per second
+    float nutrientUse = 0.05f;        // nutrients per stage grown
+    float wiltThreshold = 0.3f;       // water below this slows growth and hurts health
+    float nutrientThreshold = 0.25f;  // nutrients below this slow growth
+    float wiltDamage = 0.05f;         // health per second with no water at all
+    float recoverRate = 0.02f;        // health per second while watered
+    float uptakeRate = 0.5f;          // share of its tile's moisture/nitrogen drawn per second
+};
+
+struct PlantId {
+    std::uint32_t index = ~0u;
+    std::uint32_t generation = 0;
+    bool valid() const { return index != ~0u; }
+};
+
+struct PlantState {
+    std::uint16_t species = 0;
+    float stage = 0.f;
+    float water = 0.f;
+    float nutrients = 0.f;
+    float health = 0.f;
+};
+
+// Crop simulation. Plants are stored structure-of-arrays in one pool per species, so
+// a tick streams over contiguous floats with the species' rules held in registers.
+//
+// Most plants spend most of their time in a steady state: topped up from the soil,
+// fully healthy, growing at a constant rate. Those are put to sleep. A sleeping plant's
+// state is a linear function of the ticks since it slept, its soil draw is applied by
+// the soil tick, and a timing wheel wakes it for the next event it can't extrapolate
+// past (a new growth stage, reaching full size, wilting or running short of nutrients
+// without soil). Tiles that can no longer feed their sleepers wake them too.
+class PlantSim {
+   public:
+    // One species' plants; index i across all arrays is one plant. Plants [0, awake)
+    // are active, the rest asleep.
+    struct Pool {
+        std::vector<float> stage;
+        std::vector<float> water;
+        std::vector<float> nutrients;
+        std::vector<float> health;
+        std::vector<std::uint32_t> tile;      // soil tile the roots sit in
+        std::vector<std::uint32_t> owner;     // slot index, for swap-remove fixups
+        std::vector<std::uint64_t> sleptAt;   // tick a sleeping plant's values were stored at
+        std::vector<std::uint64_t> wakeAt;    // its scheduled wake-up
+        int awake = 0;
+        int size() const { return static_cast<int>(stage.size()); }
+    };
+
+    std::uint16_t addSpecies(const PlantSpecies& species);
+    const PlantSpecies& species(std::uint16_t id) const { return speciesTable[id]; }
+    int speciesCount() const { return static_cast<int>(speciesTable.size()); }
+    const Pool& pool(std::uint16_t species) const { return pools[species]; }
+
+    PlantId add(std::uint16_t species, float water = 1.f, float nutrients = 1.f, std::uint32_t tile = 0);
+    void remove(PlantId id);
+    void clear();
+    bool alive(PlantId id) const;
+    int size() const { return liveCount; }
+    int awakeCount() const;
+
+    PlantState get(PlantId id) const;
+    // Pool entry i's values, with a sleeping plant's extrapolated
+    PlantState stateAt(std::uint16_t species, int i) const;
+    void addWater(PlantId id, float amount);
+    void addNutrients(PlantId id, float amount);
+
+    // Scheduled stepping, one fixed tick of dt at a time: wakeDue before the soil tick
+    // (which applies soilDraw), then update to absorb, tick and put steady plants to sleep
+    void wakeDue(std::uint64_t tick);
+    void update(SoilGrid* soil, float dt, std::uint64_t tick);
+    SoilDraw& soilDraw() { return draw; }
+    void wakeAll();
+
+    // Unscheduled passes over every plant, for benchmarks and tools; don't mix with
+    // update() while plants are asleep.
+    // Draw water and nitrogen from each plant's soil tile into the plant
+    void absorb(SoilGrid& soil, float dt);
+    // Advance every plant by dt using the widest SIMD path compiled in
+    void tick(float dt);
+    // Reference implementation (validation and benchmarks)
+    void tickScalar(float dt);
+
+    // Offline catch-up, one coarse step of any length, in two halves around
+    // SoilGrid::fastForward: drawCatchUp works out each plant's demand for the step and
+    // returns the per-tile water draw to hand to the soil; fastForward then takes back
+    // what the soil couldn't cover and integrates the plants. Water follows its
+    // piecewise-linear path exactly; health and growth use midpoint sub-steps inside each
+    // water phase. Pass a null soil for a garden without one. Call wakeAll first.
+    float* drawCatchUp(SoilGrid& soil, float dt);
+    void fastForward(SoilGrid* soil, float dt);
+
+   private:
+    friend class SaveGame;
+
+    void swapPlants(Pool& p, int a, int b);
+    bool trySleep(std::uint16_t species, int i, const SoilGrid* soil);
+    void wake(std::uint16_t species, int i);
+    void wakeSlot(std::uint32_t slot);
+    void addDraw(const PlantSpecies& sp, std::uint32_t tile, bool growing, float sign);
+    // After pools and slots were filled in directly: every plant awake, nothing scheduled
+    void resetSchedule();
+
+    struct Slot {
+        std::uint16_t species = 0;
+        std::uint32_t index = 0;  // into the species pool
+        std::uint32_t generation = 0;
+        bool used = false;
+    };
+
+    std::vector<PlantSpecies> speciesTable;
+    std::vector<Pool> pools;
+    std::vector<Slot> slots;
+    std::vector<std::uint32_t> freeSlots;
+    int liveCount = 0;
+
+    // scheduling
+    TimingWheel wheel;
+    SoilDraw draw;
+    std::uint64_t now = 0;    // ticks completed
+    float tickDt = 0.1f;      // length of the ticks sleepers extrapolate over
+    bool soilFed = false;     // sleepers draw from soil (else their water drains)
+
+    // catch-up scratch: per-plant demand (parallel to pools) and per-tile water draw
+    struct Demand {
+        std::vector<float> water;
+        std::vector<float> nitrogen;
+    };
+    std::vector<Demand> demands;
+    std::vector<float> tileWater;
+};
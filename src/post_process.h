@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "util.h"
+
+enum class PostEffect : std::uint8_t {
+    Bloom,       // bright areas bleed light into their surroundings
+    ColorGrade,  // exposure, contrast, saturation, tint
+    Vignette,    // darkens toward the corners
+};
+
+// How the world layer reaches the window (Renderer::postSettings). With an empty chain
+// and full resolution the world draws straight into the window at no extra cost;
+// otherwise it draws into an offscreen target, each effect in turn runs as a fullscreen
+// pass, and the last one writes (and upscales) into the window, under the UI.
+struct PostSettings {
+    std::vector<PostEffect> chain = {};  // applied in this order
+    float resolutionScale = 1.f;         // world resolution relative to the window, 0.25-1
+
+    float exposure = 1.f;
+    float contrast = 1.f;
+    float saturation = 1.f;
+    Color tint = {1.f, 1.f, 1.f, 1.f};
+
+    float bloomThreshold = 0.75f;  // luminance where pixels start to glow
+    float bloomIntensity = 0.6f;
+
+    float vignetteStrength = 0.35f;
+    float vignetteRadius = 0.75f;  // from the center, 1 = the corners
+
+    bool active() const { return !chain.empty() || resolutionScale < 1.f; }
+};
@@ -0,0 +1,241 @@
+#include "profiler.h"
+
+#include <glad/gl.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include "imgui.h"
+
+// ----------------------------- utils ---------------------------------
+
+namespace {
+// nearest-rank percentile on an already partially sorted range
+float percentile(float* values, int count, double p) {
+    if (count <= 0) return 0.f;
+    int rank = static_cast<int>(std::ceil(p * count)) - 1;
+    rank = std::clamp(rank, 0, count - 1);
+    std::nth_element(values, values + rank, values + count);
+    return values[rank];
+}
+
+// stable per-name colour so a scope keeps its colour between frames
+ImU32 scopeColor(const char* name) {
+    unsigned int h = 2166136261u;
+    for (const char* c = name; *c; ++c) h = (h ^ static_cast<unsigned char>(*c)) * 16777619u;
+    const int r = 90 + static_cast<int>(h & 0x7f);
+    const int g = 90 + static_cast<int>((h >> 8) & 0x7f);
+    const int b = 90 + static_cast<int>((h >> 16) & 0x7f);
+    return IM_COL32(r, g, b, 255);
+}
+}  // namespace
+
+// ----------------------------- gpu -----------------------------------
+
+void Profiler::initGpu() {
+    if (gpuReady) return;
+    for (auto& slot : queries) glGenQueries(kMaxGpuScopes, slot.data());
+    gpuReady = true;
+}
+
+void Profiler::shutdownGpu() {
+    if (!gpuReady) return;
+    for (auto& slot : queries) glDeleteQueries(kMaxGpuScopes, slot.data());
+    gpuReady = false;
+}
+
+void Profiler::beginGpuScope(const char* name) {
+    if (!gpuReady || !inFrame) return;
+    if (gpuDepth++ > 0) return;  // nested: fold into the outer query
+
+    const int slot = static_cast<int>(frameIndex % kGpuLatency);
+    GpuFrame& f = gpuFrames[slot];
+    if (f.count >= kMaxGpuScopes) return;
+
+    glBeginQuery(GL_TIME_ELAPSED, queries[slot][f.count]);
+    f.names[f.count++] = name;
+    gpuActive = true;
+}
+
+void Profiler::endGpuScope() {
+    if (gpuDepth == 0 || --gpuDepth > 0) return;
+    if (gpuActive) {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuActive = false;
+    }
+}
+
+void Profiler::collectGpu(int slot) {
+    GpuFrame& f = gpuFrames[slot];
+    if (f.count == 0) return;
+
+    // only publish a frame once every query in it has landed (never stall)
+    for (int i = 0; i < f.count; ++i) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot][i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) return;
+    }
+
+    for (int i = 0; i < f.count; ++i) {
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[slot][i], GL_QUERY_RESULT, &ns);
+        gpuResults[i] = {f.names[i], static_cast<double>(ns) / 1.0e6};
+    }
+    gpuResultCount = f.count;
+}
+
+// ----------------------------- frame ---------------------------------
+
+void Profiler::beginFrame() {
+    if (inFrame) endFrame();
+
+    frameStart = Clock::now();
+    inFrame = true;
+    current.count = 0;
+    stackSize = 0;
+
+    // the slot we're about to reuse was issued kGpuLatency frames ago
+    const int slot = static_cast<int>(frameIndex % kGpuLatency);
+    if (gpuReady) collectGpu(slot);
+    gpuFrames[slot].count = 0;
+    gpuDepth = 0;
+    gpuActive = false;
+}
+
+void Profiler::endFrame() {
+    if (!inFrame) return;
+
+    // close anything left open so the flame graph stays well-formed
+    const double now = sinceFrameStart();
+    while (stackSize > 0) current.scopes[stack[--stackSize]].endMs = now;
+    if (gpuActive) {
+        glEndQuery(GL_TIME_ELAPSED);
+        gpuActive = false;
+    }
+
+    current.frameMs = now;
+    if (!frozen) {
+        std::copy_n(current.scopes.begin(), current.count, last.scopes.begin());
+        last.count = current.count;
+        last.frameMs = current.frameMs;
+    }
+
+    history[historyHead] = static_cast<float>(now);
+    historyHead = (historyHead + 1) % kHistory;
+    historyCount = std::min(historyCount + 1, kHistory);
+
+    ++frameIndex;
+    inFrame = false;
+}
+
+int Profiler::beginScope(const char* name) {
+    if (!inFrame || current.count >= kMaxScopes || stackSize >= kMaxDepth) return -1;
+
+    const int index = current.count++;
+    const double t = sinceFrameStart();
+    current.scopes[index] = {name, t, t, stackSize};
+    stack[stackSize++] = index;
+    return index;
+}
+
+void Profiler::endScope(int index) {
+    if (index < 0 || !inFrame || stackSize == 0) return;
+
+    current.scopes[index].endMs = sinceFrameStart();
+    // pop through index in case an inner scope was never closed
+    while (stackSize > 0 && stack[--stackSize] != index) {
+    }
+}
+
+Profiler::FrameStats Profiler::frameStats() const {
+    std::array<float, kHistory> scratch;
+    std::copy_n(history.begin(), historyCount, scratch.begin());
+    return computeStats(scratch.data(), historyCount);
+}
+
+Profiler::FrameStats Profiler::computeStats(float* frameMs, int count) {
+    FrameStats s;
+    if (count <= 0) return s;
+
+    double sum = 0.0;
+    float maxMs = 0.f;
+    for (int i = 0; i < count; ++i) {
+        sum += frameMs[i];
+        maxMs = std::max(maxMs, frameMs[i]);
+    }
+
+    s.meanMs = sum / count;
+    s.maxMs = maxMs;
+    s.p50Ms = percentile(frameMs, count, 0.50);
+    s.p95Ms = percentile(frameMs, count, 0.95);
+    s.p99Ms = percentile(frameMs, count, 0.99);
+    return s;
+}
+
+// ----------------------------- ui ------------------------------------
+
+void Profiler::drawDebugUI() {
+    const FrameStats s = frameStats();
+    ImGui::Text("FPS: %.1f (mean)", s.meanMs > 0.0 ? 1000.0 / s.meanMs : 0.0);
+    ImGui::Text("frame: mean %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", s.meanMs, s.p50Ms, s.p95Ms,
+                s.p99Ms, s.maxMs);
+
+    // timeline of recent frame times (ring buffer, oldest first)
+    const int offset = historyCount == kHistory ? historyHead : 0;
+    ImGui::PlotLines("##frametimes", history.data(), historyCount, offset, "frame ms", 0.f,
+                     static_cast<float>(s.p99Ms * 1.5 + 1.0), ImVec2(0, 50));
+
+    // frame time histogram
+    constexpr int kBins = 32;
+    std::array<float, kBins> bins{};
+    const double range = std::max(s.maxMs, 1.0);
+    for (int i = 0; i < historyCount; ++i) {
+        const int b = std::min(kBins - 1, static_cast<int>(history[i] / range * kBins));
+        bins[b] += 1.f;
+    }
+    ImGui::PlotHistogram("##histogram", bins.data(), kBins, 0, "distribution", 0.f, 3.4e38f, ImVec2(0, 50));
+    ImGui::Text("0 ms .. %.1f ms", range);
+
+    ImGui::Separator();
+    ImGui::Checkbox("Freeze", &frozen);
+
+    // flame graph of the last completed frame
+    constexpr float kRowH = 18.f;
+    int maxDepth = 0;
+    for (int i = 0; i < last.count; ++i) maxDepth = std::max(maxDepth, last.scopes[i].depth);
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 100.f);
+    const float height = (maxDepth + 1) * kRowH;
+    const double scale = last.frameMs > 0.0 ? width / last.frameMs : 0.0;
+
+    ImDrawList* dl = ImGui::GetWindowDrawList();
+    dl->AddRectFilled(origin, ImVec2(origin.x + width, origin.y + height), IM_COL32(30, 30, 30, 255));
+
+    for (int i = 0; i < last.count; ++i) {
+        const Scope& sc = last.scopes[i];
+        const ImVec2 a(origin.x + static_cast<float>(sc.startMs * scale), origin.y + sc.depth * kRowH);
+        const ImVec2 b(origin.x + static_cast<float>(sc.endMs * scale), a.y + kRowH - 1.f);
+        if (b.x - a.x < 1.f) continue;
+
+        dl->AddRectFilled(a, b, scopeColor(sc.name));
+        dl->PushClipRect(a, b, true);
+        dl->AddText(ImVec2(a.x + 2.f, a.y + 2.f), IM_COL32(0, 0, 0, 255), sc.name);
+        dl->PopClipRect();
+
+        if (ImGui::IsMouseHoveringRect(a, b)) ImGui::SetTooltip("%s: %.3f ms", sc.name, sc.endMs - sc.startMs);
+    }
+    ImGui::Dummy(ImVec2(width, height));
+    ImGui::Text("CPU frame: %.3f ms", last.frameMs);
+
+    // gpu timings lag kGpuLatency frames behind
+    if (gpuResultCount > 0) {
+        ImGui::Separator();
+        double total = 0.0;
+        for (int i = 0; i < gpuResultCount; ++i) {
+            ImGui::Text("GPU %-12s %.3f ms", gpuResults[i].name, gpuResults[i].ms);
+            total += gpuResults[i].ms;
+        }
+        ImGui::Text("GPU total:        %.3f ms", total);
+    }
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "trace.h"
+
+// hierarchical frame profiler: RAII CPU scopes + GL_TIME_ELAPSED GPU scopes
+class Profiler {
+   public:
+    static constexpr int kMaxScopes = 256;    // CPU scopes per frame
+    static constexpr int kMaxDepth = 16;      // nesting limit
+    static constexpr int kMaxGpuScopes = 16;  // GPU scopes per frame
+    static constexpr int kGpuLatency = 4;     // frames before a query is read back
+    static constexpr int kHistory = 512;      // frame times kept for percentiles
+
+    struct Scope {
+        const char* name = nullptr;
+        double startMs = 0.0;  // relative to frame start
+        double endMs = 0.0;
+        int depth = 0;
+    };
+
+    struct GpuScope {
+        const char* name = nullptr;
+        double ms = 0.0;
+    };
+
+    struct FrameStats {
+        double meanMs = 0.0;
+        double p50Ms = 0.0;
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;
+    };
+
+    // Singleton access
+    static Profiler& instance() {
+        static Profiler inst;
+        return inst;
+    }
+
+    // Delete copy/move
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    Profiler(Profiler&&) = delete;
+    Profiler& operator=(Profiler&&) = delete;
+
+    // GL query objects (needs a current context)
+    void initGpu();
+    void shutdownGpu();
+
+    // Frame boundaries
+    void beginFrame();
+    void endFrame();
+
+    // CPU scopes (prefer ProfileScope / PROFILE_SCOPE)
+    int beginScope(const char* name);
+    void endScope(int index);
+
+    // GPU scopes may not nest (one GL_TIME_ELAPSED query active at a time)
+    void beginGpuScope(const char* name);
+    void endGpuScope();
+
+    // Results of the last completed frame
+    const Scope* scopes() const { return last.scopes.data(); }
+    int scopeCount() const { return last.count; }
+    double lastFrameMs() const { return last.frameMs; }
+    const GpuScope* gpuScopes() const { return gpuResults.data(); }
+    int gpuScopeCount() const { return gpuResultCount; }
+
+    // Frame time percentiles over the history window
+    FrameStats frameStats() const;
+
+    // Same statistics over arbitrary samples (reorders frameMs in place)
+    static FrameStats computeStats(float* frameMs, int count);
+
+    // ImGui panel (call between ImGui::Begin/End)
+    void drawDebugUI();
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct FrameData {
+        std::array<Scope, kMaxScopes> scopes{};
+        int count = 0;
+        double frameMs = 0.0;
+    };
+
+    struct GpuFrame {
+        std::array<const char*, kMaxGpuScopes> names{};
+        int count = 0;
+    };
+
+    Profiler() = default;
+    ~Profiler() = default;
+
+    double sinceFrameStart() const {
+        return std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+    }
+
+    Clock::time_point frameStart{};
+    bool inFrame = false;
+    bool frozen = false;  // keep showing the same frame in the flame graph
+
+    FrameData current;
+    FrameData last;
+    std::array<int, kMaxDepth> stack{};
+    int stackSize = 0;
+
+    // GPU query ring: kGpuLatency frames of kMaxGpuScopes queries each
+    std::array<std::array<unsigned int, kMaxGpuScopes>, kGpuLatency> queries{};
+    std::array<GpuFrame, kGpuLatency> gpuFrames{};
+    std::array<GpuScope, kMaxGpuScopes> gpuResults{};
+    int gpuResultCount = 0;
+    bool gpuReady = false;
+    bool gpuActive = false;
+    int gpuDepth = 0;
+    std::uint64_t frameIndex = 0;
+
+    // frame time history (ring)
+    std::array<float, kHistory> history{};
+    int historyHead = 0;
+    int historyCount = 0;
+
+    void collectGpu(int slot);
+};
+
+// RAII CPU scope marker
+class ProfileScope {
+   public:
+    explicit ProfileScope(const char* name) : index(Profiler::instance().beginScope(name)) {}
+    ~ProfileScope() { Profiler::instance().endScope(index); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+   private:
+    int index;
+};
+
+// RAII GPU scope marker
+class GpuProfileScope {
+   public:
+    explicit GpuProfileScope(const char* name) { Profiler::instance().beginGpuScope(name); }
+    ~GpuProfileScope() { Profiler::instance().endGpuScope(); }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+// CPU scopes are also recorded into the Chrome trace when recording is on
+#define PROFILE_SCOPE(name)                                     \
+    ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name); \
+    TRACE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope_, __LINE__)(name)
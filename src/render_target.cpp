@@ -0,0 +1,79 @@
+#include "render_target.h"
+
+#include <algorithm>
+#include <print>
+
+bool RenderTarget::create(int w, int h) {
+    if (!color.create(w, h)) return false;
+    if (fbo == 0) glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color.id(), 0);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        std::println(stderr, "render target {}x{} incomplete: 0x{:x}", w, h, status);
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void RenderTarget::destroy() {
+    if (fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        fbo = 0;
+    }
+    color.destroy();
+}
+
+void RenderTarget::bind() {
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, color.width(), color.height());
+}
+
+void RenderTarget::bindDefault(int w, int h) {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, w, h);
+}
+
+RenderTarget* RenderTargetPool::acquire(int w, int h) {
+    for (const auto& e : entries) {
+        if (!e->inUse && e->target.width() == w && e->target.height() == h) {
+            e->inUse = true;
+            e->idleFrames = 0;
+            return &e->target;
+        }
+    }
+    Entry* e = slots.create();
+    if (!e->target.create(w, h)) {
+        slots.destroy(e);
+        return nullptr;
+    }
+    e->inUse = true;
+    ++createdCount;
+    entries.push_back(e);
+    return &e->target;
+}
+
+void RenderTargetPool::release(RenderTarget* target) {
+    for (const auto& e : entries)
+        if (&e->target == target) e->inUse = false;
+}
+
+void RenderTargetPool::beginFrame() {
+    for (Entry* e : entries) {
+        e->inUse = false;
+        ++e->idleFrames;
+    }
+    std::erase_if(entries, [this](Entry* e) {
+        if (e->idleFrames <= kMaxIdleFrames) return false;
+        slots.destroy(e);
+        return true;
+    });
+}
+
+void RenderTargetPool::clear() {
+    for (Entry* e : entries) slots.destroy(e);
+    entries.clear();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <glad/gl.h>
+
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+#include "texture.h"
+
+// An offscreen color buffer: draw into it, then sample its texture like any other
+// (fillTextureRect, sprites). Main thread only.
+class RenderTarget {
+   public:
+    RenderTarget() = default;
+    ~RenderTarget() { destroy(); }
+
+    // non-copyable, movable
+    RenderTarget(const RenderTarget&) = delete;
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    RenderTarget(RenderTarget&& other) noexcept { *this = std::move(other); }
+    RenderTarget& operator=(RenderTarget&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            fbo = std::exchange(other.fbo, 0);
+            color = std::move(other.color);
+        }
+        return *this;
+    }
+
+    // (Re)allocates at w x h; false if the driver rejects the framebuffer
+    bool create(int w, int h);
+    void destroy();
+
+    // Later draws land in this target, across its whole size
+    void bind();
+    // Back to the window, whose framebuffer is w x h pixels
+    static void bindDefault(int w, int h);
+
+    const Texture& texture() const { return color; }
+    Texture& texture() { return color; }
+    int width() const { return color.width(); }
+    int height() const { return color.height(); }
+    explicit operator bool() const { return fbo != 0; }
+
+   private:
+    GLuint fbo = 0;
+    Texture color;
+};
+
+// Targets for passes that only live within a frame (post effects, the light buffer):
+// acquire hands out a free target of the size asked for, creating one only when none
+// is free, and release returns it for the next pass. A chain of passes thus ping-pongs
+// between a couple of targets; ones unused for kMaxIdleFrames are freed.
+class RenderTargetPool {
+   public:
+    static constexpr int kMaxIdleFrames = 120;
+
+    RenderTargetPool() = default;
+    ~RenderTargetPool() { clear(); }
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // nullptr if the target cannot be created
+    RenderTarget* acquire(int w, int h);
+    void release(RenderTarget* target);  // nullptr is ignored
+    // Everything is free again; frees the long unused
+    void beginFrame();
+    void clear();
+
+    int size() const { return static_cast<int>(entries.size()); }
+    int created() const { return createdCount; }  // since startup, for spotting churn
+
+   private:
+    struct Entry {
+        RenderTarget target;
+        bool inUse = false;
+        int idleFrames = 0;
+    };
+    // entries live in slots so handed-out targets keep their address, and a target
+    // freed after a resize leaves its slot to the next one instead of the heap
+    ObjectPool<Entry, 16> slots;
+    std::vector<Entry*> entries;
+    int createdCount = 0;
+};
@@ -4,16 +4,36 @@
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
+#include <format>
 #include <print>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "alloc_tracker.h"
+#include "animation.h"
 #include "backends/imgui_impl_glfw.h"
 #include "backends/imgui_impl_opengl3.h"
+#include "cached_layer.h"
+#include "font.h"
+#include "garden.h"
 #include "imgui.h"
+#include "input.h"
+#include "lighting.h"
+#include "particles.h"
+#include "profiler.h"
+#include "replay.h"
+#include "save.h"
 #include "scene.h"
 #include "shader.h"
+#include "trace.h"
+#include "ui.h"
 #include "util.h"
 
 // ----------------------------- utils ---------------------------------
@@ -23,44 +43,490 @@ void framebuffer_size_callback(GLFWwindow*, int w, int h) {
     glViewport(0, 0, w, h);
 }
 
-// simple, frame-rate independent EMA FPS smoother
-struct FpsSmoother {
-    double tau = 0.3;    // seconds
-    double value = 0.0;  // smoothed fps
-    void push(double dt, double fpsInstant) {
-        const double a = 1.0 - std::exp(-dt / tau);
-        value += a * (fpsInstant - value);
+std::int64_t unixNow() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+// Crop sway flipbooks, one texture array layer per species: 8 frames of a stem with two
+// leaves leaning from left to right, plus the species' own colors (a carrot's orange
+// shoulder, a tomato's fruit). Shaded per plant by health when drawn. Generated rather
+// than shipped as images.
+constexpr FlipbookAtlas kPlantAtlas{4, 2};
+constexpr int kPlantFrameW = 16;
+constexpr int kPlantFrameH = 32;
+enum PlantLook { kCarrotLook, kTomatoLook, kPlantLooks };
+using Rgb = std::array<std::uint8_t, 3>;
+
+std::vector<std::uint8_t> makePlantAtlas(PlantLook look) {
+    const int w = kPlantAtlas.columns * kPlantFrameW;
+    const int h = kPlantAtlas.rows * kPlantFrameH;
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(w) * h * 4);
+    auto set = [&](int frame, int x, int y, Rgb rgb) {
+        if (x < 0 || x >= kPlantFrameW || y < 0 || y >= kPlantFrameH) return;
+        // atlas rows count from the image top, but these pixels upload unflipped (v up)
+        const int px = frame % kPlantAtlas.columns * kPlantFrameW + x;
+        const int py = h - 1 - (frame / kPlantAtlas.columns * kPlantFrameH + y);
+        std::uint8_t* p = &pixels[(static_cast<std::size_t>(py) * w + px) * 4];
+        p[0] = rgb[0];
+        p[1] = rgb[1];
+        p[2] = rgb[2];
+        p[3] = 255;
+    };
+    auto blob = [&](int frame, float cx, int cy, float rx, float ry, Rgb rgb) {
+        for (int y = cy - static_cast<int>(ry) - 1; y <= cy + static_cast<int>(ry) + 1; ++y)
+            for (int x = static_cast<int>(cx - rx) - 1; x <= static_cast<int>(cx + rx) + 1; ++x) {
+                const float dx = (static_cast<float>(x) - cx) / rx;
+                const float dy = static_cast<float>(y - cy) / ry;
+                if (dx * dx + dy * dy <= 1.f) set(frame, x, y, rgb);
+            }
+    };
+
+    const Rgb stem = look == kCarrotLook ? Rgb{90, 170, 60} : Rgb{60, 130, 45};
+    const Rgb leaf = look == kCarrotLook ? Rgb{130, 210, 90} : Rgb{80, 165, 60};
+    const Rgb fruit = look == kCarrotLook ? Rgb{235, 125, 35} : Rgb{215, 45, 30};
+    const int frames = kPlantAtlas.columns * kPlantAtlas.rows;
+    for (int f = 0; f < frames; ++f) {
+        const float lean = -1.f + 2.f * static_cast<float>(f) / static_cast<float>(frames - 1);
+        auto stemX = [&](int y) {
+            const float up = static_cast<float>(kPlantFrameH - 1 - y) / static_cast<float>(kPlantFrameH - 1);
+            return 7.5f + 5.f * lean * up * up;  // the base stays put, the tip swings
+        };
+        for (int y = 0; y < kPlantFrameH; ++y) {
+            const int x = static_cast<int>(std::lround(stemX(y)));
+            set(f, x - 1, y, stem);
+            set(f, x, y, stem);
+        }
+        for (const auto& [leafY, side] : {std::pair{18, -1}, std::pair{11, 1}})
+            blob(f, stemX(leafY) + 3.f * static_cast<float>(side), leafY, 3.5f, 1.6f, leaf);
+        if (look == kCarrotLook) {
+            blob(f, stemX(kPlantFrameH - 2), kPlantFrameH - 2, 2.5f, 1.5f, fruit);
+        } else {
+            blob(f, stemX(21) + 3.f, 21, 2.f, 2.f, fruit);
+            blob(f, stemX(8) - 2.f, 8, 1.6f, 1.6f, fruit);
+        }
     }
-};
+    return pixels;
+}
+
+#if ENABLE_ALLOC_TRACKING
+void* imguiAlloc(std::size_t size, void*) {
+    return HeapTracking::allocate(size, AllocTag::ImGui);
+}
+void imguiFree(void* p, void*) {
+    HeapTracking::release(p);
+}
+#endif
 }  // namespace
 
 // ----------------------------- sample scene ---------------------------
 
 class GameScene : public Scene {
    public:
-    void load() override {}
-    void unload() override {}
-    void update(float) override {}
+    void preload() override {
+        image.load("textures/texture_01.png");
+
+        // a small bed of mixed crops, two soil tiles apart
+        garden = {};
+        garden.soil.resize(kBedW * 2, kBedH * 2);
+        const auto carrot = garden.plants.addSpecies({.name = "carrot", .growthRate = 0.05f});
+        const auto tomato = garden.plants.addSpecies({.name = "tomato", .growthRate = 0.03f, .waterUse = 0.02f});
+        speciesLook[carrot] = kCarrotLook;
+        speciesLook[tomato] = kTomatoLook;
+        for (int i = 0; i < kBedW * kBedH; ++i) {
+            const auto tile = static_cast<std::uint32_t>(garden.soil.index((i % kBedW) * 2, (i / kBedW) * 2));
+            bed[i] = garden.plants.add(i % 3 ? carrot : tomato, 0.6f + 0.05f * (i % 8), 1.f, tile);
+        }
+
+        // every crop sways on the same clip, out of step with its neighbours
+        for (int look = 0; look < kPlantLooks; ++look) plantPixels[look] = makePlantAtlas(PlantLook(look));
+        font.build(FontMode::Sdf);
+        buildSeedBag();
+        animations = {};
+        const auto sway = animations.addClip({.name = "sway",
+                                              .frameCount = kPlantAtlas.columns * kPlantAtlas.rows,
+                                              .fps = 6.f,
+                                              .loop = LoopMode::PingPong});
+        for (int i = 0; i < kBedW * kBedH; ++i)
+            bedAnimation[i] = animations.add(sway, 0.8f + 0.05f * (i % 9), 0.37f * static_cast<float>(i));
+
+        // resume the last session (grown over the time away in load()); a replay brings
+        // its own starting state
+        if (!Replay::instance().playing()) saves.load(garden, kSavePath);
+
+        // weather and tool effects; purely visual, so not part of the replay
+        particles = {};
+        rainEmitter = particles.addEmitter(
+            {.type = particles.addType(particles::kRain), .area = {0, 600, 800, 0}, .velocity = {-20, -400},
+             .spread = {10, 50}});
+        particles.addEmitter({.type = particles.addType(particles::kPollen),
+                              .area = {200, 200, kBedW * 40.f, kBedH * 90.f},
+                              .velocity = {0, 6},
+                              .spread = {10, 10},
+                              .rate = 20});
+        particles.addEmitter({.type = particles.addType(particles::kLeaves), .area = {0, 600, 800, 0},
+                              .velocity = {10, -20}, .spread = {20, 10}, .rate = 2});
+        spray = particles.addType(particles::kSpray);
+    }
+    void load() override {
+        // on the main thread, so the catch-up's soil solve spreads over the workers
+        // (inside the preload job, parallelFor would run it serially)
+        if (!Replay::instance().playing()) garden.catchUpTo(unixNow());
+        Replay::instance().beginGarden(garden);
+
+        // freed with the scene's arena when it leaves the stack
+        texture = &resources().make<Texture>();
+        texture->upload(image);
+        image.reset();
+
+        heatmap = &resources().make<Texture>();
+        heatmap->create(garden.soil.width(), garden.soil.height());
+
+        plants = &resources().make<TextureArray>();
+        plants->create(kPlantAtlas.columns * kPlantFrameW, kPlantAtlas.rows * kPlantFrameH, kPlantLooks);
+        for (int look = 0; look < kPlantLooks; ++look) {
+            plants->setLayer(look, plantPixels[look].data());
+            plantPixels[look] = {};
+        }
+        font.upload();
+
+        // the ground layer holds the old background texture's pixels
+        ground.invalidate();
+        soilLevels.clear();
+    }
+    void unload() override {
+        texture = nullptr;
+        plants = nullptr;
+        heatmap = nullptr;
+        ground = {};
+        saves.wait();
+        if (!Replay::instance().playing()) save();
+        saves.wait();
+    }
+    void update(float dt) override {
+        {
+            ALLOC_TAG(Garden);
+            Replay::instance().updateGarden(garden, dt, commands);
+        }
+        particles.emitter(rainEmitter).rate = garden.soil.params.rainRate * 40000.f;
+        particles.update(dt);
+        animations.update(dt);
+
+        // a save still writing just pushes the autosave to the next frame; a replay
+        // must not overwrite the player's garden
+        if (Replay::instance().playing()) return;
+        autosaveTimer += dt;
+        if (autosaveTimer >= kAutosaveSeconds && save()) autosaveTimer = 0.f;
+    }
     void draw(Renderer& r) override {
         glClearColor(0.573f, 0.953f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        // background
-        r.useShader(r.textureShader);
-        r.setColor({1, 1, 1, 1});
-        r.fillTextureRect({0, 0, 800 * 2, 600 * 2}, texture);
+        // background, fence and soil: repainted only where a soil tile changed
+        invalidateSoil();
+        if (r.beginLayer(ground)) {
+            drawGround(r);
+            r.endLayer(ground);
+        }
+        r.drawLayer(ground);
 
         // foreground
         r.useShader(r.shapeShader);
         r.setColor({1, 0, 0, 1});
         r.fillRect({10, 12, 40, 300});
 
+        // crops: height from growth stage, browner as health drops; both species are layers
+        // of one texture array, so they share a batch. Standing on their row
+        for (int i = 0; i < kBedW * kBedH; ++i) {
+            const PlantState p = garden.plants.get(bed[i]);
+            const float h = cropHeight(p);
+            r.drawSprite(*plants, speciesLook[p.species], {200.f + (i % kBedW) * 40.f, cropBase(i) - h, 12.f, h},
+                         kPlantAtlas.frameUV(animations.frame(bedAnimation[i])),
+                         {1.f, 0.55f + 0.45f * p.health, 0.35f + 0.65f * p.health, 1});
+        }
+        r.flushSprites();
+
+        r.drawParticles(particles);
+        if (showLighting) drawLighting(r);
+        r.beginUiPass();
+        r.useShader(r.shapeShader);
+
+        drawSoilUI(r);
+        drawHud(r);
+        drawSeedBag(r);
+
         // reset
         r.setColor({1, 1, 1, 1});
     }
 
    private:
-    Texture texture = Texture("textures/texture_01.png");
+    static constexpr int kBedW = 12;
+    static constexpr int kBedH = 4;
+    static constexpr const char* kSavePath = "garden.sav";
+    static constexpr float kAutosaveSeconds = 30.f;
+
+    bool save() {
+        garden.lastWallClock = unixNow();
+        return saves.saveAsync(garden, kSavePath);
+    }
+
+    void drawSoilUI(Renderer& r) {
+        ImGui::Begin("Garden", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+        ImGui::Checkbox("Soil overlay", &showHeatmap);
+        ImGui::SameLine();
+        ImGui::Checkbox("Growth labels", &showLabels);
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Seed bag", &showSeedBag)) ui.setVisible(seedBag, showSeedBag);
+        static const char* const kFields[] = {"Moisture", "Nitrogen", "Temperature"};
+        ImGui::Combo("Field", &heatmapField, kFields, 3);
+        ImGui::Checkbox("Lighting", &showLighting);
+        ImGui::SameLine();
+        static const char* const kQualities[] = {"Full", "Half", "Quarter"};
+        static constexpr LightQuality kQualityValues[] = {LightQuality::Full, LightQuality::Half,
+                                                          LightQuality::Quarter};
+        if (ImGui::Combo("Light buffer", &lightQuality, kQualities, 3))
+            lighting.quality = kQualityValues[lightQuality];
+
+        // garden changes are queued as commands for the next update, so replays see them
+        using Type = GardenCommand::Type;
+        float rain = garden.soil.params.rainRate;
+        if (ImGui::SliderFloat("Rain", &rain, 0.f, 0.05f, "%.3f")) commands.push_back({Type::SetRain, {rain}});
+        if (ImGui::Button("Watering can")) {
+            commands.push_back({Type::WaterSoil, {static_cast<float>(kBedW), static_cast<float>(kBedH), 3.f, 0.5f}});
+            particles.burst(spray, {380, 520, 80, 10}, {0, -200}, {60, 40}, 400);
+        }
+        if (ImGui::Button("Skip 1 hour")) commands.push_back({Type::Skip, {3600.f}});
+        ImGui::SameLine();
+        if (ImGui::Button("Skip 1 day")) commands.push_back({Type::Skip, {86400.f}});
+        ImGui::Text("Day %d, %02d:%02d", static_cast<int>(garden.time / 86400.0) + 1,
+                    static_cast<int>(garden.time / 3600.0) % 24, static_cast<int>(garden.time / 60.0) % 60);
+        const int active = garden.plants.awakeCount();
+        ImGui::Text("Plants: %d active / %d dormant", active, garden.plants.size() - active);
+        ImGui::Text("Particles: %d", particles.size());
+        drawPostUI(r);
+        if (showLighting)
+            ImGui::Text("Lights: %d visible, up to %d per tile", lighting.visibleLights(),
+                        lighting.maxLightsPerTile());
+        if (ImGui::Button("Save now")) save();
+        const SaveGame::Stats& saved = saves.lastStats();
+        if (saves.busy()) {
+            ImGui::Text("Saving...");
+        } else if (saved.sectionCount > 0) {
+            const char* kind = !saved.ok ? "FAILED" : saved.delta ? "delta" : "full";
+            ImGui::Text("Last save: %s, %d/%d sections, %.1f KB, %.2f ms", kind, saved.sectionsWritten,
+                        saved.sectionCount, saved.bytesWritten / 1024.0, saved.ms);
+        }
+        ImGui::End();
+
+        if (!showHeatmap) return;
+
+        // streamed every frame through the regular textured-quad path
+        auto* pixels = r.frameArena().allocateArray<std::uint8_t>(static_cast<std::size_t>(garden.soil.size()) * 4);
+        garden.soil.writeHeatmap(static_cast<SoilGrid::Field>(heatmapField), pixels);
+        heatmap->update(pixels);
+        r.useShader(r.textureShader);
+        r.fillTextureRect({200.f, 200.f, kBedW * 40.f * 2.f, kBedH * 90.f * 2.f}, *heatmap);
+        r.useShader(r.shapeShader);
+    }
+
+    // clock in the corner, growth over each crop; text changes at most once a game
+    // minute, so it is nearly always a shaping cache hit
+    void drawHud(Renderer& r) {
+        char buf[32];
+        const auto clock =
+            std::format_to_n(buf, sizeof(buf), "Day {}  {:02}:{:02}", static_cast<int>(garden.time / 86400.0) + 1,
+                             static_cast<int>(garden.time / 3600.0) % 24, static_cast<int>(garden.time / 60.0) % 60);
+        r.drawText(font, {buf, clock.out}, {12, 12}, 16, {0.1f, 0.2f, 0.1f, 0.9f});
+
+        if (showLabels) {
+            for (int i = 0; i < kBedW * kBedH; ++i) {
+                const auto label = std::format_to_n(buf, sizeof(buf), "{}%",
+                                                    static_cast<int>(garden.plants.get(bed[i]).stage * 100.f));
+                r.drawText(font, {buf, label.out}, {200.f + (i % kBedW) * 40.f, 248.f + (i / kBedW) * 90.f}, 10,
+                           {1, 1, 1, 0.9f});
+            }
+        }
+        r.flushSprites();
+        r.useShader(r.shapeShader);
+    }
+
+    void drawPostUI(Renderer& r) {
+        // the chain is the state; anything else may have changed it since last frame
+        PostSettings& post = r.postSettings();
+        auto has = [&](PostEffect e) { return std::ranges::find(post.chain, e) != post.chain.end(); };
+        bool bloom = has(PostEffect::Bloom), grade = has(PostEffect::ColorGrade), vignette = has(PostEffect::Vignette);
+        bool changed = ImGui::Checkbox("Bloom", &bloom);
+        ImGui::SameLine();
+        changed |= ImGui::Checkbox("Color grade", &grade);
+        ImGui::SameLine();
+        changed |= ImGui::Checkbox("Vignette", &vignette);
+        if (changed) {
+            post.chain.clear();
+            if (bloom) post.chain.push_back(PostEffect::Bloom);
+            if (grade) post.chain.push_back(PostEffect::ColorGrade);
+            if (vignette) post.chain.push_back(PostEffect::Vignette);
+        }
+        if (grade) ImGui::SliderFloat("Saturation", &post.saturation, 0.f, 2.f, "%.2f");
+        ImGui::SliderFloat("World scale", &post.resolutionScale, 0.25f, 1.f, "%.2f");
+        ImGui::Text("Render targets: %d pooled, %d created", r.renderTargets().size(), r.renderTargets().created());
+    }
+
+    // Soil tiles show moisture in a few steps; a tile crossing one invalidates just
+    // its own rect of the ground layer
+    static constexpr int kSoilLevels = 4;
+    static constexpr Rect kBedArea = {200.f, 200.f, kBedW * 40.f, kBedH * 90.f};
+
+    // crops stand on their row and grow taller with their stage
+    static float cropBase(int i) { return 245.f + static_cast<float>(i / kBedW) * 90.f; }
+    static float cropHeight(const PlantState& p) { return 8.f + 24.f * p.stage; }
+
+    Rect soilTileRect(int x, int y) const {
+        const float w = kBedArea.w / static_cast<float>(garden.soil.width());
+        const float h = kBedArea.h / static_cast<float>(garden.soil.height());
+        return {kBedArea.x + static_cast<float>(x) * w, kBedArea.y + static_cast<float>(y) * h, w, h};
+    }
+
+    void invalidateSoil() {
+        const float* moisture = garden.soil.field(SoilGrid::Field::Moisture);
+        soilLevels.resize(garden.soil.size(), 0xff);
+        for (int y = 0; y < garden.soil.height(); ++y) {
+            for (int x = 0; x < garden.soil.width(); ++x) {
+                const int i = garden.soil.index(x, y);
+                const int step = static_cast<int>(moisture[i] * kSoilLevels);
+                const auto level = static_cast<std::uint8_t>(std::clamp(step, 0, kSoilLevels - 1));
+                if (level == soilLevels[i]) continue;
+                soilLevels[i] = level;
+                ground.invalidate(soilTileRect(x, y));
+            }
+        }
+    }
+
+    void drawGround(Renderer& r) {
+        r.useShader(r.textureShader);
+        r.fillTextureRect({0, 0, 800 * 2, 600 * 2}, *texture);
+
+        const Texture& white = r.whiteTexture();
+        for (int y = 0; y < garden.soil.height(); ++y) {
+            for (int x = 0; x < garden.soil.width(); ++x) {
+                const Rect t = soilTileRect(x, y);
+                if (!ground.needsRepaint(t)) continue;
+                const float wet = static_cast<float>(soilLevels[garden.soil.index(x, y)]) / (kSoilLevels - 1);
+                r.drawSprite(white, {t.x + 1.f, t.y + 1.f, t.w - 2.f, t.h - 2.f}, {0, 0, 1, 1},
+                             {0.55f - 0.3f * wet, 0.4f - 0.22f * wet, 0.25f - 0.12f * wet, 1.f});
+            }
+        }
+
+        // fence: posts every 40 px around the bed, joined by two rails
+        constexpr Color kWood{0.45f, 0.3f, 0.15f, 1.f};
+        const Rect fence{kBedArea.x - 12.f, kBedArea.y - 12.f, kBedArea.w + 24.f, kBedArea.h + 24.f};
+        const Rect rails[] = {{fence.x, fence.y, fence.w, 4.f},
+                              {fence.x, fence.y + fence.h - 4.f, fence.w, 4.f},
+                              {fence.x, fence.y, 4.f, fence.h},
+                              {fence.x + fence.w - 4.f, fence.y, 4.f, fence.h}};
+        for (const Rect& rail : rails)
+            if (ground.needsRepaint(rail))
+                r.drawSprite(white, rail, {0, 0, 1, 1}, kWood);
+        for (float x = fence.x; x <= fence.x + fence.w; x += 40.f)
+            for (const float y : {fence.y - 4.f, fence.y + fence.h - 8.f}) {
+                const Rect post{x - 3.f, y, 8.f, 12.f};
+                if (ground.needsRepaint(post)) r.drawSprite(white, post, {0, 0, 1, 1}, kWood);
+            }
+        r.flushSprites();
+    }
+
+    // Day / night: the sun tints everything; after dusk the lanterns come on and healthy
+    // crops glow faintly
+    void drawLighting(Renderer& r) {
+        const double timeOfDay = std::fmod(garden.time, 86400.0);
+        lighting.clear();
+        lighting.ambient = sunlight(timeOfDay);
+        const float night = std::clamp(0.5f - sunHeight(timeOfDay) / 0.3f, 0.f, 1.f);
+        if (night > 0.f) {
+            for (const Vec2 lantern : {Vec2{180, 200}, Vec2{700, 200}, Vec2{180, 560}, Vec2{700, 560}})
+                lighting.add({.pos = lantern, .radius = 220.f, .color = {1.f, 0.75f, 0.4f, 1.f}, .intensity = night});
+            for (int i = 0; i < kBedW * kBedH; ++i) {
+                const PlantState p = garden.plants.get(bed[i]);
+                const Vec2 pos{206.f + (i % kBedW) * 40.f, cropBase(i) - 0.5f * cropHeight(p)};
+                lighting.add({.pos = pos, .radius = 28.f + 24.f * p.stage, .color = {0.4f, 1.f, 0.5f, 1.f},
+                              .intensity = 0.5f * night * p.health});
+            }
+        }
+        r.drawLights(lighting);
+    }
+
+    // Seed inventory in the retained UI: built once, then only the slots the pointer
+    // touches (and the selection) are rebuilt
+    static constexpr const char* kSeeds[] = {"carrot", "tomato", "lettuce", "radish", "pea", "bean",
+                                             "onion",  "beet",   "squash",  "kale",   "leek", "chard"};
+    static constexpr int kSeedCount = sizeof(kSeeds) / sizeof(kSeeds[0]);
+
+    void buildSeedBag() {
+        ui = UiTree(font);
+        seedBag = ui.addPanel(ui.root(), {560, 330, 228, 190});
+        ui.addLabel(seedBag, {8, 8}, "Seeds");
+        selectedLabel = ui.addLabel(seedBag, {70, 8}, "");
+        const UiId grid = ui.addGrid(seedBag, {8, 28, 212, 154}, 4, {48, 48}, 4);
+        for (int i = 0; i < kSeedCount; ++i) {
+            char buf[8];
+            const auto count = std::format_to_n(buf, sizeof(buf), "{}", 5 + 3 * i);
+            seedSlots[i] = ui.addButton(grid, {0, 0, 0, 0}, {buf, count.out});
+            ui.addTooltip(seedSlots[i], kSeeds[i]);
+        }
+        selectSeed(0);
+        ui.setVisible(seedBag, showSeedBag);
+    }
+
+    void selectSeed(int i) {
+        ui.setColor(seedSlots[selectedSeed], UiStyle{}.button);
+        selectedSeed = i;
+        ui.setColor(seedSlots[i], {0.55f, 0.45f, 0.15f, 1.f});
+        ui.setText(selectedLabel, kSeeds[i]);
+    }
+
+    void drawSeedBag(Renderer& r) {
+        // ImGui windows sit on top, so they get the pointer first
+        const Input& input = Input::instance();
+        if (!ImGui::GetIO().WantCaptureMouse)
+            ui.pointer(input.cursor(), input.held(Input::mouseButton(GLFW_MOUSE_BUTTON_LEFT)));
+        for (const UiId clicked : ui.clicks())
+            for (int i = 0; i < kSeedCount; ++i)
+                if (seedSlots[i] == clicked) selectSeed(i);
+
+        ui.update(r.windowSize());
+        r.drawUi(ui);
+        r.useShader(r.shapeShader);
+    }
+
+    Image image;
+    Texture* texture = nullptr;
+    Texture* heatmap = nullptr;
+    TextureArray* plants = nullptr;
+    PlantLook speciesLook[kPlantLooks] = {};  // texture array layer per species id
+    std::vector<std::uint8_t> plantPixels[kPlantLooks];  // preload -> load
+    bool showHeatmap = false;
+    bool showLabels = false;
+    Font font;
+    UiTree ui{font};
+    UiId seedBag = 0, selectedLabel = 0;
+    UiId seedSlots[kSeedCount] = {};
+    int selectedSeed = 0;
+    bool showSeedBag = true;
+    LightingSystem lighting;
+    bool showLighting = true;
+    int lightQuality = 1;  // Half
+    CachedLayer ground;
+    std::vector<std::uint8_t> soilLevels;  // per soil tile, as last painted
+    int heatmapField = 0;
+    Garden garden;
+    std::vector<GardenCommand> commands;
+    PlantId bed[kBedW * kBedH];
+    AnimationSystem animations;
+    std::uint32_t bedAnimation[kBedW * kBedH];
+    ParticleSystem particles;
+    int rainEmitter = 0;
+    std::uint16_t spray = 0;
+    SaveGame saves;
+    float autosaveTimer = 0.f;
 };
 
 // ----------------------------- sample scene2 ---------------------------
@@ -80,9 +546,45 @@ class GameScene2 : public Scene {
     }
 };
 
+// ----------------------------- pause overlay ---------------------------
+
+class PauseScene : public Scene {
+   public:
+    void draw(Renderer& r) override {
+        // dim whatever is underneath
+        r.useShader(r.shapeShader);
+        r.setColor({0, 0, 0, 0.5f});
+        r.fillRect({0, 0, 800 * 2, 600 * 2});
+        r.setColor({1, 1, 1, 1});
+    }
+};
+
+// ----------------------------- loading scene ---------------------------
+
+class LoadingScene : public Scene {
+   public:
+    void update(float dt) override { t += dt; }
+    void draw(Renderer& r) override {
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // indeterminate progress bar
+        const float x = 300.f + 150.f * std::sin(t * 3.f);
+        r.useShader(r.shapeShader);
+        r.setColor({0.3f, 0.8f, 0.3f, 1});
+        r.fillRect({x, 290, 100, 20});
+        r.setColor({1, 1, 1, 1});
+    }
+
+   private:
+    float t = 0.f;
+};
+
 // ----------------------------- renderer --------------------------------
 
 Renderer::Renderer(GLFWwindow* window) : window(window) {
+    ALLOC_TAG(Renderer);
+
     // initial viewport to framebuffer size
     int fbw = 0, fbh = 0;
     glfwGetFramebufferSize(window, &fbw, &fbh);
@@ -93,8 +595,14 @@ Renderer::Renderer(GLFWwindow* window) : window(window) {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    // input callbacks first, so ImGui's chain to them
+    Input::instance().attach(window);
+
     // ImGui
     IMGUI_CHECKVERSION();
+#if ENABLE_ALLOC_TRACKING
+    ImGui::SetAllocatorFunctions(imguiAlloc, imguiFree);
+#endif
     ImGui::CreateContext();
     ImGui::StyleColorsDark();
     ImGui_ImplGlfw_InitForOpenGL(window, true);
@@ -102,9 +610,27 @@ Renderer::Renderer(GLFWwindow* window) : window(window) {
 
     // shader
     currentShader.get().use();
+
+    // quad geometry
+    loadBuffers();
+
+    // vsync by default; main/benchmarks may override
+    pacer.setMode(PresentMode::VSync);
+
+    // GPU timer queries
+    Profiler::instance().initGpu();
+    Trace::setThreadName("main");
 }
 
 Renderer::~Renderer() {
+    // scenes hold GL objects; free them while the context still exists
+    SceneManager::instance().shutdown();
+    Profiler::instance().shutdownGpu();
+    targets.clear();
+    const GLuint lightTextures[] = {lightDataTex, lightTilesTex, lightEntriesTex};
+    glDeleteTextures(3, lightTextures);
+    white.destroy();
+
     // ImGui shutdown first
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
@@ -118,47 +644,108 @@ Renderer::~Renderer() {
 }
 
 void Renderer::run() {
-    loadBuffers();
-
     // scenes
+    ALLOC_TAG(Scenes);
     SceneManager::instance().addScene("game", std::make_unique<GameScene>(/*args*/));
     SceneManager::instance().addScene("game2", std::make_unique<GameScene2>(/*args*/));
+    SceneManager::instance().addScene("pause", std::make_unique<PauseScene>());
+
+    SceneManager::instance().setLoadingScene(std::make_unique<LoadingScene>());
 
     SceneManager::instance().setCurrentScene("game");
+    SceneManager::instance().preloadScene("game2");
 
     // timing
     double lastTime = glfwGetTime();
-    FpsSmoother fps;
     float dt = 0.f;
+    Profiler& profiler = Profiler::instance();
 
     while (!glfwWindowShouldClose(window)) {
+        profiler.beginFrame();
+
         const double now = glfwGetTime();
         dt = static_cast<float>(now - lastTime);
         lastTime = now;
         if (dt > 0.25f) dt = 0.25f;  // clamp to avoid huge spikes (pause, etc.)
-        fps.push(dt, 1.0 / dt);
 
-        processInput();
+        {
+            PROFILE_SCOPE("input");
+            Input& input = Input::instance();
+            input.beginFrame();
+            if (Input::Clock::time_point t; input.firstEventTime(t)) pacer.markInputEvent(t);
+            processInput(Replay::instance().frameActions(input.actionsPressed()));
+        }
         beginFrame();
 
         // game update/draw
-        SceneManager::instance().update(dt);
-        SceneManager::instance().draw(*this);
+        {
+            PROFILE_SCOPE("update");
+            SceneManager::instance().update(dt);
+        }
+        {
+            PROFILE_SCOPE("draw");
+            PROFILE_GPU_SCOPE("scene");
+            SceneManager::instance().draw(*this);
+        }
 
         // debug ui
-        ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_NoResize);
-        ImGui::Text("Scene: %s", SceneManager::instance().getCurrentScene().c_str());
-        ImGui::Separator();
-        ImGui::Text("FPS: %.1f", fps.value);
-        ImGui::Text("dt:  %.3f ms", dt * 1000.0f);
-        ImGui::Separator();
-        ImGui::End();
+        {
+            PROFILE_SCOPE("imgui");
+            ImGui::Begin("Debug", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Text("Scene: %s", SceneManager::instance().getCurrentScene().c_str());
+            for (int i = 1; i < SceneManager::instance().layerCount(); ++i)
+                ImGui::Text("  + %s", SceneManager::instance().layerName(i).c_str());
+            if (SceneManager::instance().isTransitioning())
+                ImGui::Text("Loading: %s", SceneManager::instance().getPendingScene().c_str());
+            ImGui::Text("dt:  %.3f ms", dt * 1000.0f);
+            ImGui::Text("Draw calls: %d", drawCalls);
+            ImGui::Separator();
+            profiler.drawDebugUI();
+            ImGui::Separator();
+            pacer.drawDebugUI();
+            ImGui::Separator();
+            ImGui::Text("frame arena %4zu allocs %8.1f KB / frame, %8.1f KB reserved",
+                        frameScratch.lastFrameAllocations(), frameScratch.lastFrameBytes() / 1024.0,
+                        frameScratch.capacity() / 1024.0);
+            AllocTracker::instance().drawDebugUI();
+#if ENABLE_TRACE
+            ImGui::Separator();
+            bool recording = Trace::recording();
+            if (ImGui::Checkbox("Record trace", &recording)) Trace::setRecording(recording);
+            ImGui::SameLine();
+            if (ImGui::Button("Dump trace.json")) Trace::dump("trace.json");
+#endif
+            ImGui::End();
+        }
 
         endFrame();
+        profiler.endFrame();
     }
 }
 
 void Renderer::beginFrame() {
+    ALLOC_TAG(Renderer);
+    drawCalls = 0;
+    frameScratch.reset();
+    int winW = 0, winH = 0;
+    glfwGetWindowSize(window, &winW, &winH);
+    winSize = {static_cast<float>(winW), static_cast<float>(winH)};
+    sprites.setViewport(winSize);
+    AllocTracker::instance().beginFrame();
+
+    // the world goes offscreen only when something has to happen to it on the way
+    targets.beginFrame();
+    worldTarget = drawTarget = nullptr;
+    if (post.active()) {
+        int fbW = 0, fbH = 0;
+        glfwGetFramebufferSize(window, &fbW, &fbH);
+        const float scale = std::clamp(post.resolutionScale, 0.25f, 1.f);
+        worldTarget = targets.acquire(std::max(1, static_cast<int>(static_cast<float>(fbW) * scale)),
+                                      std::max(1, static_cast<int>(static_cast<float>(fbH) * scale)));
+        drawTarget = worldTarget;
+    }
+    bindDrawTarget();
+
     glClearColor(0.0f, 0.0f, 1.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -168,20 +755,45 @@ void Renderer::beginFrame() {
 }
 
 void Renderer::endFrame() {
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    glfwSwapBuffers(window);
-    glfwPollEvents();
+    ALLOC_TAG(Renderer);
+    flushSprites();
+    beginUiPass();
+    {
+        PROFILE_SCOPE("imgui render");
+        PROFILE_GPU_SCOPE("imgui");
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
+    {
+        PROFILE_SCOPE("pace");
+        pacer.waitForDeadline();
+    }
+    {
+        PROFILE_SCOPE("swap");
+        glfwSwapBuffers(window);
+        pacer.markPresented();
+    }
+    {
+        PROFILE_SCOPE("poll");
+        glfwPollEvents();
+        pacer.markInputSampled();
+    }
 }
 
-void Renderer::processInput() {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+void Renderer::processInput(std::uint8_t actions) {
+    if (actions & kActionQuit)
         glfwSetWindowShouldClose(window, true);
 
-    if (glfwGetKey(window, GLFW_KEY_F1) == GLFW_PRESS)
+    if (actions & kActionSceneGame)
         SceneManager::instance().setCurrentScene("game");
-    if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS)
+    if (actions & kActionSceneGame2)
         SceneManager::instance().setCurrentScene("game2");
+
+    // pause overlay freezes the layers below but keeps drawing them
+    if (actions & kActionPause)
+        SceneManager::instance().pushScene("pause", {.updateBelow = false, .drawBelow = true});
+    if (actions & kActionResume)
+        SceneManager::instance().popScene("pause");
 }
 
 void Renderer::loadBuffers() {
@@ -217,41 +829,475 @@ void Renderer::loadBuffers() {
     // uv
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(1);
+
+    // particles: the quad again, plus x / y / age advancing once per instance; their
+    // pointers are set per draw since the arrays' offsets depend on the count
+    glGenVertexArrays(1, &particleVAO);
+    glBindVertexArray(particleVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &particleVBO);
+    for (GLuint attrib : {2u, 3u, 4u}) {
+        glEnableVertexAttribArray(attrib);
+        glVertexAttribDivisor(attrib, 1);
+    }
+
+    // sprites: clip-space position, uv and tint per vertex, refilled on every flush
+    std::vector<unsigned int> spriteIndices(6 * SpriteBatch::kMaxSprites);
+    for (unsigned int q = 0; q < SpriteBatch::kMaxSprites; ++q)
+        for (int k = 0; k < 6; ++k) spriteIndices[6 * q + k] = 4 * q + indices[k];
+
+    glGenVertexArrays(1, &spriteVAO);
+    glBindVertexArray(spriteVAO);
+
+    glGenBuffers(1, &spriteVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
+    glBufferData(GL_ARRAY_BUFFER, 4 * SpriteBatch::kMaxSprites * sizeof(SpriteBatch::Vertex), nullptr,
+                 GL_STREAM_DRAW);
+
+    glGenBuffers(1, &spriteEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, spriteEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, spriteIndices.size() * sizeof(unsigned int), spriteIndices.data(),
+                 GL_STATIC_DRAW);
+
+    auto spriteAttributes = [] {
+        constexpr GLsizei stride = sizeof(SpriteBatch::Vertex);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteBatch::Vertex, x));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteBatch::Vertex, u));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteBatch::Vertex, tint));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride,
+                              (void*)offsetof(SpriteBatch::Vertex, distanceField));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(SpriteBatch::Vertex, layer));
+        glEnableVertexAttribArray(4);
+    };
+    spriteAttributes();
+
+    // UI: the same vertex layout, but a buffer that persists and is patched in place;
+    // sized on first use
+    glGenVertexArrays(1, &uiVAO);
+    glBindVertexArray(uiVAO);
+    glGenBuffers(1, &uiVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, spriteEBO);
+    spriteAttributes();
+
+    glBindVertexArray(VAO);
+
+    // light data, fixed size: rows of kLightDataWidth texels, filled from the top row
+    // down as far as each frame needs. The tile grid follows the window (drawLights)
+    auto dataTexture = [](GLuint& tex, GLint format, GLenum layout, GLenum type, int rows) {
+        glGenTextures(1, &tex);
+        glBindTexture(GL_TEXTURE_2D, tex);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, kLightDataWidth, rows, 0, layout, type, nullptr);
+    };
+    dataTexture(lightDataTex, GL_RGBA32F, GL_RGBA, GL_FLOAT, 2 * LightingSystem::kMaxLights / kLightDataWidth);
+    dataTexture(lightEntriesTex, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT,
+                LightingSystem::kMaxTileEntries / kLightDataWidth);
+    dataTexture(lightTilesTex, GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT, 1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    static constexpr std::uint8_t kWhite[4] = {255, 255, 255, 255};
+    white.create(1, 1);
+    white.update(kWhite);
 }
 
 void Renderer::setColor(Color c) {
     glUniform4f(currentShader.get().getUniform("uColor"), c.r, c.g, c.b, c.a);
 }
 
-void Renderer::fillRect(Rect r) {
+void Renderer::setRectUniforms(Rect r) {
     int winW = 0, winH = 0;
     glfwGetWindowSize(window, &winW, &winH);
 
     // pixel -> NDC via uniforms (shader handles it)
-    const float widthGL = (winW > 0) ? (r.w / winW) : 0.f;
-    const float heightGL = (winH > 0) ? (r.h / winH) : 0.f;
-    const float xGL = -1.0f + (r.x / winW) * 2.0f;
-    const float yGL = 1.0f - (r.y / winH) * 2.0f - heightGL;
+    const Vec2 win{static_cast<float>(winW), static_cast<float>(winH)};
+    const Vec2 scale = (winW > 0 && winH > 0) ? Vec2{r.w, r.h} / win : Vec2{0.f, 0.f};
+    const Vec2 pos = Vec2{-1.f, 1.f} + Vec2{2.f, -2.f} * (Vec2{r.x, r.y} / win) - Vec2{0.f, scale.y};
 
-    glUniform2f(currentShader.get().getUniform("uPos"), xGL, yGL);
-    glUniform2f(currentShader.get().getUniform("uScale"), widthGL, heightGL);
+    glUniform2f(currentShader.get().getUniform("uPos"), pos.x, pos.y);
+    glUniform2f(currentShader.get().getUniform("uScale"), scale.x, scale.y);
+}
+
+void Renderer::fillRect(Rect r) {
+    setRectUniforms(r);
 
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    ++drawCalls;
 }
 
-void Renderer::fillTextureRect(Rect r, Texture& t) {
+void Renderer::drawParticles(const ParticleSystem& particles) {
+    PROFILE_SCOPE("particles draw");
     int winW = 0, winH = 0;
     glfwGetWindowSize(window, &winW, &winH);
+    if (winW <= 0 || winH <= 0) return;
 
-    // pixel -> NDC via uniforms (shader handles it)
-    const float widthGL = (winW > 0) ? (r.w / winW) : 0.f;
-    const float heightGL = (winH > 0) ? (r.h / winH) : 0.f;
-    const float xGL = -1.0f + (r.x / winW) * 2.0f;
-    const float yGL = 1.0f - (r.y / winH) * 2.0f - heightGL;
+    useShader(particleShader);
+    glUniform2f(particleShader.getUniform("uViewport"), static_cast<float>(winW), static_cast<float>(winH));
+    glBindVertexArray(particleVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, particleVBO);
+
+    for (int t = 0; t < particles.typeCount(); ++t) {
+        const ParticleSystem::Pool& p = particles.pool(static_cast<std::uint16_t>(t));
+        const int count = p.size();
+        if (count == 0) continue;
+
+        // the pool's arrays go up as they are, back to back; orphaning the buffer
+        // first lets the driver hand out fresh memory instead of waiting on last draw
+        const auto bytes = static_cast<GLsizeiptr>(count * sizeof(float));
+        glBufferData(GL_ARRAY_BUFFER, 3 * bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, p.x.data());
+        glBufferSubData(GL_ARRAY_BUFFER, bytes, bytes, p.y.data());
+        glBufferSubData(GL_ARRAY_BUFFER, 2 * bytes, bytes, p.age.data());
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 0, (void*)bytes);
+        glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, 0, (void*)(2 * bytes));
+
+        const ParticleType& type = particles.type(static_cast<std::uint16_t>(t));
+        setColor(type.color);
+        glUniform1f(particleShader.getUniform("uSize"), type.size);
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, count);
+        ++drawCalls;
+    }
+}
+
+void Renderer::drawSprite(const Texture& t, Rect r, Rect uv, Color tint) {
+    if (!sprites.accepts(t.id())) flushSprites();
+    sprites.add(t.id(), r, uv, tint);
+}
+
+void Renderer::drawSprite(const TextureArray& t, int layer, Rect r, Rect uv, Color tint) {
+    if (!sprites.accepts(t.id())) flushSprites();
+    sprites.addLayer(t.id(), layer, r, uv, tint);
+}
+
+void Renderer::drawText(Font& font, std::string_view text, Vec2 pos, float size, Color color) {
+    const ShapedText& shaped = font.shape(text);
+    const unsigned int atlas = font.texture().id();
+    const bool sdf = font.mode() == FontMode::Sdf;
+    for (const ShapedText::Quad& q : shaped.quads) {
+        if (!sprites.accepts(atlas)) flushSprites();
+        sprites.add(atlas, {pos.x + q.rect.x * size, pos.y + q.rect.y * size, q.rect.w * size, q.rect.h * size},
+                    q.uv, color, sdf);
+    }
+}
+
+void Renderer::flushSprites() {
+    if (sprites.empty()) return;
+
+    Shader& shader = sprites.isArray() ? spriteArrayShader : spriteShader;
+    useShader(shader);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(sprites.isArray() ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D, sprites.texture());
+    glUniform1i(shader.getUniform("uTex"), 0);
+
+    // orphan, then refill: the previous batch may still be in flight
+    const std::span<const SpriteBatch::Vertex> v = sprites.vertices();
+    glBindVertexArray(spriteVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, spriteVBO);
+    glBufferData(GL_ARRAY_BUFFER, 4 * SpriteBatch::kMaxSprites * sizeof(SpriteBatch::Vertex), nullptr,
+                 GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(v.size_bytes()), v.data());
+    glDrawElements(GL_TRIANGLES, 6 * sprites.count(), GL_UNSIGNED_INT, 0);
+    ++drawCalls;
+    sprites.clear();
+}
+
+void Renderer::drawUi(UiTree& ui) {
+    PROFILE_SCOPE("ui draw");
+    flushSprites();  // whatever was batched goes underneath
+    const std::span<const SpriteBatch::Vertex> v = ui.vertices();
+
+    glBindVertexArray(uiVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, uiVBO);
+    if (&ui != uploadedUi || v.size() > uiCapacity) {
+        // another tree, or it outgrew the buffer: reallocate with room to spare
+        uiCapacity = std::max<std::size_t>(v.size() + v.size() / 2, 4 * 256);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(uiCapacity * sizeof(SpriteBatch::Vertex)), nullptr,
+                     GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(v.size_bytes()), v.data());
+        uploadedUi = &ui;
+    } else if (ui.resized()) {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(v.size_bytes()), v.data());
+    } else if (ui.dirtyEnd() > ui.dirtyBegin()) {
+        const std::size_t first = ui.dirtyBegin();
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(first * sizeof(SpriteBatch::Vertex)),
+                        static_cast<GLsizeiptr>((ui.dirtyEnd() - first) * sizeof(SpriteBatch::Vertex)), &v[first]);
+    }
+    ui.markUploaded();
+    if (v.empty()) return;
+
+    useShader(spriteShader);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, ui.font().texture().id());
+    glUniform1i(spriteShader.getUniform("uTex"), 0);
+
+    // the shared index buffer covers kMaxSprites quads; larger trees draw in chunks
+    const std::size_t quads = v.size() / 4;
+    for (std::size_t first = 0; first < quads; first += SpriteBatch::kMaxSprites) {
+        const auto count = static_cast<GLsizei>(std::min<std::size_t>(quads - first, SpriteBatch::kMaxSprites));
+        glDrawElementsBaseVertex(GL_TRIANGLES, 6 * count, GL_UNSIGNED_INT, 0, static_cast<GLint>(4 * first));
+        ++drawCalls;
+    }
+}
+
+void Renderer::drawLights(LightingSystem& lighting) {
+    PROFILE_SCOPE("lighting");
+    flushSprites();
+    int winW = 0, winH = 0, targetW = 0, targetH = 0;
+    glfwGetWindowSize(window, &winW, &winH);
+    drawTargetSize(targetW, targetH);
+    if (winW <= 0 || winH <= 0 || targetW <= 0 || targetH <= 0) return;
 
-    glUniform2f(currentShader.get().getUniform("uPos"), xGL, yGL);
-    glUniform2f(currentShader.get().getUniform("uScale"), widthGL, heightGL);
+    const Vec2 win{static_cast<float>(winW), static_cast<float>(winH)};
+    lighting.cull(win);
+
+    // relative to what it lights, so a reduced world resolution reduces it too
+    const int scale = static_cast<int>(lighting.quality);
+    const int w = std::max(1, targetW / scale), h = std::max(1, targetH / scale);
+    RenderTarget* lightTarget = targets.acquire(w, h);
+    if (!lightTarget) return;
+
+    // lights as texels, two each; whole rows, so the scratch is padded to one
+    const std::span<const Light> lights = lighting.all();
+    if (!lights.empty()) {
+        const int rows = (2 * static_cast<int>(lights.size()) + kLightDataWidth - 1) / kLightDataWidth;
+        float* data = frameScratch.allocateArray<float>(static_cast<std::size_t>(rows) * kLightDataWidth * 4);
+        for (std::size_t i = 0; i < lights.size(); ++i) {
+            const Light& l = lights[i];
+            const float texels[8] = {l.pos.x, l.pos.y, l.radius, l.intensity, l.color.r, l.color.g, l.color.b, 0.f};
+            std::copy(std::begin(texels), std::end(texels), data + 8 * i);
+        }
+        glBindTexture(GL_TEXTURE_2D, lightDataTex);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kLightDataWidth, rows, GL_RGBA, GL_FLOAT, data);
+    }
+    const std::span<const std::uint32_t> entries = lighting.tileLights();
+    if (!entries.empty()) {
+        const int rows = (static_cast<int>(entries.size()) + kLightDataWidth - 1) / kLightDataWidth;
+        auto* data = frameScratch.allocateArray<std::uint32_t>(static_cast<std::size_t>(rows) * kLightDataWidth);
+        std::copy(entries.begin(), entries.end(), data);
+        glBindTexture(GL_TEXTURE_2D, lightEntriesTex);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kLightDataWidth, rows, GL_RED_INTEGER, GL_UNSIGNED_INT, data);
+    }
+    glBindTexture(GL_TEXTURE_2D, lightTilesTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, lighting.tilesX(), lighting.tilesY(), 0, GL_RG_INTEGER,
+                 GL_UNSIGNED_INT, lighting.tileRanges().data());
+
+    // accumulate: ambient plus every light reaching the pixel's tile
+    lightTarget->bind();
+    useShader(lightShader);
+    const GLuint textures[] = {lightDataTex, lightTilesTex, lightEntriesTex};
+    const char* const samplers[] = {"uLights", "uTiles", "uEntries"};
+    for (int unit = 0; unit < 3; ++unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, textures[unit]);
+        glUniform1i(lightShader.getUniform(samplers[unit]), unit);
+    }
+    glActiveTexture(GL_TEXTURE0);
+    glUniform2f(lightShader.getUniform("uPixelScale"), win.x / static_cast<float>(w), win.y / static_cast<float>(h));
+    glUniform1f(lightShader.getUniform("uWindowH"), win.y);
+    glUniform1f(lightShader.getUniform("uTileSize"), static_cast<float>(LightingSystem::kTileSize));
+    glUniform3f(lightShader.getUniform("uAmbient"), lighting.ambient.r, lighting.ambient.g, lighting.ambient.b);
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    ++drawCalls;
+
+    // composite: scene * light, upscaled with linear filtering
+    bindDrawTarget();
+    glBlendFunc(GL_DST_COLOR, GL_ZERO);
+    drawSprite(lightTarget->texture(), {0.f, 0.f, win.x, win.y}, {0, 0, 1, 1});
+    flushSprites();
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    targets.release(lightTarget);
+}
+
+// ----------------------------- targets and post-processing --------------
+
+void Renderer::bindDrawTarget() {
+    if (drawTarget) {
+        drawTarget->bind();
+        return;
+    }
+    int fbW = 0, fbH = 0;
+    glfwGetFramebufferSize(window, &fbW, &fbH);
+    RenderTarget::bindDefault(fbW, fbH);
+}
+
+void Renderer::drawTargetSize(int& w, int& h) const {
+    if (drawTarget) {
+        w = drawTarget->width();
+        h = drawTarget->height();
+        return;
+    }
+    glfwGetFramebufferSize(window, &w, &h);
+}
+
+void Renderer::fullscreenPass(Shader& s, const Texture& src, RenderTarget* dst) {
+    if (dst) {
+        dst->bind();
+    } else {
+        int fbW = 0, fbH = 0;
+        glfwGetFramebufferSize(window, &fbW, &fbH);
+        RenderTarget::bindDefault(fbW, fbH);
+    }
+    useShader(s);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, src.id());
+    glUniform1i(s.getUniform("uTex"), 0);
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    ++drawCalls;
+}
+
+void Renderer::applyEffect(PostEffect effect, const Texture& src, RenderTarget* dst) {
+    switch (effect) {
+        case PostEffect::ColorGrade:
+            useShader(postGradeShader);
+            glUniform1f(postGradeShader.getUniform("uExposure"), post.exposure);
+            glUniform1f(postGradeShader.getUniform("uContrast"), post.contrast);
+            glUniform1f(postGradeShader.getUniform("uSaturation"), post.saturation);
+            glUniform3f(postGradeShader.getUniform("uTint"), post.tint.r, post.tint.g, post.tint.b);
+            fullscreenPass(postGradeShader, src, dst);
+            break;
+        case PostEffect::Vignette:
+            useShader(postVignetteShader);
+            glUniform1f(postVignetteShader.getUniform("uStrength"), post.vignetteStrength);
+            glUniform1f(postVignetteShader.getUniform("uRadius"), post.vignetteRadius);
+            fullscreenPass(postVignetteShader, src, dst);
+            break;
+        case PostEffect::Bloom: {
+            // bright parts at half resolution, blurred there both ways, added back on top
+            const int w = std::max(1, src.width() / 2), h = std::max(1, src.height() / 2);
+            RenderTarget* bright = targets.acquire(w, h);
+            RenderTarget* blurred = targets.acquire(w, h);
+            if (!bright || !blurred) {
+                targets.release(bright);
+                targets.release(blurred);
+                fullscreenPass(postCopyShader, src, dst);
+                break;
+            }
+            useShader(bloomBrightShader);
+            glUniform1f(bloomBrightShader.getUniform("uThreshold"), post.bloomThreshold);
+            fullscreenPass(bloomBrightShader, src, bright);
+            useShader(bloomBlurShader);
+            glUniform2f(bloomBlurShader.getUniform("uStep"), 1.f / static_cast<float>(w), 0.f);
+            fullscreenPass(bloomBlurShader, bright->texture(), blurred);
+            glUniform2f(bloomBlurShader.getUniform("uStep"), 0.f, 1.f / static_cast<float>(h));
+            fullscreenPass(bloomBlurShader, blurred->texture(), bright);
+            targets.release(blurred);
+
+            useShader(bloomCombineShader);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, bright->texture().id());
+            glUniform1i(bloomCombineShader.getUniform("uBloom"), 1);
+            glUniform1f(bloomCombineShader.getUniform("uIntensity"), post.bloomIntensity);
+            fullscreenPass(bloomCombineShader, src, dst);
+            targets.release(bright);
+            break;
+        }
+    }
+}
+
+bool Renderer::beginLayer(CachedLayer& layer) {
+    int targetW = 0, targetH = 0, winW = 0, winH = 0;
+    drawTargetSize(targetW, targetH);
+    glfwGetWindowSize(window, &winW, &winH);
+    if (targetW <= 0 || targetH <= 0 || winW <= 0 || winH <= 0) return false;
+
+    // at the resolution of whatever it is composited into, so it maps pixel for pixel
+    RenderTarget& t = layer.target();
+    if (t.width() != targetW || t.height() != targetH) {
+        if (!t.create(targetW, targetH)) return false;
+        layer.invalidate();
+    }
+    if (!layer.dirty()) return false;
+
+    PROFILE_SCOPE("layer repaint");
+    flushSprites();
+    layerParent = drawTarget;
+    drawTarget = &t;
+    bindDrawTarget();
+
+    // the dirty rect in target pixels, rounded outward; GL counts rows from the bottom
+    const Rect dirty = layer.dirtyRect({static_cast<float>(winW), static_cast<float>(winH)});
+    const float sx = static_cast<float>(targetW) / static_cast<float>(winW);
+    const float sy = static_cast<float>(targetH) / static_cast<float>(winH);
+    const int x0 = std::clamp(static_cast<int>(std::floor(dirty.x * sx)), 0, targetW);
+    const int x1 = std::clamp(static_cast<int>(std::ceil((dirty.x + dirty.w) * sx)), 0, targetW);
+    const int y0 = std::clamp(static_cast<int>(std::floor(dirty.y * sy)), 0, targetH);
+    const int y1 = std::clamp(static_cast<int>(std::ceil((dirty.y + dirty.h) * sy)), 0, targetH);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(x0, targetH - y1, x1 - x0, y1 - y0);
+    glClearColor(0.f, 0.f, 0.f, 0.f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    // over transparent black this leaves color premultiplied by coverage, and alpha the
+    // coverage itself, ready for drawLayer's premultiplied blend
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    return true;
+}
+
+void Renderer::endLayer(CachedLayer& layer) {
+    flushSprites();
+    glDisable(GL_SCISSOR_TEST);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    drawTarget = layerParent;
+    layerParent = nullptr;
+    bindDrawTarget();
+    layer.markClean();
+}
+
+void Renderer::drawLayer(CachedLayer& layer) {
+    if (!layer.target()) return;
+    flushSprites();
+    int winW = 0, winH = 0;
+    glfwGetWindowSize(window, &winW, &winH);
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    drawSprite(layer.target().texture(), {0.f, 0.f, static_cast<float>(winW), static_cast<float>(winH)}, {0, 0, 1, 1});
+    flushSprites();
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Renderer::beginUiPass() {
+    if (!worldTarget) return;
+    PROFILE_SCOPE("post");
+    flushSprites();
+
+    // ping-pong through pooled targets at the world's size; the last pass goes to the
+    // window at its own resolution
+    glDisable(GL_BLEND);
+    RenderTarget* src = worldTarget;
+    const int last = static_cast<int>(post.chain.size()) - 1;
+    for (int i = 0; i <= last; ++i) {
+        RenderTarget* dst = i == last ? nullptr : targets.acquire(src->width(), src->height());
+        applyEffect(post.chain[i], src->texture(), dst);
+        targets.release(src);
+        if (!dst) {
+            src = nullptr;
+            break;
+        }
+        src = dst;
+    }
+    if (src) {  // no effects, only a reduced resolution: upscale
+        fullscreenPass(postCopyShader, src->texture(), nullptr);
+        targets.release(src);
+    }
+    glEnable(GL_BLEND);
+
+    worldTarget = drawTarget = nullptr;
+}
+
+void Renderer::fillTextureRect(Rect r, Texture& t) {
+    setRectUniforms(r);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, t.id());
@@ -259,4 +1305,5 @@ void Renderer::fillTextureRect(Rect r, Texture& t) {
 
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    ++drawCalls;
 }
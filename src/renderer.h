@@ -1,13 +1,31 @@
 #pragma once
 
+#include <cstdint>
+#include <string_view>
+
 struct GLFWwindow;
 struct Rect;
 struct Color;
+class CachedLayer;
+class Font;
+class LightingSystem;
+class ParticleSystem;
+class UiTree;
 
+#include "alloc_tracker.h"
+#include "arena.h"
+#include "frame_pacer.h"
+#include "post_process.h"
+#include "render_target.h"
 #include "shader.h"
+#include "sprite_batch.h"
 #include "texture.h"
 
 class Renderer {
+    // first member: constructed before and destroyed after everything else, so its leak
+    // report (tracking build only) covers the renderer's whole lifetime
+    LeakCheck leakCheck;
+
    public:
     Renderer(GLFWwindow* window);
     ~Renderer();
@@ -24,6 +42,12 @@ class Renderer {
     GLFWwindow* windowHandle() const noexcept { return window; }
     void getWindowSizePx(int& w, int& h) const noexcept;
 
+    // Swap interval / frame limiter
+    FramePacer& framePacer() noexcept { return pacer; }
+
+    // Scratch memory for the current frame, reset in beginFrame
+    FrameArena& frameArena() noexcept { return frameScratch; }
+
     // Frame boundaries (keeps ImGui/swap/poll out of scenes)
     void beginFrame();
     void endFrame();
@@ -36,22 +60,117 @@ class Renderer {
     void setColor(Color c);
     void fillRect(Rect r);
     void fillTextureRect(Rect r, Texture& t);
+    // One instanced draw per particle type; leaves particleShader in use
+    void drawParticles(const ParticleSystem& particles);
+
+    // Batched textured quads: uv picks a sub-rect of t (e.g. an atlas frame) and tint
+    // multiplies it. Consecutive sprites of the same texture go out in one draw call, on
+    // the next texture change or flushSprites(); flush before drawing anything else that
+    // should land on top of them. endFrame flushes whatever is left.
+    void drawSprite(const Texture& t, Rect r, Rect uv, Color tint = {1.f, 1.f, 1.f, 1.f});
+    // The same from one layer of t; every layer joins the same batch
+    void drawSprite(const TextureArray& t, int layer, Rect r, Rect uv, Color tint = {1.f, 1.f, 1.f, 1.f});
+    void flushSprites();  // leaves spriteShader (or spriteArrayShader) in use if there was anything to draw
+    // Text from its top left, size being a glyph's height; goes into the sprite batch
+    // like any other sprite, so flush the same way. Accepts '\n'.
+    void drawText(Font& font, std::string_view text, Vec2 pos, float size, Color color);
+
+    // A retained UI tree over everything drawn so far. Its vertices stay on the GPU
+    // between frames; only the range it changed since the last call is uploaded, and
+    // nothing at all when it did not change. Call ui.update() first.
+    void drawUi(UiTree& ui);
+
+    // Culls the lights, renders them at the lighting's quality into the light buffer and
+    // multiplies the result over everything drawn so far; draw the world first and the
+    // UI after. Leaves textureShader in use.
+    void drawLights(LightingSystem& lighting);
+
+    // Cached layers (see CachedLayer): beginLayer returns false while the layer is clean.
+    // Otherwise draws land in the layer's texture, clipped to its dirty region (cleared
+    // first), until endLayer. drawLayer composites it over what is drawn so far and
+    // leaves textureShader in use.
+    bool beginLayer(CachedLayer& layer);
+    void endLayer(CachedLayer& layer);
+    void drawLayer(CachedLayer& layer);
+
+    // A 1x1 opaque white texture: with drawSprite's tint, flat rects in the sprite batch
+    const Texture& whiteTexture() const noexcept { return white; }
+
+    // World resolution and post effects, picked up by the next beginFrame. While either
+    // is on, the world draws offscreen until beginUiPass() (or endFrame) runs the chain
+    // into the window; everything after, UI and ImGui, draws at the window's resolution.
+    PostSettings& postSettings() noexcept { return post; }
+    void beginUiPass();
+    const RenderTargetPool& renderTargets() const noexcept { return targets; }
+
+    // Window size in pixels, as of beginFrame
+    Vec2 windowSize() const noexcept { return winSize; }
+
+    // Per-frame stats (reset in beginFrame)
+    int drawCallCount() const noexcept { return drawCalls; }
 
     Shader shapeShader = Shader("shaders/shape.vert", "shaders/shape.frag");
     Shader textureShader = Shader("shaders/texture.vert", "shaders/texture.frag");
+    Shader particleShader = Shader("shaders/particle.vert", "shaders/particle.frag");
+    Shader spriteShader = Shader("shaders/sprite.vert", "shaders/sprite.frag");
+    Shader spriteArrayShader = Shader("shaders/sprite.vert", "shaders/sprite_array.frag");
+    Shader lightShader = Shader("shaders/light.vert", "shaders/light.frag");
 
    private:
+    static constexpr int kLightDataWidth = 256;  // texels per row of the light data textures
+
     GLFWwindow* window = nullptr;
+    Vec2 winSize = {0.f, 0.f};
 
     // GL objects (kept as plain unsigned ints to avoid GL headers here)
     unsigned int VAO = 0, VBO = 0, EBO = 0;
+    // the same quad plus per-instance attributes streamed from particleVBO
+    unsigned int particleVAO = 0, particleVBO = 0;
+    // streamed sprite vertices, with indices for a full batch of quads
+    unsigned int spriteVAO = 0, spriteVBO = 0, spriteEBO = 0;
+    // the UI tree's vertices, kept between frames; shares spriteEBO
+    unsigned int uiVAO = 0, uiVBO = 0;
+    const UiTree* uploadedUi = nullptr;  // whose vertices uiVBO holds
+    std::size_t uiCapacity = 0;          // vertices
+    // the culled lights as textures for the light pass
+    unsigned int lightDataTex = 0, lightTilesTex = 0, lightEntriesTex = 0;
+
+    // offscreen passes: world, post effects, light buffer
+    RenderTargetPool targets;
+    RenderTarget* worldTarget = nullptr;  // this frame's world, until beginUiPass
+    RenderTarget* drawTarget = nullptr;   // where draws land; nullptr is the window
+    PostSettings post;
+    RenderTarget* layerParent = nullptr;  // drawTarget to go back to after endLayer
+    Texture white;
+    Shader postCopyShader = Shader("shaders/post.vert", "shaders/post_copy.frag");
+    Shader postGradeShader = Shader("shaders/post.vert", "shaders/post_grade.frag");
+    Shader postVignetteShader = Shader("shaders/post.vert", "shaders/post_vignette.frag");
+    Shader bloomBrightShader = Shader("shaders/post.vert", "shaders/bloom_bright.frag");
+    Shader bloomBlurShader = Shader("shaders/post.vert", "shaders/bloom_blur.frag");
+    Shader bloomCombineShader = Shader("shaders/post.vert", "shaders/bloom_combine.frag");
+
+    int drawCalls = 0;
+
+    SpriteBatch sprites;
+    FramePacer pacer;
+    FrameArena frameScratch;
 
     // shader
 
     std::reference_wrapper<Shader> currentShader = shapeShader;
 
-    // Main loop helpers
-    void processInput();
+    // Pixel-space rect -> the quad shaders' uPos / uScale
+    void setRectUniforms(Rect r);
+
+    // Binds drawTarget (or the window) with a viewport over all of it
+    void bindDrawTarget();
+    void drawTargetSize(int& w, int& h) const;
+    // src over the whole of dst (nullptr: the window) through s
+    void fullscreenPass(Shader& s, const Texture& src, RenderTarget* dst);
+    void applyEffect(PostEffect effect, const Texture& src, RenderTarget* dst);
+
+    // Main loop helpers: acts on the frame's newly pressed InputAction bits
+    void processInput(std::uint8_t actions);
 
     // GPU resources
     void loadBuffers();
@@ -0,0 +1,310 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <print>
+
+#include "save.h"
+#include "trace.h"
+
+// ----------------------------- format --------------------------------
+
+namespace {
+constexpr char kMagic[4] = {'G', 'R', 'P', 'L'};
+
+enum RecordTag : std::uint8_t {
+    kFrame = 1,    // u8 actions
+    kGarden = 2,   // u8 species count, then per species u8 name length, name, 9 floats
+    kCommand = 3,  // u8 type, 4 floats; belongs to the next step
+    kStep = 4,     // f32 dt
+    kHash = 5,     // u32, one per tick of the last step
+};
+
+template <class T>
+void put(std::ofstream& out, const T& v) {
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+// Bounds-checked cursor over the whole file
+struct Cursor {
+    const char* data;
+    std::size_t size;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    bool done() const { return !ok || pos >= size; }
+    template <class T>
+    T get() {
+        T v{};
+        if (!ok || sizeof(T) > size - pos) {
+            ok = false;
+            return v;
+        }
+        std::memcpy(&v, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+    std::string string(std::size_t n) {
+        if (!ok || n > size - pos) {
+            ok = false;
+            return {};
+        }
+        pos += n;
+        return {data + pos - n, n};
+    }
+};
+}  // namespace
+
+// ----------------------------- recording -----------------------------
+
+bool Replay::startRecording(const std::string& file) {
+    stop();
+    out.open(file, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::println(stderr, "Could not open replay file {} for writing", file);
+        return false;
+    }
+    out.write(kMagic, sizeof(kMagic));
+    put(out, kVersion);
+    put(out, Garden::kTickSeconds);
+
+    path = file;
+    sessionsStarted = 0;
+    current = Mode::Recording;
+    return true;
+}
+
+void Replay::stop() {
+    if (recording()) out.close();
+    // release rather than clear: the instance lives until exit, past the leak check
+    frames = {};
+    sessions = {};
+    tickHashes = {};
+    path = {};
+    current = Mode::Off;
+}
+
+std::uint8_t Replay::frameActions(std::uint8_t live) {
+    if (recording()) {
+        put(out, kFrame);
+        put(out, live);
+        return live;
+    }
+    if (!playing() || nextFrame >= frames.size()) return live;
+    const std::uint8_t actions = frames[nextFrame++];
+    finishIfDone();
+    return actions;
+}
+
+bool Replay::beginGarden(Garden& garden) {
+    if (recording()) {
+        const std::string save = sessionSavePath(sessionsStarted++);
+
+        // start from what the file holds (sleeping plants load awake), so playback
+        // begins bit for bit where the recording did
+        SaveGame saves;
+        saves.saveAsync(garden, save);
+        saves.wait();
+        if (!saves.lastStats().ok || !saves.load(garden, save)) {
+            std::println(stderr, "Could not save replay start state to {}", save);
+            return false;
+        }
+
+        put(out, kGarden);
+        put(out, static_cast<std::uint8_t>(garden.plants.speciesCount()));
+        for (int s = 0; s < garden.plants.speciesCount(); ++s) {
+            const PlantSpecies& sp = garden.plants.species(static_cast<std::uint16_t>(s));
+            const auto length = static_cast<std::uint8_t>(std::min<std::size_t>(std::strlen(sp.name), 255));
+            put(out, length);
+            out.write(sp.name, length);
+            for (float v : {sp.growthRate, sp.maxStage, sp.waterUse, sp.nutrientUse, sp.wiltThreshold,
+                            sp.nutrientThreshold, sp.wiltDamage, sp.recoverRate, sp.uptakeRate})
+                put(out, v);
+        }
+        return true;
+    }
+
+    if (playing()) {
+        if (session + 1 >= static_cast<int>(sessions.size())) return false;
+        ++session;
+        nextStep = 0;
+        SaveGame saves;
+        if (!saves.load(garden, sessionSavePath(session))) {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+int Replay::updateGarden(Garden& garden, float dt, std::vector<GardenCommand>& commands) {
+    const Step* step = nullptr;
+    if (playing() && session >= 0 && nextStep < sessions[session].steps.size()) {
+        step = &sessions[session].steps[nextStep++];
+        dt = step->dt;
+        commands = step->commands;
+    }
+
+    for (const GardenCommand& c : commands) garden.apply(c);
+
+    tickHashes.clear();
+    if (recording() || step) garden.tickHashes = &tickHashes;
+    const int ticks = garden.advance(dt);
+    garden.tickHashes = nullptr;
+
+    if (recording()) {
+        for (const GardenCommand& c : commands) {
+            put(out, kCommand);
+            put(out, c.type);
+            for (float a : c.args) put(out, a);
+        }
+        put(out, kStep);
+        put(out, dt);
+        for (std::uint64_t h : tickHashes) {
+            put(out, kHash);
+            put(out, static_cast<std::uint32_t>(h));
+        }
+    } else if (step) {
+        checkHashes(*step, tickHashes);
+        finishIfDone();
+    }
+    commands.clear();
+    return ticks;
+}
+
+// ----------------------------- playback ------------------------------
+
+bool Replay::startPlayback(const std::string& file) {
+    stop();
+    if (!parse(file)) return false;
+    path = file;
+    mismatches = 0;
+    nextFrame = 0;
+    session = -1;
+    nextStep = 0;
+    current = Mode::Playing;
+    return true;
+}
+
+bool Replay::parse(const std::string& file) {
+    std::ifstream in(file, std::ios::binary);
+    if (!in) {
+        std::println(stderr, "Could not open replay file {}", file);
+        return false;
+    }
+    const std::vector<char> bytes{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    Cursor c{bytes.data(), bytes.size()};
+
+    const std::string magic = c.string(sizeof(kMagic));
+    const auto version = c.get<std::uint32_t>();
+    const auto tickSeconds = c.get<float>();
+    if (!c.ok || std::memcmp(magic.data(), kMagic, sizeof(kMagic)) != 0) {
+        std::println(stderr, "{} is not a replay file", file);
+        return false;
+    }
+    if (version != kVersion || tickSeconds != Garden::kTickSeconds) {
+        std::println(stderr, "Replay {} is version {} at {}s ticks, expected {} at {}s", file, version, tickSeconds,
+                     kVersion, Garden::kTickSeconds);
+        return false;
+    }
+
+    std::vector<GardenCommand> pending;
+    while (!c.done()) {
+        switch (c.get<std::uint8_t>()) {
+            case kFrame:
+                frames.push_back(c.get<std::uint8_t>());
+                break;
+            case kGarden: {
+                Session& s = sessions.emplace_back();
+                const auto count = c.get<std::uint8_t>();
+                for (int i = 0; i < count && c.ok; ++i) {
+                    s.names.push_back(c.string(c.get<std::uint8_t>()));
+                    PlantSpecies& sp = s.species.emplace_back();
+                    for (float* v : {&sp.growthRate, &sp.maxStage, &sp.waterUse, &sp.nutrientUse, &sp.wiltThreshold,
+                                     &sp.nutrientThreshold, &sp.wiltDamage, &sp.recoverRate, &sp.uptakeRate})
+                        *v = c.get<float>();
+                }
+                break;
+            }
+            case kCommand: {
+                GardenCommand& command = pending.emplace_back();
+                command.type = c.get<GardenCommand::Type>();
+                for (float& a : command.args) a = c.get<float>();
+                break;
+            }
+            case kStep: {
+                const float dt = c.get<float>();
+                if (!sessions.empty()) sessions.back().steps.push_back({dt, std::move(pending), {}});
+                pending.clear();
+                break;
+            }
+            case kHash: {
+                const auto hash = c.get<std::uint32_t>();
+                if (!sessions.empty() && !sessions.back().steps.empty())
+                    sessions.back().steps.back().hashes.push_back(hash);
+                break;
+            }
+            default:
+                c.ok = false;
+        }
+    }
+
+    // a recording cut off mid-record (the game crashed) still plays up to there
+    if (!c.ok) std::println(stderr, "Replay {} is damaged after {} bytes; playing what came before", file, c.pos);
+
+    // names are only stable once every string is in place
+    for (Session& s : sessions)
+        for (std::size_t i = 0; i < s.species.size(); ++i) s.species[i].name = s.names[i].c_str();
+    return true;
+}
+
+std::string Replay::sessionSavePath(int index) const {
+    return path + "." + std::to_string(index) + ".sav";
+}
+
+void Replay::checkHashes(const Step& step, const std::vector<std::uint64_t>& hashes) {
+    bool same = step.hashes.size() == hashes.size();
+    for (std::size_t i = 0; same && i < hashes.size(); ++i)
+        same = step.hashes[i] == static_cast<std::uint32_t>(hashes[i]);
+    if (same) return;
+
+    // later steps follow from the first difference, so only that one is worth printing
+    if (mismatches++ == 0)
+        std::println(stderr, "Replay diverged: garden session {}, update {} ({} ticks recorded, {} run)", session,
+                     nextStep - 1, step.hashes.size(), hashes.size());
+}
+
+void Replay::finishIfDone() {
+    if (nextFrame < frames.size()) return;
+    if (session + 1 < static_cast<int>(sessions.size())) return;
+    if (session >= 0 && nextStep < sessions[session].steps.size()) return;
+    std::println("Replay finished, {} diverged updates", mismatches);
+    stop();
+}
+
+bool Replay::runHeadless(const std::string& file) {
+    Replay& r = instance();
+    if (!r.startPlayback(file)) return false;
+    TRACE_SCOPE("replay headless");
+
+    // the engine frames need a window; only the garden sessions are played
+    r.nextFrame = r.frames.size();
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::size_t sessionCount = r.sessions.size();
+    std::uint64_t ticks = 0;
+    for (std::size_t s = 0; s < sessionCount && r.playing(); ++s) {
+        Garden garden;
+        for (const PlantSpecies& sp : r.sessions[s].species) garden.plants.addSpecies(sp);
+        if (!r.beginGarden(garden)) return false;
+
+        std::vector<GardenCommand> live;
+        while (r.playing() && r.nextStep < r.sessions[s].steps.size()) ticks += r.updateGarden(garden, 0.f, live);
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::println("Replayed {} garden sessions, {} ticks in {:.1f} ms ({:.0f}x real time)", sessionCount, ticks, ms,
+                 ticks * Garden::kTickSeconds * 1000.0 / std::max(ms, 1e-3));
+    return r.mismatches == 0;
+}
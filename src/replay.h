@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "garden.h"
+
+// Records a session to a compact binary file and plays it back.
+//
+// The file is a stream of tagged records: each frame's input actions and, for every
+// garden session (a GameScene load), the species it started with, then each update's
+// commands and dt followed by a 32-bit state hash per fixed tick. The garden's starting
+// state goes to a save file next to the replay. Playback feeds the recorded values back
+// instead of the live ones and compares hashes, so the first tick that comes out
+// different is reported; runHeadless does the garden part without a window, as fast as
+// it can.
+class Replay {
+   public:
+    enum class Mode { Off, Recording, Playing };
+    // 2: frame actions are pressed-this-frame edges rather than held keys
+    static constexpr std::uint32_t kVersion = 2;
+
+    // Singleton access
+    static Replay& instance() {
+        static Replay inst;
+        return inst;
+    }
+
+    // Delete copy/move
+    Replay(const Replay&) = delete;
+    Replay& operator=(const Replay&) = delete;
+    Replay(Replay&&) = delete;
+    Replay& operator=(Replay&&) = delete;
+
+    bool startRecording(const std::string& path);
+    bool startPlayback(const std::string& path);
+    void stop();
+    Mode mode() const { return current; }
+    bool recording() const { return current == Mode::Recording; }
+    bool playing() const { return current == Mode::Playing; }
+    int divergences() const { return mismatches; }
+
+    // Once per frame: records the live InputAction bits, or swaps in the recorded ones
+    std::uint8_t frameActions(std::uint8_t live);
+
+    // A garden session starts (after its species are registered, before its first
+    // update): recording saves its state, playback loads the recorded one instead.
+    // Returns false when playback has no session left to give it.
+    bool beginGarden(Garden& garden);
+    // Advances the garden by one update: dt and commands are recorded, or replaced by the
+    // recorded ones during playback, then applied and the ticks hashed. Returns ticks run.
+    int updateGarden(Garden& garden, float dt, std::vector<GardenCommand>& commands);
+
+    // Plays every garden session in a replay without a window. Returns false if it
+    // could not be read or any tick diverged.
+    static bool runHeadless(const std::string& path);
+
+   private:
+    Replay() = default;
+
+    struct Step {
+        float dt = 0.f;
+        std::vector<GardenCommand> commands;
+        std::vector<std::uint32_t> hashes;
+    };
+    struct Session {
+        std::vector<PlantSpecies> species;
+        std::vector<std::string> names;  // species names point in here
+        std::vector<Step> steps;
+    };
+
+    bool parse(const std::string& path);
+    std::string sessionSavePath(int session) const;
+    void checkHashes(const Step& step, const std::vector<std::uint64_t>& hashes);
+    void finishIfDone();
+
+    Mode current = Mode::Off;
+    std::string path;
+    int mismatches = 0;
+
+    // recording; every call comes from the main thread, GameScene::load included
+    std::ofstream out;
+    int sessionsStarted = 0;
+    std::vector<std::uint64_t> tickHashes;
+
+    // playback
+    std::vector<std::uint8_t> frames;
+    std::vector<Session> sessions;
+    std::size_t nextFrame = 0;
+    int session = -1;
+    std::size_t nextStep = 0;
+};
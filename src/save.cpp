@@ -0,0 +1,537 @@
+#include "save.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <type_traits>
+
+#include "garden.h"
+#include "trace.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(std::endian::native == std::endian::little, "save files are written in native byte order");
+
+// ----------------------------- format --------------------------------
+
+namespace {
+constexpr char kMagic[4] = {'G', 'S', 'A', 'V'};
+constexpr std::size_t kSectionAlign = 64;
+constexpr std::size_t kArrayAlign = 16;
+
+enum SectionType : std::uint32_t {
+    kSoilInfo = 1,   // SoilInfo
+    kSoilChunk = 2,  // moisture, nitrogen, temperature of kChunkRows rows
+    kPlantPool = 3,  // PoolInfo, then stage, water, nutrients, health, tile, owner
+    kPlantSlots = 4, // SlotsInfo, then SavedSlot[slotCount], free list[freeCount]
+};
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+    std::uint64_t generation;  // bumped by every save, full or delta
+    double time;
+    std::uint64_t tick;
+    std::int64_t wallClock;
+    std::uint64_t tableChecksum;
+    std::uint64_t reserved2;
+};
+static_assert(sizeof(FileHeader) == kSectionAlign);
+
+struct TableEntry {
+    std::uint32_t type, index;
+    std::uint64_t offset, size, checksum;
+};
+static_assert(sizeof(TableEntry) == 32);
+
+static_assert(std::is_trivially_copyable_v<SoilParams>);
+struct SoilInfo {
+    std::int32_t width, height, chunkRows, reserved;
+    SoilParams params;
+};
+
+struct PoolInfo {
+    std::uint32_t count;
+    std::uint32_t reserved[3];
+};
+
+struct SlotsInfo {
+    std::uint32_t slotCount, freeCount, liveCount, reserved;
+};
+
+struct SavedSlot {
+    std::uint32_t index, generation;
+    std::uint16_t species;
+    std::uint8_t used, reserved;
+};
+static_assert(sizeof(SavedSlot) == 12);
+
+std::size_t alignUp(std::size_t n, std::size_t align) {
+    return (n + align - 1) & ~(align - 1);
+}
+
+// FNV-1a over 64-bit words, then any trailing bytes
+std::uint64_t checksum(const std::byte* data, std::size_t size) {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0x100000001b3ull;
+    }
+    for (; i < size; ++i) h = (h ^ static_cast<std::uint64_t>(data[i])) * 0x100000001b3ull;
+    return h;
+}
+
+// Appends raw values to a section; arrays start 16-byte aligned so they can be loaded
+// with SIMD straight from a mapping
+struct SectionWriter {
+    std::vector<std::byte>& out;
+
+    template <class T>
+    void value(const T& v) {
+        append(&v, sizeof(T));
+    }
+    template <class T>
+    void array(const T* v, std::size_t count) {
+        out.resize(alignUp(out.size(), kArrayAlign));
+        append(v, count * sizeof(T));
+    }
+    void append(const void* p, std::size_t n) {
+        const auto* b = static_cast<const std::byte*>(p);
+        out.insert(out.end(), b, b + n);
+    }
+};
+
+// Copies them back out, refusing to read past the section
+struct SectionReader {
+    const std::byte* data;
+    std::size_t size;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    template <class T>
+    T value() {
+        T v{};
+        copy(&v, sizeof(T));
+        return v;
+    }
+    template <class T>
+    void array(T* dst, std::size_t count) {
+        pos = alignUp(pos, kArrayAlign);
+        copy(dst, count * sizeof(T));
+    }
+    template <class T>
+    void array(std::vector<T>& dst, std::size_t count) {
+        dst.resize(count);
+        array(dst.data(), count);
+    }
+    void copy(void* dst, std::size_t n) {
+        if (!ok || n > size || pos > size - n) {
+            ok = false;
+            return;
+        }
+        std::memcpy(dst, data + pos, n);
+        pos += n;
+    }
+};
+
+// Read-only view of a whole file
+class MappedFile {
+   public:
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER bytes;
+        if (!GetFileSizeEx(file, &bytes) || bytes.QuadPart == 0) return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) return;
+        view = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view) length = static_cast<std::size_t>(bytes.QuadPart);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                view = static_cast<const std::byte*>(p);
+                length = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        close(fd);  // the mapping keeps the file open
+#endif
+    }
+    ~MappedFile() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (view) munmap(const_cast<std::byte*>(view), length);
+#endif
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::byte* data() const { return view; }
+    std::size_t size() const { return length; }
+
+   private:
+    const std::byte* view = nullptr;
+    std::size_t length = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#endif
+};
+
+const TableEntry* findSection(const TableEntry* table, std::uint32_t count, std::uint32_t type, std::uint32_t index) {
+    for (std::uint32_t i = 0; i < count; ++i)
+        if (table[i].type == type && table[i].index == index) return &table[i];
+    return nullptr;
+}
+}  // namespace
+
+// ----------------------------- saving --------------------------------
+
+bool SaveGame::saveAsync(const Garden& garden, const std::string& path) {
+    if (busy()) return false;
+    collect();
+
+    std::vector<Section> sections;
+    {
+        TRACE_SCOPE("save snapshot");
+        sections = snapshot(garden);
+    }
+
+    // its own thread rather than a job: a slow disk would keep a worker from parallelFor
+    pending = std::async(std::launch::async, [this, sections = std::move(sections), path, time = garden.time,
+                                              tick = garden.tick, clock = garden.lastWallClock]() mutable {
+        return write(std::move(sections), path, time, tick, clock);
+    });
+    return true;
+}
+
+void SaveGame::wait() {
+    if (pending.valid()) pending.wait();
+    collect();
+}
+
+bool SaveGame::busy() const {
+    return pending.valid() && pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+const SaveGame::Stats& SaveGame::lastStats() {
+    collect();
+    return last;
+}
+
+void SaveGame::collect() {
+    if (pending.valid() && pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        last = pending.get();
+}
+
+std::vector<SaveGame::Section> SaveGame::snapshot(const Garden& garden) {
+    const SoilGrid& soil = garden.soil;
+    const PlantSim& plants = garden.plants;
+    const int chunks = (soil.height() + kChunkRows - 1) / kChunkRows;
+
+    // writers hold references into the vector, so it must not reallocate
+    std::vector<Section> sections;
+    sections.reserve(2 + chunks + plants.speciesCount());
+    auto add = [&](std::uint32_t type, std::uint32_t index) {
+        sections.push_back({type, index, {}});
+        return SectionWriter{sections.back().bytes};
+    };
+
+    add(kSoilInfo, 0).value(SoilInfo{soil.width(), soil.height(), kChunkRows, 0, soil.params});
+    for (int c = 0; c < chunks; ++c) {
+        const int y0 = c * kChunkRows;
+        const std::size_t count = static_cast<std::size_t>(std::min(kChunkRows, soil.height() - y0)) * soil.width();
+        SectionWriter out = add(kSoilChunk, c);
+        for (auto f : {SoilGrid::Field::Moisture, SoilGrid::Field::Nitrogen, SoilGrid::Field::Temperature})
+            out.array(soil.field(f) + soil.index(0, y0), count);
+    }
+
+    // sleeping plants are saved with their current values and load awake
+    std::vector<float> stage, water, nutrients, health;
+    for (int s = 0; s < plants.speciesCount(); ++s) {
+        const auto species = static_cast<std::uint16_t>(s);
+        const PlantSim::Pool& p = plants.pool(species);
+        stage.resize(p.size());
+        water.resize(p.size());
+        nutrients.resize(p.size());
+        health.resize(p.size());
+        for (int i = 0; i < p.size(); ++i) {
+            const PlantState state = plants.stateAt(species, i);
+            stage[i] = state.stage;
+            water[i] = state.water;
+            nutrients[i] = state.nutrients;
+            health[i] = state.health;
+        }
+
+        SectionWriter out = add(kPlantPool, s);
+        out.value(PoolInfo{static_cast<std::uint32_t>(p.size()), {}});
+        out.array(stage.data(), stage.size());
+        out.array(water.data(), water.size());
+        out.array(nutrients.data(), nutrients.size());
+        out.array(health.data(), health.size());
+        out.array(p.tile.data(), p.tile.size());
+        out.array(p.owner.data(), p.owner.size());
+    }
+
+    std::vector<SavedSlot> slots;
+    slots.reserve(plants.slots.size());
+    for (const PlantSim::Slot& slot : plants.slots)
+        slots.push_back({slot.index, slot.generation, slot.species, static_cast<std::uint8_t>(slot.used), 0});
+    SectionWriter out = add(kPlantSlots, 0);
+    out.value(SlotsInfo{static_cast<std::uint32_t>(slots.size()), static_cast<std::uint32_t>(plants.freeSlots.size()),
+                        static_cast<std::uint32_t>(plants.liveCount), 0});
+    out.array(slots.data(), slots.size());
+    out.array(plants.freeSlots.data(), plants.freeSlots.size());
+    return sections;
+}
+
+SaveGame::Stats SaveGame::write(std::vector<Section> sections, const std::string& path, double time,
+                                std::uint64_t tick, std::int64_t wallClock) {
+    TRACE_SCOPE("save write");
+    const auto t0 = std::chrono::steady_clock::now();
+
+    Stats stats;
+    stats.sectionCount = static_cast<int>(sections.size());
+
+    // lay the sections out after the header and table
+    std::vector<Written> layout;
+    layout.reserve(sections.size());
+    std::uint64_t offset = alignUp(sizeof(FileHeader) + sections.size() * sizeof(TableEntry), kSectionAlign);
+    for (const Section& s : sections) {
+        layout.push_back({s.type, s.index, offset, s.bytes.size(), checksum(s.bytes.data(), s.bytes.size())});
+        offset = alignUp(offset + s.bytes.size(), kSectionAlign);
+    }
+    const std::uint64_t fileSize = offset;
+
+    std::vector<TableEntry> table;
+    table.reserve(layout.size());
+    for (const Written& w : layout) table.push_back({w.type, w.index, w.offset, w.size, w.checksum});
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.sectionCount = static_cast<std::uint32_t>(table.size());
+    header.generation = ++generation;
+    header.time = time;
+    header.tick = tick;
+    header.wallClock = wallClock;
+    header.tableChecksum =
+        checksum(reinterpret_cast<const std::byte*>(table.data()), table.size() * sizeof(TableEntry));
+
+    // either way the new file is built next to the old one and renamed over it, so a
+    // crash mid-save leaves the last good save in place
+    const std::string temp = path + ".tmp";
+    std::error_code ec;
+    // the file still has this layout: copy it and patch the sections that changed
+    const bool sameLayout =
+        path == filePath && std::ranges::equal(layout, onDisk, [](const Written& a, const Written& b) {
+            return a.type == b.type && a.index == b.index && a.offset == b.offset && a.size == b.size;
+        });
+    if (sameLayout && std::filesystem::file_size(path, ec) == fileSize &&
+        std::filesystem::copy_file(path, temp, std::filesystem::copy_options::overwrite_existing, ec)) {
+        std::fstream file(temp, std::ios::in | std::ios::out | std::ios::binary);
+        for (std::size_t i = 0; file && i < sections.size(); ++i) {
+            if (layout[i].checksum == onDisk[i].checksum) continue;
+            file.seekp(static_cast<std::streamoff>(layout[i].offset));
+            file.write(reinterpret_cast<const char*>(sections[i].bytes.data()),
+                       static_cast<std::streamsize>(sections[i].bytes.size()));
+            ++stats.sectionsWritten;
+            stats.bytesWritten += sections[i].bytes.size();
+        }
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()),
+                   static_cast<std::streamsize>(table.size() * sizeof(TableEntry)));
+        stats.bytesWritten += sizeof(header) + table.size() * sizeof(TableEntry);
+        file.flush();
+        stats.ok = static_cast<bool>(file);
+        stats.delta = true;
+    } else {
+        std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+        static constexpr char kZeros[kSectionAlign] = {};
+        auto pad = [&](std::uint64_t to) {
+            file.write(kZeros, static_cast<std::streamsize>(to - static_cast<std::uint64_t>(file.tellp())));
+        };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()),
+                   static_cast<std::streamsize>(table.size() * sizeof(TableEntry)));
+        for (std::size_t i = 0; file && i < sections.size(); ++i) {
+            pad(layout[i].offset);
+            file.write(reinterpret_cast<const char*>(sections[i].bytes.data()),
+                       static_cast<std::streamsize>(sections[i].bytes.size()));
+        }
+        pad(fileSize);
+        file.flush();
+        stats.ok = static_cast<bool>(file);
+        stats.sectionsWritten = stats.sectionCount;
+        stats.bytesWritten = fileSize;
+    }
+    if (stats.ok) std::filesystem::rename(temp, path, ec);
+    stats.ok = stats.ok && !ec;
+
+    if (stats.ok) {
+        filePath = path;
+        onDisk = std::move(layout);
+    } else {
+        // whatever is on disk now, the next save rewrites all of it
+        std::println(stderr, "Could not write save file {}", path);
+        onDisk.clear();
+    }
+    stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return stats;
+}
+
+// ----------------------------- loading -------------------------------
+
+bool SaveGame::load(Garden& garden, const std::string& path) {
+    wait();
+    TRACE_SCOPE("save load");
+
+    // no save yet (a fresh start) is not an error
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) return false;
+    const MappedFile file(path);
+    if (!file.data()) {
+        std::println(stderr, "Could not open save file {}", path);
+        return false;
+    }
+    auto damaged = [&] {
+        std::println(stderr, "Save file {} is damaged", path);
+        return false;
+    };
+
+    FileHeader header;
+    if (file.size() < sizeof(header)) return damaged();
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        std::println(stderr, "{} is not a save file", path);
+        return false;
+    }
+    // version 1 is the only one so far; older versions would be upgraded here
+    if (header.version != kVersion) {
+        std::println(stderr, "Save file {} is version {}, expected {}", path, header.version, kVersion);
+        return false;
+    }
+
+    // validate the table and every section before touching the garden
+    const std::size_t tableBytes = static_cast<std::size_t>(header.sectionCount) * sizeof(TableEntry);
+    if (header.sectionCount > file.size() / sizeof(TableEntry) || sizeof(header) + tableBytes > file.size())
+        return damaged();
+    const std::byte* tableData = file.data() + sizeof(header);
+    if (checksum(tableData, tableBytes) != header.tableChecksum) return damaged();
+    std::vector<TableEntry> table(header.sectionCount);
+    std::memcpy(table.data(), tableData, tableBytes);
+    for (const TableEntry& e : table) {
+        if (e.offset % kSectionAlign != 0 || e.offset > file.size() || e.size > file.size() - e.offset)
+            return damaged();
+        if (checksum(file.data() + e.offset, e.size) != e.checksum) return damaged();
+    }
+    auto reader = [&](const TableEntry& e) {
+        return SectionReader{file.data() + e.offset, static_cast<std::size_t>(e.size)};
+    };
+
+    // soil
+    const TableEntry* infoEntry = findSection(table.data(), header.sectionCount, kSoilInfo, 0);
+    if (!infoEntry) return damaged();
+    SectionReader infoReader = reader(*infoEntry);
+    const auto info = infoReader.value<SoilInfo>();
+    if (!infoReader.ok || info.width < 0 || info.height < 0 || info.chunkRows <= 0) return damaged();
+
+    SoilGrid soil;
+    soil.resize(info.width, info.height);
+    soil.params = info.params;
+    for (int y0 = 0, c = 0; y0 < info.height; y0 += info.chunkRows, ++c) {
+        const TableEntry* e = findSection(table.data(), header.sectionCount, kSoilChunk, c);
+        if (!e) return damaged();
+        SectionReader in = reader(*e);
+        const std::size_t count = static_cast<std::size_t>(std::min(info.chunkRows, info.height - y0)) * info.width;
+        in.array(soil.moisture() + soil.index(0, y0), count);
+        in.array(soil.nitrogen() + soil.index(0, y0), count);
+        in.array(soil.temperature() + soil.index(0, y0), count);
+        if (!in.ok) return damaged();
+    }
+
+    // plants, into a copy so the garden keeps its species and survives a bad file
+    PlantSim plants = garden.plants;
+    for (PlantSim::Pool& p : plants.pools) p = {};
+    for (const TableEntry& e : table) {
+        if (e.type != kPlantPool) continue;
+        if (e.index >= plants.pools.size()) {
+            std::println(stderr, "Save file {} has plant species {}, only {} registered", path, e.index,
+                         plants.pools.size());
+            return false;
+        }
+        PlantSim::Pool& p = plants.pools[e.index];
+        SectionReader in = reader(e);
+        const auto pool = in.value<PoolInfo>();
+        in.array(p.stage, pool.count);
+        in.array(p.water, pool.count);
+        in.array(p.nutrients, pool.count);
+        in.array(p.health, pool.count);
+        in.array(p.tile, pool.count);
+        in.array(p.owner, pool.count);
+        if (!in.ok) return damaged();
+        // the sim indexes the soil by these without checking
+        if (std::ranges::any_of(p.tile, [&](std::uint32_t t) { return t >= static_cast<std::uint32_t>(soil.size()); }))
+            return damaged();
+    }
+
+    const TableEntry* slotsEntry = findSection(table.data(), header.sectionCount, kPlantSlots, 0);
+    if (!slotsEntry) return damaged();
+    SectionReader in = reader(*slotsEntry);
+    const auto slotsInfo = in.value<SlotsInfo>();
+    std::vector<SavedSlot> slots;
+    in.array(slots, slotsInfo.slotCount);
+    in.array(plants.freeSlots, slotsInfo.freeCount);
+    if (!in.ok) return damaged();
+
+    plants.slots.resize(slots.size());
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        const SavedSlot& s = slots[i];
+        plants.slots[i] = {s.species, s.index, s.generation, s.used != 0};
+        // a live slot and its pool entry must point at each other
+        if (s.used && (s.species >= plants.pools.size() || s.index >= plants.pools[s.species].owner.size() ||
+                       plants.pools[s.species].owner[s.index] != i))
+            return damaged();
+    }
+    plants.liveCount = static_cast<int>(slotsInfo.liveCount);
+    plants.resetSchedule();
+
+    garden.soil = std::move(soil);
+    garden.plants = std::move(plants);
+    garden.time = header.time;
+    garden.tick = header.tick;
+    garden.lastWallClock = header.wallClock;
+
+    // saving back over this file only rewrites what changed
+    filePath = path;
+    onDisk.clear();
+    for (const TableEntry& e : table) onDisk.push_back({e.type, e.index, e.offset, e.size, e.checksum});
+    generation = header.generation;
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+class Garden;
+
+// Save games. A file is a 64-byte header, a table of sections and the sections
+// themselves, each starting on a 64-byte boundary and holding raw little-endian arrays,
+// so a loader maps the file and copies straight out of it. The soil is split into
+// fixed-size chunks of rows and each species' plants get their own section.
+//
+// Saving snapshots the garden on the calling thread (a copy of its arrays) and writes
+// on a background thread. The new file is always written to a temporary and renamed
+// over the old one, so a crash mid-save keeps the last good file. When the file still
+// has the layout of the last save, the temporary is a copy of it with only the sections
+// whose checksum changed rewritten; otherwise the whole file is serialized.
+class SaveGame {
+   public:
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr int kChunkRows = 16;  // soil rows per chunk section
+
+    struct Stats {
+        bool ok = false;
+        bool delta = false;  // only changed sections rewritten, into a copy of the old file
+        int sectionsWritten = 0;
+        int sectionCount = 0;
+        std::size_t bytesWritten = 0;
+        double ms = 0.0;  // on the save thread
+    };
+
+    SaveGame() = default;
+    SaveGame(const SaveGame&) = delete;
+    SaveGame& operator=(const SaveGame&) = delete;
+    ~SaveGame() { wait(); }
+
+    // Start saving garden to path. Returns false (and does nothing) while the previous
+    // save is still being written.
+    bool saveAsync(const Garden& garden, const std::string& path);
+    // Block until the save in flight, if any, is on disk
+    void wait();
+    bool busy() const;
+    // Result of the last finished save
+    const Stats& lastStats();
+
+    // Restore soil, plants and time into garden, whose species must already be
+    // registered in the same order as when it was saved. Returns false, leaving garden
+    // untouched, if the file is missing, from a newer version or damaged.
+    bool load(Garden& garden, const std::string& path);
+
+   private:
+    struct Section {
+        std::uint32_t type = 0;
+        std::uint32_t index = 0;
+        std::vector<std::byte> bytes;
+    };
+
+    // Where each section of the file on disk sits and what it held
+    struct Written {
+        std::uint32_t type, index;
+        std::uint64_t offset, size, checksum;
+    };
+
+    static std::vector<Section> snapshot(const Garden& garden);
+    Stats write(std::vector<Section> sections, const std::string& path, double time, std::uint64_t tick,
+                std::int64_t wallClock);
+    void collect();
+
+    // only touched by the save thread while a save is in flight
+    std::string filePath;
+    std::vector<Written> onDisk;
+    std::uint64_t generation = 0;
+
+    std::future<Stats> pending;
+    Stats last;
+};
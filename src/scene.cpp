@@ -1,25 +1,219 @@
 #include "scene.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <print>
+
+#include "alloc_tracker.h"
+#include "jobs.h"
+#include "trace.h"
+
+namespace {
+const std::string kNoScene;
+}  // namespace
+
 void SceneManager::update(float dt) {
-    if (!currentScene.empty())
-        scenes[currentScene]->update(dt);
+    if (!preloading.empty()) pollPreloads();
+    if (!pending.empty()) advanceTransition();
+
+    if (stack.empty()) {
+        if (loadingScene) loadingScene->update(dt);
+        return;
+    }
+
+    // the top layer always updates; lower ones only while every layer above allows it
+    int first = static_cast<int>(stack.size()) - 1;
+    while (first > 0 && stack[first].policy.updateBelow) --first;
+    for (int i = first; i < static_cast<int>(stack.size()); ++i) stack[i].entry->scene->update(dt);
 }
 
 void SceneManager::draw(Renderer& r) {
-    if (!currentScene.empty())
-        scenes[currentScene]->draw(r);
+    if (stack.empty()) {
+        if (loadingScene) loadingScene->draw(r);
+        return;
+    }
+
+    // bottom-up, starting at the highest layer that hides everything beneath it
+    int first = static_cast<int>(stack.size()) - 1;
+    while (first > 0 && stack[first].policy.drawBelow) --first;
+    for (int i = first; i < static_cast<int>(stack.size()); ++i) stack[i].entry->scene->draw(r);
 }
 
 Scene& SceneManager::addScene(const std::string& name, std::unique_ptr<Scene> scene) {
     Scene& ref = *scene;
-    scenes[name] = std::move(scene);
+    Entry& entry = scenes[name];
+    entry.name = name;
+    entry.scene = std::move(scene);
     return ref;
 }
 
 void SceneManager::setCurrentScene(const std::string& scene) {
-    if (!currentScene.empty())
-        scenes[currentScene]->unload();
+    Entry* entry = find(scene);
+    if (!entry) return;
+
+    // already there, or already on the way: nothing to do
+    const bool isBase = stack.size() == 1 && stack[0].entry == entry;
+    if (!pending.empty() && pending.back().target == entry && pending.back().op == Pending::Op::Replace) return;
+    if (pending.empty() && isBase) return;
+
+    // switching back before the pending scenes arrived; they stay warm
+    const bool onlyReplaces = std::all_of(pending.begin(), pending.end(),
+                                          [](const Pending& p) { return p.op == Pending::Op::Replace; });
+    if (isBase && onlyReplaces) {
+        pending.clear();
+        return;
+    }
+
+    pending.push_back({Pending::Op::Replace, entry, {}});
+    if (entry->residency == SceneResidency::Unloaded) startPreload(*entry);
+}
+
+void SceneManager::pushScene(const std::string& scene, ScenePolicy policy) {
+    Entry* entry = find(scene);
+    if (!entry || onStack(entry) || queued(entry)) return;
+
+    pending.push_back({Pending::Op::Push, entry, policy});
+    if (entry->residency == SceneResidency::Unloaded) startPreload(*entry);
+}
+
+void SceneManager::popScene() {
+    if (!stack.empty()) popLayer();
+}
+
+void SceneManager::popScene(const std::string& scene) {
+    if (!stack.empty() && stack.back().entry->name == scene) popLayer();
+}
+
+void SceneManager::preloadScene(const std::string& scene) {
+    Entry* entry = find(scene);
+    if (entry && entry->residency == SceneResidency::Unloaded) startPreload(*entry);
+}
+
+void SceneManager::setLoadingScene(std::unique_ptr<Scene> scene) {
+    if (loadingScene) {
+        loadingScene->unload();
+        loadingScene->resources().release();
+    }
+    loadingScene = std::move(scene);
+    if (loadingScene) {
+        // the loading screen has to be available immediately
+        loadingScene->preload();
+        loadingScene->load();
+    }
+}
+
+void SceneManager::shutdown() {
+    for (Entry* entry : preloading) entry->preload.wait();
+    preloading.clear();
+    pending.clear();
+
+    while (!stack.empty()) popLayer();
+    for (auto& [name, entry] : scenes) {
+        // warm scenes were loaded; ones whose preload was never polled only hold CPU data
+        if (entry.residency == SceneResidency::Resident) entry.scene->unload();
+        entry.scene->resources().release();
+    }
+    scenes.clear();
+    setLoadingScene(nullptr);
+}
+
+const std::string& SceneManager::getCurrentScene() const {
+    return stack.empty() ? kNoScene : stack.front().entry->name;
+}
+
+const std::string& SceneManager::getPendingScene() const {
+    return pending.empty() ? kNoScene : pending.front().target->name;
+}
+
+SceneResidency SceneManager::residency(const std::string& scene) const {
+    auto it = scenes.find(scene);
+    return it == scenes.end() ? SceneResidency::Unloaded : it->second.residency;
+}
+
+SceneManager::Entry* SceneManager::find(const std::string& scene) {
+    auto it = scenes.find(scene);
+    if (it == scenes.end()) {
+        std::println(stderr, "Unknown scene {}", scene);
+        return nullptr;
+    }
+    return &it->second;
+}
 
-    currentScene = scene;
-    scenes[currentScene]->load();
-}
\ No newline at end of file
+bool SceneManager::onStack(const Entry* entry) const {
+    return std::any_of(stack.begin(), stack.end(), [entry](const Layer& l) { return l.entry == entry; });
+}
+
+bool SceneManager::queued(const Entry* entry) const {
+    return std::any_of(pending.begin(), pending.end(), [entry](const Pending& p) { return p.target == entry; });
+}
+
+void SceneManager::startPreload(Entry& entry) {
+    entry.residency = SceneResidency::Preloading;
+    Scene* scene = entry.scene.get();
+    entry.preload = JobSystem::instance().submit([scene] {
+        TRACE_SCOPE("scene preload");
+        ALLOC_TAG(Scenes);
+        scene->preload();
+    });
+    preloading.push_back(&entry);
+}
+
+void SceneManager::pollPreloads() {
+    for (std::size_t i = 0; i < preloading.size();) {
+        Entry& entry = *preloading[i];
+        if (entry.preload.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++i;
+            continue;
+        }
+        preloading[i] = preloading.back();
+        preloading.pop_back();
+
+        try {
+            entry.preload.get();
+        } catch (const std::exception& e) {
+            std::println(stderr, "Failed to preload scene {}: {}", entry.name, e.what());
+            entry.scene->resources().release();
+            entry.residency = SceneResidency::Unloaded;
+            std::erase_if(pending, [&entry](const Pending& p) { return p.target == &entry; });
+            continue;
+        }
+
+        // GL uploads happen here, on the main thread
+        TRACE_SCOPE("scene load");
+        entry.scene->load();
+        entry.residency = SceneResidency::Resident;
+    }
+}
+
+void SceneManager::advanceTransition() {
+    // in request order: a later transition waits for the ones before it
+    std::size_t done = 0;
+    for (; done < pending.size() && pending[done].target->residency == SceneResidency::Resident; ++done) {
+        const Pending& next = pending[done];
+        TRACE_SCOPE("scene switch");
+        if (next.op == Pending::Op::Replace) {
+            while (!stack.empty()) {
+                // the target may already be warm on the stack; keep it resident
+                if (stack.back().entry == next.target)
+                    stack.pop_back();
+                else
+                    popLayer();
+            }
+        }
+        stack.push_back({next.target, next.policy});
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(done));
+}
+
+void SceneManager::popLayer() {
+    Entry* entry = stack.back().entry;
+    stack.pop_back();
+
+    entry->scene->unload();
+    entry->scene->resources().release();
+    entry->residency = SceneResidency::Unloaded;
+    // popped while a queued transition still needs it
+    if (queued(entry)) startPreload(*entry);
+}
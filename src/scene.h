@@ -1,19 +1,44 @@
 #pragma once
 
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "arena.h"
+
 struct Renderer;
 
 class Scene {
    public:
     virtual ~Scene() = default;
+    // Runs on a worker thread: decode/parse assets into CPU memory. Must not touch GL.
+    virtual void preload() {}
+    // Runs on the main thread once preload() finished: upload to the GPU.
     virtual void load() {}
     virtual void update(float dt) {}
     virtual void draw(Renderer& r) {}
     virtual void unload() {}
+
+    // Scene-scoped allocations, destroyed in one shot after unload(). Scenes lower on
+    // the stack outlive the ones above them, so overlays may borrow their resources.
+    ResourceArena& resources() { return arena; }
+
+   private:
+    ResourceArena arena;
+};
+
+enum class SceneResidency {
+    Unloaded,
+    Preloading,  // preload() running on a worker
+    Resident,    // preloaded and uploaded, ready to draw
+};
+
+// How a layer treats the layers beneath it on the stack
+struct ScenePolicy {
+    bool updateBelow = false;  // e.g. false for a pause menu
+    bool drawBelow = true;     // false for opaque full-screen layers
 };
 
 class SceneManager {
@@ -31,19 +56,78 @@ class SceneManager {
     SceneManager& operator=(SceneManager&&) = delete;
 
     // API
-    void update(float dt);
+    void update(float dt);  // also advances pending transitions
     void draw(Renderer& r);
 
     Scene& addScene(const std::string& name, std::unique_ptr<Scene> scene);
 
+    // Transitions queue up and apply in request order, each once its scene is resident.
+    //
+    // Replace the whole stack with one scene. Asynchronous and idempotent: the current
+    // stack keeps running until the new scene is resident, and repeated requests for
+    // the current or last requested scene are no-ops.
     void setCurrentScene(const std::string& scene);
 
-    std::string getCurrentScene() const { return currentScene; }
+    // Push an overlay once it is resident (no-op if already on the stack or queued).
+    void pushScene(const std::string& scene, ScenePolicy policy = {});
+    // Pop the top layer, or the named layer only if it is on top.
+    void popScene();
+    void popScene(const std::string& scene);
+
+    // Warm a scene up in the background so switching to it later is instant.
+    void preloadScene(const std::string& scene);
+
+    // Drawn while the stack is empty (e.g. at startup).
+    void setLoadingScene(std::unique_ptr<Scene> scene);
+
+    // Unload and drop every scene, waiting for preloads in flight. Call before the GL
+    // context goes away.
+    void shutdown();
+
+    // Base of the stack
+    const std::string& getCurrentScene() const;
+    const std::string& getPendingScene() const;  // the transition being waited on
+    bool isTransitioning() const { return !pending.empty(); }
+    SceneResidency residency(const std::string& scene) const;
+
+    int layerCount() const { return static_cast<int>(stack.size()); }
+    const std::string& layerName(int i) const { return stack[i].entry->name; }
 
    private:
+    struct Entry {
+        std::string name;
+        std::unique_ptr<Scene> scene;
+        SceneResidency residency = SceneResidency::Unloaded;
+        std::future<void> preload;
+    };
+
+    struct Layer {
+        Entry* entry;
+        ScenePolicy policy;
+    };
+
+    struct Pending {
+        enum class Op { Replace, Push };
+        Op op = Op::Replace;
+        Entry* target = nullptr;
+        ScenePolicy policy;
+    };
+
     SceneManager() = default;
     ~SceneManager() = default;
 
-    std::unordered_map<std::string, std::unique_ptr<Scene>> scenes;
-    std::string currentScene;
+    Entry* find(const std::string& scene);
+    bool onStack(const Entry* entry) const;
+    bool queued(const Entry* entry) const;
+    void startPreload(Entry& entry);
+    void pollPreloads();
+    void advanceTransition();
+    void popLayer();
+
+    // entries never move (node-based map), so layers hold direct pointers
+    std::unordered_map<std::string, Entry> scenes;
+    std::vector<Layer> stack;
+    std::vector<Entry*> preloading;
+    std::vector<Pending> pending;  // oldest first
+    std::unique_ptr<Scene> loadingScene;
 };
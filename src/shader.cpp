@@ -10,8 +10,11 @@
 #include <string>
 
 #include "resources.h"
+#include "trace.h"
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath) {
+    TRACE_SCOPE("shader compile");
+
     // load shader files
     std::string vertexShaderSource = load_file(vertexPath);
     std::string fragmentShaderSource = load_file(fragmentPath);
@@ -72,6 +75,11 @@ void Shader::checkShaderError(GLuint shader, std::string shaderType) {
     }
 }
 
-GLint Shader::getUniform(std::string uniformName) {
-    return glGetUniformLocation(ID, uniformName.c_str());
-}
\ No newline at end of file
+GLint Shader::getUniform(std::string_view uniformName) {
+    for (const Uniform& u : uniforms)
+        if (u.name == uniformName) return u.location;
+
+    Uniform& u = uniforms.emplace_back(std::string(uniformName), -1);
+    u.location = glGetUniformLocation(ID, u.name.c_str());
+    return u.location;
+}
\ No newline at end of file
@@ -4,6 +4,10 @@
 #include <glad/gl.h>
 
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "alloc_tracker.h"
 
 class Shader {
    public:
@@ -12,7 +16,8 @@ class Shader {
 
     void use();
 
-    GLint getUniform(std::string uniformName);
+    // Cached after the first lookup, so the draw path neither allocates nor asks GL
+    GLint getUniform(std::string_view uniformName);
 
     unsigned int
     getID() { return ID; }
@@ -20,5 +25,12 @@ class Shader {
    private:
     unsigned int ID;
 
+    struct Uniform {
+        std::string name;
+        GLint location;
+    };
+    std::vector<Uniform, TrackingAllocator<Uniform>> uniforms{
+        TrackingAllocator<Uniform>(AllocTracker::instance().counter("shaders"))};
+
     void checkShaderError(GLuint shader, std::string shader_type);
 };
@@ -0,0 +1,111 @@
+#pragma once
+
+// Thin float-vector wrappers so kernels are written once and compiled for the
+// widest instruction set enabled at build time (make ARCH=-mavx2 for AVX).
+// simd::Float is that widest type; simd::F1 is the scalar fallback / tail type.
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2 1
+#endif
+
+#include <algorithm>
+
+namespace simd {
+
+// ----------------------------- scalar --------------------------------
+
+struct F1 {
+    using Mask = bool;
+    static constexpr int width = 1;
+    float v;
+
+    static F1 load(const float* p) { return {*p}; }
+    static F1 set1(float x) { return {x}; }
+    void store(float* p) const { *p = v; }
+
+    friend F1 operator+(F1 a, F1 b) { return {a.v + b.v}; }
+    friend F1 operator-(F1 a, F1 b) { return {a.v - b.v}; }
+    friend F1 operator*(F1 a, F1 b) { return {a.v * b.v}; }
+    friend F1 operator/(F1 a, F1 b) { return {a.v / b.v}; }
+    friend F1 min(F1 a, F1 b) { return {std::min(a.v, b.v)}; }
+    friend F1 max(F1 a, F1 b) { return {std::max(a.v, b.v)}; }
+    friend Mask operator<(F1 a, F1 b) { return a.v < b.v; }
+    friend Mask operator>=(F1 a, F1 b) { return a.v >= b.v; }
+    friend F1 select(Mask m, F1 a, F1 b) { return m ? a : b; }
+
+    static Mask both(Mask a, Mask b) { return a && b; }
+    static int bits(Mask m) { return m ? 1 : 0; }  // lane i -> bit i
+};
+
+// ----------------------------- sse2 ----------------------------------
+
+#if defined(SIMD_AVX) || defined(SIMD_SSE2)
+struct F4 {
+    using Mask = __m128;
+    static constexpr int width = 4;
+    __m128 v;
+
+    static F4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static F4 set1(float x) { return {_mm_set1_ps(x)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    friend F4 operator+(F4 a, F4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend F4 operator-(F4 a, F4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend F4 operator*(F4 a, F4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend F4 operator/(F4 a, F4 b) { return {_mm_div_ps(a.v, b.v)}; }
+    friend F4 min(F4 a, F4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    friend F4 max(F4 a, F4 b) { return {_mm_max_ps(a.v, b.v)}; }
+    friend Mask operator<(F4 a, F4 b) { return _mm_cmplt_ps(a.v, b.v); }
+    friend Mask operator>=(F4 a, F4 b) { return _mm_cmpge_ps(a.v, b.v); }
+    friend F4 select(Mask m, F4 a, F4 b) { return {_mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v))}; }
+
+    static Mask both(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static int bits(Mask m) { return _mm_movemask_ps(m); }
+};
+#endif
+
+// ----------------------------- avx -----------------------------------
+
+#if defined(SIMD_AVX)
+struct F8 {
+    using Mask = __m256;
+    static constexpr int width = 8;
+    __m256 v;
+
+    static F8 load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static F8 set1(float x) { return {_mm256_set1_ps(x)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+    friend F8 operator+(F8 a, F8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+    friend F8 operator-(F8 a, F8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+    friend F8 operator*(F8 a, F8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+    friend F8 operator/(F8 a, F8 b) { return {_mm256_div_ps(a.v, b.v)}; }
+    friend F8 min(F8 a, F8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+    friend F8 max(F8 a, F8 b) { return {_mm256_max_ps(a.v, b.v)}; }
+    friend Mask operator<(F8 a, F8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+    friend Mask operator>=(F8 a, F8 b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+    friend F8 select(Mask m, F8 a, F8 b) { return {_mm256_blendv_ps(b.v, a.v, m)}; }
+
+    static Mask both(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static int bits(Mask m) { return _mm256_movemask_ps(m); }
+};
+using Float = F8;
+inline constexpr const char* kName = "AVX";
+#elif defined(SIMD_SSE2)
+using Float = F4;
+inline constexpr const char* kName = "SSE2";
+#else
+using Float = F1;
+inline constexpr const char* kName = "scalar";
+#endif
+
+template <class V>
+V clamp(V x, V lo, V hi) {
+    return min(max(x, lo), hi);
+}
+
+}  // namespace simd
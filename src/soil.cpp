@@ -0,0 +1,292 @@
+#include "soil.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "jobs.h"
+#include "simd.h"
+#include "trace.h"
+
+// ----------------------------- kernel --------------------------------
+
+namespace {
+constexpr int kRowsPerJob = 16;
+constexpr int kColumnsPerJob = 64;
+constexpr float kNegligible = 1e-20f;
+
+// 5-point Laplacian step over interior columns [x, end); returns the first column not done
+template <class V>
+int stencil(const float* up, const float* c, const float* dn, float* out, int x, int end, float k) {
+    const V kv = V::set1(k);
+    const V four = V::set1(4.f);
+    for (; x + V::width <= end; x += V::width) {
+        const V center = V::load(c + x);
+        const V sum = V::load(c + x - 1) + V::load(c + x + 1) + V::load(up + x) + V::load(dn + x);
+        (center + kv * (sum - four * center)).store(out + x);
+    }
+    return x;
+}
+
+// one row with no-flux borders (outside neighbours mirror the centre)
+void diffuseRow(const float* up, const float* c, const float* dn, float* out, int w, float k) {
+    if (w == 1) {
+        out[0] = c[0] + k * (up[0] + dn[0] - 2.f * c[0]);
+        return;
+    }
+
+    out[0] = c[0] + k * (c[1] + up[0] + dn[0] - 3.f * c[0]);
+    out[w - 1] = c[w - 1] + k * (c[w - 2] + up[w - 1] + dn[w - 1] - 3.f * c[w - 1]);
+
+    const int done = stencil<simd::Float>(up, c, dn, out, 1, w - 1, k);
+    stencil<simd::F1>(up, c, dn, out, done, w - 1, k);
+}
+
+// Backward-Euler diffusion along one axis of n cells with no-flux ends is tridiagonal with
+// constant coefficients; precompute the Thomas algorithm's pivots once per axis
+void implicitCoefficients(int n, float k, float* inv) {
+    for (int i = 0; i < n; ++i) {
+        const float b = 1.f + k * ((i > 0) + (i < n - 1));
+        inv[i] = 1.f / (i > 0 ? b - k * k * inv[i - 1] : b);
+    }
+}
+
+// In-place solve of one row
+void solveRow(float* u, int n, float k, const float* inv) {
+    u[0] *= inv[0];
+    for (int i = 1; i < n; ++i) u[i] = (u[i] + k * u[i - 1]) * inv[i];
+    for (int i = n - 2; i >= 0; --i) u[i] += k * inv[i] * u[i + 1];
+}
+
+// The same solve down columns [x, end), a vector of columns at a time; rows stay contiguous
+template <class V>
+int solveColumns(float* u, int w, int h, int x, int end, float k, const float* inv) {
+    const V kv = V::set1(k);
+    for (; x + V::width <= end; x += V::width) {
+        (V::load(u + x) * V::set1(inv[0])).store(u + x);
+        for (int y = 1; y < h; ++y) {
+            float* row = u + y * w + x;
+            ((V::load(row) + kv * V::load(row - w)) * V::set1(inv[y])).store(row);
+        }
+        for (int y = h - 2; y >= 0; --y) {
+            float* row = u + y * w + x;
+            (V::load(row) + V::set1(k * inv[y]) * V::load(row + w)).store(row);
+        }
+    }
+    return x;
+}
+
+// m' = inflow - loss * max(m, 0) solved exactly over dt: exponential approach to
+// inflow / loss while there is water to evaporate, linear once the tile is in debt
+float evolveMoisture(float m, float inflow, float loss, float dt) {
+    if (loss <= 0.f) return m + inflow * dt;
+    if (m <= 0.f) {
+        const float toZero = inflow > 0.f ? -m / inflow : dt;
+        if (toZero >= dt) return m + inflow * dt;
+        dt -= toZero;
+        m = 0.f;
+    }
+
+    const float target = inflow / loss;
+    if (target >= 0.f) return target + (m - target) * std::exp(-loss * dt);
+    const float toZero = std::log((m - target) / -target) / loss;
+    return toZero >= dt ? target + (m - target) * std::exp(-loss * dt) : inflow * (dt - toZero);
+}
+
+std::uint8_t toByte(float v) {
+    return static_cast<std::uint8_t>(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+}
+}  // namespace
+
+// ----------------------------- soil ----------------------------------
+
+void SoilGrid::resize(int width, int height, float moisture, float nitrogen, float temperature) {
+    w = width;
+    h = height;
+    for (Buffer& b : buffers) {
+        b.moisture.assign(size(), moisture);
+        b.nitrogen.assign(size(), nitrogen);
+        b.temperature.assign(size(), temperature);
+    }
+    current = 0;
+}
+
+const float* SoilGrid::field(Field f) const {
+    const Buffer& b = front();
+    switch (f) {
+        case Field::Moisture:
+            return b.moisture.data();
+        case Field::Nitrogen:
+            return b.nitrogen.data();
+        case Field::Temperature:
+            return b.temperature.data();
+    }
+    return nullptr;
+}
+
+void SoilGrid::addWater(float cx, float cy, float radius, float amount) {
+    const int x0 = std::max(0, static_cast<int>(std::floor(cx - radius)));
+    const int x1 = std::min(w - 1, static_cast<int>(std::ceil(cx + radius)));
+    const int y0 = std::max(0, static_cast<int>(std::floor(cy - radius)));
+    const int y1 = std::min(h - 1, static_cast<int>(std::ceil(cy + radius)));
+
+    float* m = moisture();
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            const float dx = x + 0.5f - cx, dy = y + 0.5f - cy;
+            const float falloff = 1.f - std::sqrt(dx * dx + dy * dy) / std::max(radius, 0.5f);
+            if (falloff > 0.f) m[index(x, y)] = std::min(m[index(x, y)] + amount * falloff, 1.f);
+        }
+    }
+}
+
+void SoilDraw::resize(int tiles, int rows) {
+    moisture.assign(tiles, 0.f);
+    nitrogen.assign(tiles, 0.f);
+    moistureFloor.assign(tiles, 0.f);
+    nitrogenFloor.assign(tiles, 0.f);
+    sleepers.assign(tiles, 0);
+    starved.assign(tiles, 0);
+    starvedRows.assign(rows, 0);
+    anyStarved = false;
+}
+
+void SoilGrid::tick(float dt, SoilDraw* draw) {
+    if (size() == 0) return;
+    TRACE_SCOPE("soil tick");
+
+    if (draw && static_cast<int>(draw->moisture.size()) != size()) draw = nullptr;
+    JobSystem::instance().parallelFor(h, kRowsPerJob, [=, this](int y0, int y1) { tickRows(y0, y1, dt, draw); });
+    current ^= 1;
+
+    if (draw) draw->anyStarved = std::ranges::find(draw->starvedRows, 1) != draw->starvedRows.end();
+}
+
+void SoilGrid::fastForward(float dt, float* moistureDraw) {
+    if (size() == 0) return;
+    TRACE_SCOPE("soil fast-forward");
+
+    diffuseImplicit(front().moisture.data(), params.diffusion * dt);
+    diffuseImplicit(front().nitrogen.data(), params.nitrogenDiffusion * dt);
+    if (moistureDraw) diffuseImplicit(moistureDraw, params.diffusion * dt);
+
+    // sources and sinks in closed form, temperature relaxing exponentially and moisture
+    // evaporating at the step's mean temperature
+    const float decay = std::exp(-params.temperatureRate * dt);
+    const float relaxIntegral = params.temperatureRate > 0.f ? (1.f - decay) / params.temperatureRate : dt;
+    Buffer& b = front();
+    for (int i = 0; i < size(); ++i) {
+        const float t0 = b.temperature[i];
+        const float degreeSeconds = params.ambientTemperature * dt + (t0 - params.ambientTemperature) * relaxIntegral;
+        const float loss = params.evaporation * std::max(degreeSeconds, 0.f) / dt;
+        const float inflow = params.rainRate - (moistureDraw ? moistureDraw[i] / dt : 0.f);
+        b.moisture[i] = std::min(evolveMoisture(b.moisture[i], inflow, loss, dt), 1.f);
+        b.temperature[i] = params.ambientTemperature + (t0 - params.ambientTemperature) * decay;
+
+        // a long absence decays dry tiles towards denormals, which stall the solver
+        if (std::fabs(b.moisture[i]) < kNegligible) b.moisture[i] = 0.f;
+        if (std::fabs(b.nitrogen[i]) < kNegligible) b.nitrogen[i] = 0.f;
+    }
+}
+
+void SoilGrid::diffuseLikeMoisture(float* values, float dt, bool transposed) {
+    diffuseImplicit(values, params.diffusion * dt, transposed);
+}
+
+void SoilGrid::diffuseImplicit(float* u, float k, bool transposed) {
+    if (k <= 0.f) return;
+    std::vector<float> invX(w), invY(h);
+    implicitCoefficients(w, k, invX.data());
+    implicitCoefficients(h, k, invY.data());
+
+    // each axis pass conserves its lines' sums, so the split conserves mass too
+    auto rows = [&] {
+        JobSystem::instance().parallelFor(h, kRowsPerJob, [&](int y0, int y1) {
+            for (int y = y0; y < y1; ++y) solveRow(u + y * w, w, k, invX.data());
+        });
+    };
+    auto columns = [&] {
+        JobSystem::instance().parallelFor(w, kColumnsPerJob, [&](int x0, int x1) {
+            const int done = solveColumns<simd::Float>(u, w, h, x0, x1, k, invY.data());
+            solveColumns<simd::F1>(u, w, h, done, x1, k, invY.data());
+        });
+    };
+
+    // both axis solves are symmetric, so swapping their order gives the transpose
+    if (transposed) {
+        columns();
+        rows();
+    } else {
+        rows();
+        columns();
+    }
+}
+
+void SoilGrid::tickRows(int y0, int y1, float dt, SoilDraw* draw) {
+    const Buffer& src = front();
+    Buffer& dst = back();
+
+    // explicit diffusion is only stable up to k = 0.25
+    const float km = std::min(params.diffusion * dt, 0.25f);
+    const float kn = std::min(params.nitrogenDiffusion * dt, 0.25f);
+    const float evaporation = params.evaporation * dt;
+    const float rain = params.rainRate * dt;
+    const float relax = std::min(params.temperatureRate * dt, 1.f);
+
+    for (int y = y0; y < y1; ++y) {
+        const int row = y * w;
+        const int up = y > 0 ? row - w : row;
+        const int dn = y < h - 1 ? row + w : row;
+
+        diffuseRow(&src.moisture[up], &src.moisture[row], &src.moisture[dn], &dst.moisture[row], w, km);
+        diffuseRow(&src.nitrogen[up], &src.nitrogen[row], &src.nitrogen[dn], &dst.nitrogen[row], w, kn);
+
+        // local sources and sinks
+        for (int i = row; i < row + w; ++i) {
+            const float t = src.temperature[i];
+            const float m = dst.moisture[i] * (1.f - evaporation * std::max(t, 0.f)) + rain;
+            dst.moisture[i] = std::clamp(m, 0.f, 1.f);
+            dst.temperature[i] = t + (params.ambientTemperature - t) * relax;
+        }
+
+        if (!draw) continue;
+        for (int i = row; i < row + w; ++i) {
+            if (draw->sleepers[i] == 0) continue;
+            if (dst.moisture[i] < draw->moistureFloor[i] || dst.nitrogen[i] < draw->nitrogenFloor[i]) {
+                draw->starved[i] = 1;
+                draw->starvedRows[y] = 1;
+            }
+            dst.moisture[i] = std::max(dst.moisture[i] - draw->moisture[i] * dt, 0.f);
+            dst.nitrogen[i] = std::max(dst.nitrogen[i] - draw->nitrogen[i] * dt, 0.f);
+        }
+    }
+}
+
+void SoilGrid::writeHeatmap(Field f, std::uint8_t* rgba) const {
+    const float* values = field(f);
+    for (int y = 0; y < h; ++y) {
+        std::uint8_t* px = rgba + static_cast<std::size_t>(h - 1 - y) * w * 4;
+        for (int x = 0; x < w; ++x, px += 4) {
+            const float v = values[index(x, y)];
+            switch (f) {
+                case Field::Moisture:  // dry sand -> deep blue
+                    px[0] = toByte(0.8f - 0.7f * v);
+                    px[1] = toByte(0.7f - 0.4f * v);
+                    px[2] = toByte(0.3f + 0.7f * v);
+                    break;
+                case Field::Nitrogen:  // pale -> rich green
+                    px[0] = toByte(0.9f - 0.8f * v);
+                    px[1] = toByte(0.5f + 0.5f * v);
+                    px[2] = toByte(0.2f);
+                    break;
+                case Field::Temperature: {  // 0..40 C, blue -> red
+                    const float t = v / 40.f;
+                    px[0] = toByte(t);
+                    px[1] = toByte(0.2f);
+                    px[2] = toByte(1.f - t);
+                    break;
+                }
+            }
+            px[3] = 160;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+struct SoilParams {
+    float diffusion = 0.4f;           // moisture spread, tiles^2 per second
+    float nitrogenDiffusion = 0.02f;  // nitrogen spreads far slower than water
+    float evaporation = 0.0005f;      // fraction of moisture lost per second per degree above 0
+    float rainRate = 0.f;             // moisture added per second everywhere
+    float ambientTemperature = 18.f;  // degrees C the soil relaxes towards
+    float temperatureRate = 0.05f;    // fraction per second
+};
+
+// What sleeping plants take from each tile, per second. The soil tick applies it, so a
+// sleeping plant needs no per-tick work of its own, and flags tiles that fall below the
+// level those plants need to keep drawing that much.
+struct SoilDraw {
+    std::vector<float> moisture;
+    std::vector<float> nitrogen;
+    std::vector<float> moistureFloor;
+    std::vector<float> nitrogenFloor;
+    std::vector<std::uint16_t> sleepers;
+    std::vector<std::uint8_t> starved;      // per tile, set by the tick
+    std::vector<std::uint8_t> starvedRows;  // per row, so bands never share a flag
+    bool anyStarved = false;
+
+    void resize(int tiles, int rows);
+};
+
+// Per-tile soil model. Fields are double-buffered: a tick reads the front buffer and
+// writes the back one, so bands of rows can run on different workers without races.
+class SoilGrid {
+   public:
+    enum class Field { Moisture, Nitrogen, Temperature };
+
+    void resize(int w, int h, float moisture = 0.5f, float nitrogen = 0.5f, float temperature = 18.f);
+    int width() const { return w; }
+    int height() const { return h; }
+    int size() const { return w * h; }
+    int index(int x, int y) const { return y * w + x; }
+
+    const float* field(Field f) const;
+    float* moisture() { return front().moisture.data(); }
+    float* nitrogen() { return front().nitrogen.data(); }
+    float* temperature() { return front().temperature.data(); }
+
+    // Watering can: adds water with a soft falloff around (cx, cy), in tiles
+    void addWater(float cx, float cy, float radius, float amount);
+
+    // draw (optional) is taken out after the tick's own sources and sinks
+    void tick(float dt, SoilDraw* draw = nullptr);
+
+    // Coarse step for offline catch-up, stable for any dt: implicit diffusion and
+    // closed-form evaporation/rain/temperature. moistureDraw (optional) is the water
+    // plants take from each tile over dt; it is diffused in place, and tiles it drains
+    // past empty are left negative for the caller to settle.
+    void fastForward(float dt, float* moistureDraw = nullptr);
+    // Apply fastForward's moisture diffusion to another field, or its transpose, so
+    // catch-up can trace the water a tile went short of back to the tiles that drew it
+    void diffuseLikeMoisture(float* values, float dt, bool transposed = false);
+
+    // RGBA8, one pixel per tile, row 0 at the bottom (GL texture order)
+    void writeHeatmap(Field f, std::uint8_t* rgba) const;
+
+    SoilParams params;
+
+   private:
+    struct Buffer {
+        std::vector<float> moisture;
+        std::vector<float> nitrogen;
+        std::vector<float> temperature;
+    };
+
+    Buffer& front() { return buffers[current]; }
+    const Buffer& front() const { return buffers[current]; }
+    Buffer& back() { return buffers[current ^ 1]; }
+
+    void tickRows(int y0, int y1, float dt, SoilDraw* draw);
+    void diffuseImplicit(float* field, float k, bool transposed = false);
+
+    int w = 0, h = 0;
+    Buffer buffers[2];
+    int current = 0;
+};
@@ -0,0 +1,319 @@
+#include "spatial.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+bool circleOverlaps(Rect r, Vec2 c, float radius) {
+    const Vec2 nearest{std::clamp(c.x, r.x, r.x + r.w), std::clamp(c.y, r.y, r.y + r.h)};
+    return lengthSquared(c - nearest) <= radius * radius;
+}
+
+// overlaps(), but rects that only touch (or have no area) count
+bool touches(Rect a, Rect b) {
+    return a.x <= b.x + b.w && b.x <= a.x + a.w && a.y <= b.y + b.h && b.y <= a.y + a.h;
+}
+
+std::uint32_t hashCell(int x, int y) {
+    return (static_cast<std::uint32_t>(x) * 0x8da6b343u) ^ (static_cast<std::uint32_t>(y) * 0xd8163841u);
+}
+}  // namespace
+
+// ----------------------------- spatial hash ---------------------------
+
+SpatialHash::SpatialHash(float cellSize) : invCellSize(1.f / cellSize), cells(64) {}
+
+SpatialHash::CellRange SpatialHash::cellsOf(Rect r) const {
+    return {static_cast<int>(std::floor(r.x * invCellSize)), static_cast<int>(std::floor(r.y * invCellSize)),
+            static_cast<int>(std::floor((r.x + r.w) * invCellSize)),
+            static_cast<int>(std::floor((r.y + r.h) * invCellSize))};
+}
+
+std::uint32_t& SpatialHash::head(int x, int y) {
+    // keep the table at most half full so probe runs stay short
+    if (2 * (usedCells + 1) > static_cast<int>(cells.size())) grow();
+
+    const std::size_t mask = cells.size() - 1;
+    for (std::size_t i = hashCell(x, y) & mask;; i = (i + 1) & mask) {
+        Cell& c = cells[i];
+        if (!c.used) {
+            c = {x, y, kNone, true};
+            ++usedCells;
+            return c.head;
+        }
+        if (c.x == x && c.y == y) return c.head;
+    }
+}
+
+std::uint32_t SpatialHash::findHead(int x, int y) const {
+    const std::size_t mask = cells.size() - 1;
+    for (std::size_t i = hashCell(x, y) & mask;; i = (i + 1) & mask) {
+        const Cell& c = cells[i];
+        if (!c.used) return kNone;
+        if (c.x == x && c.y == y) return c.head;
+    }
+}
+
+void SpatialHash::grow() {
+    std::vector<Cell> old(cells.size() * 2);
+    old.swap(cells);
+    const std::size_t mask = cells.size() - 1;
+    for (const Cell& c : old) {
+        if (!c.used) continue;
+        std::size_t i = hashCell(c.x, c.y) & mask;
+        while (cells[i].used) i = (i + 1) & mask;
+        cells[i] = c;
+    }
+}
+
+void SpatialHash::link(std::uint32_t id, const CellRange& range) {
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            std::uint32_t& first = head(x, y);
+            std::uint32_t n = freeNodes;
+            if (n != kNone) {
+                freeNodes = nodes[n].next;
+            } else {
+                n = static_cast<std::uint32_t>(nodes.size());
+                nodes.emplace_back();
+            }
+            nodes[n] = {id, first};
+            first = n;
+        }
+    }
+}
+
+void SpatialHash::unlink(std::uint32_t id, const CellRange& range) {
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            std::uint32_t* link = &head(x, y);
+            while (*link != kNone && nodes[*link].id != id) link = &nodes[*link].next;
+            if (*link == kNone) continue;
+            const std::uint32_t n = *link;
+            *link = nodes[n].next;
+            nodes[n].next = freeNodes;
+            freeNodes = n;
+        }
+    }
+}
+
+void SpatialHash::insert(std::span<const SpatialEntry> entries) {
+    std::uint32_t maxId = 0;
+    for (const SpatialEntry& e : entries) maxId = std::max(maxId, e.id);
+    if (!entries.empty() && maxId >= items.size()) items.resize(maxId + 1);
+
+    for (const SpatialEntry& e : entries) {
+        Item& item = items[e.id];
+        if (item.live) {
+            update({&e, 1});
+            continue;
+        }
+        item = {e.bounds, cellsOf(e.bounds), true};
+        link(e.id, item.cells);
+        ++count;
+    }
+}
+
+void SpatialHash::update(std::span<const SpatialEntry> entries) {
+    for (const SpatialEntry& e : entries) {
+        Item& item = items[e.id];
+        const CellRange range = cellsOf(e.bounds);
+        if (range != item.cells) {
+            unlink(e.id, item.cells);
+            link(e.id, range);
+            item.cells = range;
+        }
+        item.bounds = e.bounds;
+    }
+}
+
+void SpatialHash::remove(std::span<const std::uint32_t> ids) {
+    for (std::uint32_t id : ids) {
+        if (!contains(id)) continue;
+        unlink(id, items[id].cells);
+        items[id].live = false;
+        --count;
+    }
+}
+
+void SpatialHash::clear() {
+    items.clear();
+    nodes.clear();
+    freeNodes = kNone;
+    cells.assign(64, {});
+    usedCells = 0;
+    count = 0;
+}
+
+template <class Test>
+void SpatialHash::visit(const CellRange& range, Test&& test, std::vector<std::uint32_t>& out) const {
+    for (int y = range.y0; y <= range.y1; ++y) {
+        for (int x = range.x0; x <= range.x1; ++x) {
+            for (std::uint32_t n = findHead(x, y); n != kNone; n = nodes[n].next) {
+                const std::uint32_t id = nodes[n].id;
+                const Item& item = items[id];
+                // an entry in several cells is reported from the first one the range shares with it
+                if (x != std::max(item.cells.x0, range.x0) || y != std::max(item.cells.y0, range.y0)) continue;
+                if (test(item.bounds)) out.push_back(id);
+            }
+        }
+    }
+}
+
+void SpatialHash::query(Rect area, std::vector<std::uint32_t>& out) const {
+    visit(cellsOf(area), [&](Rect b) { return overlaps(b, area); }, out);
+}
+
+void SpatialHash::queryPoint(Vec2 p, std::vector<std::uint32_t>& out) const {
+    visit(cellsOf({p.x, p.y, 0.f, 0.f}), [&](Rect b) { return ::contains(b, p); }, out);
+}
+
+void SpatialHash::queryRadius(Vec2 center, float radius, std::vector<std::uint32_t>& out) const {
+    const Rect reach{center.x - radius, center.y - radius, 2.f * radius, 2.f * radius};
+    visit(cellsOf(reach), [&](Rect b) { return circleOverlaps(b, center, radius); }, out);
+}
+
+// ----------------------------- loose quadtree -------------------------
+
+LooseQuadtree::LooseQuadtree(Rect world, int depth)
+    : world(world), rootSize(std::max(world.w, world.h)), depth(std::clamp(depth, 1, 12)) {
+    std::uint32_t total = 0;
+    for (int l = 0; l < this->depth; ++l) {
+        levelStart.push_back(total);
+        total += 1u << (2 * l);
+    }
+    levelStart.push_back(total);
+    nodes.resize(total);
+}
+
+std::uint32_t LooseQuadtree::nodeFor(Rect r) const {
+    const float extent = std::max(r.w, r.h);
+    const Vec2 c = center(r) - Vec2{world.x, world.y};
+    const bool inside = c.x >= 0.f && c.x < rootSize && c.y >= 0.f && c.y < rootSize;
+    if (!inside || !(extent <= rootSize)) return 0;
+
+    // deepest level whose cells still hold it
+    int level = depth - 1;
+    if (extent > 0.f) level = std::min(level, static_cast<int>(std::floor(std::log2(rootSize / extent))));
+    if (rootSize / static_cast<float>(1 << level) < extent) --level;  // log2 rounding
+    if (level <= 0) return 0;
+
+    const float cell = rootSize / static_cast<float>(1 << level);
+    const int last = (1 << level) - 1;
+    return nodeAt(level, std::min(static_cast<int>(c.x / cell), last), std::min(static_cast<int>(c.y / cell), last));
+}
+
+void LooseQuadtree::addToPath(std::uint32_t node, int delta) {
+    int level = 0;
+    while (node >= levelStart[level + 1]) ++level;
+    const std::uint32_t offset = node - levelStart[level];
+    int x = static_cast<int>(offset & ((1u << level) - 1));
+    int y = static_cast<int>(offset >> level);
+    for (; level >= 0; --level, x >>= 1, y >>= 1) nodes[nodeAt(level, x, y)].subtree += delta;
+}
+
+void LooseQuadtree::link(std::uint32_t id, std::uint32_t node) {
+    Item& item = items[id];
+    item.node = node;
+    item.prev = kNone;
+    item.next = nodes[node].head;
+    if (item.next != kNone) items[item.next].prev = id;
+    nodes[node].head = id;
+    addToPath(node, 1);
+}
+
+void LooseQuadtree::unlink(std::uint32_t id) {
+    Item& item = items[id];
+    if (item.prev != kNone)
+        items[item.prev].next = item.next;
+    else
+        nodes[item.node].head = item.next;
+    if (item.next != kNone) items[item.next].prev = item.prev;
+    addToPath(item.node, -1);
+    item.node = kNone;
+}
+
+void LooseQuadtree::insert(std::span<const SpatialEntry> entries) {
+    std::uint32_t maxId = 0;
+    for (const SpatialEntry& e : entries) maxId = std::max(maxId, e.id);
+    if (!entries.empty() && maxId >= items.size()) items.resize(maxId + 1);
+
+    for (const SpatialEntry& e : entries) {
+        if (contains(e.id)) {
+            update({&e, 1});
+            continue;
+        }
+        items[e.id].bounds = e.bounds;
+        link(e.id, nodeFor(e.bounds));
+        ++count;
+    }
+}
+
+void LooseQuadtree::update(std::span<const SpatialEntry> entries) {
+    for (const SpatialEntry& e : entries) {
+        const std::uint32_t node = nodeFor(e.bounds);
+        if (node != items[e.id].node) {
+            unlink(e.id);
+            link(e.id, node);
+        }
+        items[e.id].bounds = e.bounds;
+    }
+}
+
+void LooseQuadtree::remove(std::span<const std::uint32_t> ids) {
+    for (std::uint32_t id : ids) {
+        if (!contains(id)) continue;
+        unlink(id);
+        --count;
+    }
+}
+
+void LooseQuadtree::clear() {
+    items.clear();
+    std::fill(nodes.begin(), nodes.end(), Node{});
+    count = 0;
+}
+
+template <class Test>
+void LooseQuadtree::visit(Rect reach, Test&& test, std::vector<std::uint32_t>& out) const {
+    struct Pending {
+        int level, x, y;
+    };
+    Pending stack[4 * 12];  // at most three siblings waiting per level, plus the current path
+    int top = 0;
+    stack[top++] = {0, 0, 0};
+
+    while (top > 0) {
+        const Pending p = stack[--top];
+        const Node& node = nodes[nodeAt(p.level, p.x, p.y)];
+        if (node.subtree == 0) continue;
+
+        // the root also holds whatever is outside the world, so it is always searched
+        if (p.level > 0) {
+            const float cell = rootSize / static_cast<float>(1 << p.level);
+            const Rect loose{world.x + (static_cast<float>(p.x) - 0.5f) * cell,
+                             world.y + (static_cast<float>(p.y) - 0.5f) * cell, 2.f * cell, 2.f * cell};
+            if (!touches(loose, reach)) continue;
+        }
+
+        for (std::uint32_t id = node.head; id != kNone; id = items[id].next)
+            if (test(items[id].bounds)) out.push_back(id);
+
+        if (p.level + 1 == depth) continue;
+        for (int child = 0; child < 4; ++child)
+            stack[top++] = {p.level + 1, 2 * p.x + (child & 1), 2 * p.y + (child >> 1)};
+    }
+}
+
+void LooseQuadtree::query(Rect area, std::vector<std::uint32_t>& out) const {
+    visit(area, [&](Rect b) { return overlaps(b, area); }, out);
+}
+
+void LooseQuadtree::queryPoint(Vec2 p, std::vector<std::uint32_t>& out) const {
+    visit({p.x, p.y, 0.f, 0.f}, [&](Rect b) { return ::contains(b, p); }, out);
+}
+
+void LooseQuadtree::queryRadius(Vec2 center, float radius, std::vector<std::uint32_t>& out) const {
+    const Rect reach{center.x - radius, center.y - radius, 2.f * radius, 2.f * radius};
+    visit(reach, [&](Rect b) { return circleOverlaps(b, center, radius); }, out);
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "util.h"
+
+// Something placed in a spatial index. Ids are the caller's and should be small and
+// dense (a slot or tile index): the indexes keep per-id arrays sized to the largest one.
+struct SpatialEntry {
+    std::uint32_t id;
+    Rect bounds;
+};
+
+// Uniform grid hashed by cell coordinate, for many similar-sized things spread over an
+// unbounded world (tiles, crops). An entry is linked into every cell its bounds touch,
+// so it suits entries no bigger than a cell or two. Moving within the same cells only
+// rewrites the bounds.
+//
+// Queries append the ids of the overlapping entries to out, each once, in no
+// particular order; out is not cleared.
+class SpatialHash {
+   public:
+    explicit SpatialHash(float cellSize);
+
+    void insert(std::span<const SpatialEntry> entries);
+    void update(std::span<const SpatialEntry> entries);  // entries must be present
+    void remove(std::span<const std::uint32_t> ids);     // absent ids are ignored
+    void insert(std::uint32_t id, Rect bounds) {
+        const SpatialEntry e{id, bounds};
+        insert({&e, 1});
+    }
+    void update(std::uint32_t id, Rect bounds) {
+        const SpatialEntry e{id, bounds};
+        update({&e, 1});
+    }
+    void remove(std::uint32_t id) { remove({&id, 1}); }
+    void clear();
+
+    int size() const { return count; }
+    bool contains(std::uint32_t id) const { return id < items.size() && items[id].live; }
+
+    void query(Rect area, std::vector<std::uint32_t>& out) const;
+    void queryPoint(Vec2 p, std::vector<std::uint32_t>& out) const;
+    void queryRadius(Vec2 center, float radius, std::vector<std::uint32_t>& out) const;
+
+   private:
+    static constexpr std::uint32_t kNone = ~0u;
+
+    struct CellRange {
+        int x0, y0, x1, y1;
+        bool operator==(const CellRange&) const = default;
+    };
+    struct Item {
+        Rect bounds;
+        CellRange cells;
+        bool live = false;
+    };
+    struct Node {
+        std::uint32_t id;
+        std::uint32_t next;
+    };
+    // Open-addressed table of the cells ever used; emptied cells keep their slot
+    struct Cell {
+        int x, y;
+        std::uint32_t head = kNone;
+        bool used = false;
+    };
+
+    CellRange cellsOf(Rect r) const;
+    std::uint32_t& head(int x, int y);
+    std::uint32_t findHead(int x, int y) const;
+    void link(std::uint32_t id, const CellRange& cells);
+    void unlink(std::uint32_t id, const CellRange& cells);
+    void grow();
+
+    template <class Test>
+    void visit(const CellRange& range, Test&& test, std::vector<std::uint32_t>& out) const;
+
+    float invCellSize;
+    std::vector<Item> items;  // by id
+    std::vector<Node> nodes;
+    std::uint32_t freeNodes = kNone;
+    std::vector<Cell> cells;  // power-of-two size
+    int usedCells = 0;
+    int count = 0;
+};
+
+// Loose quadtree over a fixed world rect, for sparse things of very different sizes
+// (critters, tools, effects). Each entry sits in exactly one node: the one at the
+// deepest level whose cells are at least as big as it, under its center. Nodes reach
+// half a cell past their own cell, so an entry always fits the node it is in and
+// moving only relinks it when its center crosses a cell. Queries skip empty subtrees.
+//
+// The tree is implicit (every level is a full grid), so depth is limited: 8 levels is
+// 21845 nodes. Entries bigger than the world or centered outside it live in the root,
+// which every query looks at.
+class LooseQuadtree {
+   public:
+    explicit LooseQuadtree(Rect world, int depth = 8);
+
+    void insert(std::span<const SpatialEntry> entries);
+    void update(std::span<const SpatialEntry> entries);  // entries must be present
+    void remove(std::span<const std::uint32_t> ids);     // absent ids are ignored
+    void insert(std::uint32_t id, Rect bounds) {
+        const SpatialEntry e{id, bounds};
+        insert({&e, 1});
+    }
+    void update(std::uint32_t id, Rect bounds) {
+        const SpatialEntry e{id, bounds};
+        update({&e, 1});
+    }
+    void remove(std::uint32_t id) { remove({&id, 1}); }
+    void clear();
+
+    int size() const { return count; }
+    bool contains(std::uint32_t id) const { return id < items.size() && items[id].node != kNone; }
+
+    // Same contract as SpatialHash's
+    void query(Rect area, std::vector<std::uint32_t>& out) const;
+    void queryPoint(Vec2 p, std::vector<std::uint32_t>& out) const;
+    void queryRadius(Vec2 center, float radius, std::vector<std::uint32_t>& out) const;
+
+   private:
+    static constexpr std::uint32_t kNone = ~0u;
+
+    struct Item {
+        Rect bounds;
+        std::uint32_t node = kNone;
+        std::uint32_t prev = kNone, next = kNone;  // within the node
+    };
+    struct Node {
+        std::uint32_t head = kNone;
+        std::uint32_t subtree = 0;  // entries in this node and below
+    };
+
+    std::uint32_t nodeFor(Rect r) const;
+    std::uint32_t nodeAt(int level, int x, int y) const {
+        return levelStart[level] + static_cast<std::uint32_t>(y << level) + static_cast<std::uint32_t>(x);
+    }
+    void link(std::uint32_t id, std::uint32_t node);
+    void unlink(std::uint32_t id);
+    void addToPath(std::uint32_t node, int delta);  // node and all its ancestors
+
+    template <class Test>
+    void visit(Rect reach, Test&& test, std::vector<std::uint32_t>& out) const;
+
+    Rect world;
+    float rootSize;  // side of the root cell (the world's larger side)
+    int depth;
+    std::vector<std::uint32_t> levelStart;  // first node of each level; level l is 2^l x 2^l
+    std::vector<Node> nodes;
+    std::vector<Item> items;  // by id
+    int count = 0;
+};
@@ -0,0 +1,35 @@
+#include "sprite_batch.h"
+
+void SpriteBatch::add(unsigned int texture, Rect r, Rect uv, Color tint, bool distanceField) {
+    texture_ = texture;
+    array_ = false;
+    push(r, uv, tint, distanceField ? 1.f : 0.f, 0.f);
+}
+
+void SpriteBatch::addLayer(unsigned int textureArray, int layer, Rect r, Rect uv, Color tint) {
+    texture_ = textureArray;
+    array_ = true;
+    push(r, uv, tint, 0.f, static_cast<float>(layer));
+}
+
+void SpriteBatch::push(Rect r, Rect uv, Color tint, float distanceField, float layer) {
+    if (vertices_.capacity() == 0) vertices_.reserve(4 * kMaxSprites);
+    if (pixelToClip.x == 0.f) return;
+
+    // window pixels from the top left, 1:1 like the UI's quads
+    const Vec2 scale = Vec2{r.w, r.h} * pixelToClip;
+    const Vec2 pos = Vec2{-1.f, 1.f - scale.y} + Vec2{r.x, -r.y} * pixelToClip;
+
+    // corners in the quad VBO's order (RT, RB, LB, LT), so its index pattern applies
+    const float x0 = pos.x, x1 = pos.x + scale.x;
+    const float y0 = pos.y, y1 = pos.y + scale.y;
+    const float u0 = uv.x, u1 = uv.x + uv.w;
+    const float v0 = uv.y, v1 = uv.y + uv.h;
+    const std::size_t at = vertices_.size();
+    vertices_.resize(at + 4);
+    Vertex* v = &vertices_[at];
+    v[0] = {x1, y1, u1, v1, tint, distanceField, layer};
+    v[1] = {x1, y0, u1, v0, tint, distanceField, layer};
+    v[2] = {x0, y0, u0, v0, tint, distanceField, layer};
+    v[3] = {x0, y1, u0, v1, tint, distanceField, layer};
+}
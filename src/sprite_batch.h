@@ -0,0 +1,56 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "util.h"
+
+// CPU side of the renderer's sprite batch (Renderer::drawSprite, drawText): textured
+// quads with their own UV sub-rect and tint, already in clip space, waiting for one
+// draw call.
+// Only quads sharing a texture batch together; the renderer flushes on a texture
+// change or a full batch. A texture array counts as one texture whatever the layer,
+// so sprites from all its layers batch together.
+class SpriteBatch {
+   public:
+    static constexpr int kMaxSprites = 8192;
+
+    struct Vertex {
+        float x, y;  // clip space
+        float u, v;
+        Color tint;
+        float distanceField;  // 1: the texture's alpha is a signed distance (Font, FontMode::Sdf)
+        float layer = 0.f;    // in a texture array (addLayer)
+    };
+
+    // Window size in pixels that add() maps rects from
+    void setViewport(Vec2 size) {
+        pixelToClip = (size.x > 0.f && size.y > 0.f) ? Vec2{2.f / size.x, 2.f / size.y} : Vec2{0.f, 0.f};
+    }
+
+    // Whether a sprite with this texture can join the batch without a flush first
+    bool accepts(unsigned int texture) const {
+        return empty() || (texture == texture_ && count() < kMaxSprites);
+    }
+
+    // r is in window pixels from the top left; uv is {u, v, width, height} in texture
+    // coordinates, v up (FlipbookAtlas::frameUV)
+    void add(unsigned int texture, Rect r, Rect uv, Color tint, bool distanceField = false);
+    // The same from one layer of a TextureArray
+    void addLayer(unsigned int textureArray, int layer, Rect r, Rect uv, Color tint);
+    void clear() { vertices_.clear(); }
+
+    std::span<const Vertex> vertices() const { return vertices_; }  // four per sprite
+    unsigned int texture() const { return texture_; }
+    bool isArray() const { return array_; }  // texture() is a GL_TEXTURE_2D_ARRAY
+    int count() const { return static_cast<int>(vertices_.size() / 4); }
+    bool empty() const { return vertices_.empty(); }
+
+   private:
+    void push(Rect r, Rect uv, Color tint, float distanceField, float layer);
+
+    std::vector<Vertex> vertices_;
+    unsigned int texture_ = 0;
+    bool array_ = false;
+    Vec2 pixelToClip = {0.f, 0.f};  // 0 while the window has no size
+};
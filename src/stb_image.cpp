@@ -1,2 +1,11 @@
+#include "alloc_tracker.h"
+
+// decoded pixels count as textures in the tracking build, whoever asked for them
+#if ENABLE_ALLOC_TRACKING
+#define STBI_MALLOC(size) HeapTracking::allocate(size, AllocTag::Textures)
+#define STBI_REALLOC(p, size) HeapTracking::reallocate(p, size)
+#define STBI_FREE(p) HeapTracking::release(p)
+#endif
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
\ No newline at end of file
@@ -2,9 +2,56 @@
 
 #include <stb_image.h>
 
+#include <print>
 #include <stdexcept>
 
+#include "alloc_tracker.h"
+#include "trace.h"
+
+namespace {
+// upload format for 8-bit pixels with this many channels
+GLenum formatFor(int channels) {
+    return channels == 4 ? GL_RGBA : channels == 3 ? GL_RGB : channels == 2 ? GL_RG : GL_RED;
+}
+}  // namespace
+
+bool Image::load(const char* path) {
+    TRACE_SCOPE("image decode");
+    ALLOC_TAG(Textures);
+
+    reset();
+
+    // per-thread flag: images may be decoded on several workers at once
+    stbi_set_flip_vertically_on_load_thread(1);  // optional, if your UVs expect top-left origin
+    pixels_ = stbi_load(path, &w_, &h_, &channels_, 0);
+    if (!pixels_) throw std::runtime_error(std::string("stbi_load failed: ") + path);
+
+    return true;
+}
+
+void Image::reset() {
+    if (pixels_) {
+        stbi_image_free(pixels_);
+        pixels_ = nullptr;
+        w_ = h_ = channels_ = 0;
+    }
+}
+
 bool Texture::load(const char* path) {
+    TRACE_SCOPE("texture load");
+    ALLOC_TAG(Textures);
+
+    // Load pixels
+    Image image(path);
+    return upload(image);
+}
+
+bool Texture::upload(const Image& image) {
+    TRACE_SCOPE("texture upload");
+    ALLOC_TAG(Textures);
+
+    if (!image) return false;
+
     // (Re)create GL object
     if (id_ == 0) glGenTextures(1, &id_);
     glBindTexture(GL_TEXTURE_2D, id_);
@@ -15,32 +62,107 @@ bool Texture::load(const char* path) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 
-    // Load pixels
-    stbi_set_flip_vertically_on_load(1);  // optional, if your UVs expect top-left origin
-    unsigned char* pixels = stbi_load(path, &w_, &h_, &channels_, 0);
-    if (!pixels) {
-        glBindTexture(GL_TEXTURE_2D, 0);
-        throw std::runtime_error(std::string("stbi_load failed: ") + path);
-    }
+    w_ = image.width();
+    h_ = image.height();
+    channels_ = image.channels();
 
-    // Pick correct format
-    GLenum fmt = (channels_ == 4)   ? GL_RGBA
-                 : (channels_ == 3) ? GL_RGB
-                 : (channels_ == 2) ? GL_RG
-                                    : GL_RED;
+    const GLenum fmt = formatFor(channels_);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, fmt, w_, h_, 0, fmt, GL_UNSIGNED_BYTE, pixels);
+    glTexImage2D(GL_TEXTURE_2D, 0, fmt, w_, h_, 0, fmt, GL_UNSIGNED_BYTE, image.pixels());
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    stbi_image_free(pixels);
     glBindTexture(GL_TEXTURE_2D, 0);
     return true;
 }
 
+bool Texture::create(int w, int h, int channels) {
+    if (id_ == 0) glGenTextures(1, &id_);
+    glBindTexture(GL_TEXTURE_2D, id_);
+
+    // no mipmaps: they would have to be rebuilt on every update
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    w_ = w;
+    h_ = h;
+    channels_ = channels;
+
+    const GLenum fmt = formatFor(channels_);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, fmt, w_, h_, 0, fmt, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+void Texture::update(const void* pixels) {
+    if (!id_) return;
+
+    const GLenum fmt = formatFor(channels_);
+
+    glBindTexture(GL_TEXTURE_2D, id_);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w_, h_, fmt, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture::destroy() {
     if (id_) {
         glDeleteTextures(1, &id_);
         id_ = 0;
         w_ = h_ = channels_ = 0;
     }
-}
\ No newline at end of file
+}
+
+bool TextureArray::create(int w, int h, int layers) {
+    if (w <= 0 || h <= 0 || layers <= 0) return false;
+    if (id_ == 0) glGenTextures(1, &id_);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id_);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    w_ = w;
+    h_ = h;
+    layers_ = layers;
+
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, w_, h_, layers_, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return true;
+}
+
+bool TextureArray::setLayer(int layer, const Image& image) {
+    if (!image) return false;
+    if (image.width() != w_ || image.height() != h_) {
+        std::println(stderr, "texture array layer {}: image is {}x{}, the array {}x{}", layer, image.width(),
+                     image.height(), w_, h_);
+        return false;
+    }
+    return setLayer(layer, image.pixels(), formatFor(image.channels()));
+}
+
+bool TextureArray::setLayer(int layer, const void* rgba) {
+    return setLayer(layer, rgba, GL_RGBA);
+}
+
+bool TextureArray::setLayer(int layer, const void* pixels, GLenum format) {
+    if (!id_ || layer < 0 || layer >= layers_) return false;
+
+    // tightly packed rows, whatever the channel count
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, id_);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, w_, h_, 1, format, GL_UNSIGNED_BYTE, pixels);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    return true;
+}
+
+void TextureArray::destroy() {
+    if (id_) {
+        glDeleteTextures(1, &id_);
+        id_ = 0;
+        w_ = h_ = layers_ = 0;
+    }
+}
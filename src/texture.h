@@ -5,6 +5,43 @@
 #include <string>
 #include <utility>
 
+// Decoded pixels in CPU memory. Loading touches no GL state, so it is safe on worker threads.
+class Image {
+   public:
+    Image() = default;
+    explicit Image(const char* path) { load(path); }
+    ~Image() { reset(); }
+
+    // non-copyable, movable
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    Image(Image&& other) noexcept { *this = std::move(other); }
+    Image& operator=(Image&& other) noexcept {
+        if (this != &other) {
+            reset();
+            pixels_ = std::exchange(other.pixels_, nullptr);
+            w_ = other.w_;
+            h_ = other.h_;
+            channels_ = other.channels_;
+        }
+        return *this;
+    }
+
+    bool load(const char* path);
+    void reset();
+
+    const unsigned char* pixels() const { return pixels_; }
+    int width() const { return w_; }
+    int height() const { return h_; }
+    int channels() const { return channels_; }
+    explicit operator bool() const { return pixels_ != nullptr; }
+
+   private:
+    unsigned char* pixels_ = nullptr;
+    int w_ = 0, h_ = 0, channels_ = 0;
+};
+
 class Texture {
    public:
     Texture() = default;
@@ -31,6 +68,11 @@ class Texture {
     }
 
     bool load(const char* path);
+    bool upload(const Image& image);  // main thread only
+
+    // Streamed texture: allocate once, then replace the pixels every frame
+    bool create(int w, int h, int channels = 4);
+    void update(const void* pixels);
     void destroy();
 
     GLuint id() const { return id_; }
@@ -42,4 +84,49 @@ class Texture {
    private:
     GLuint id_ = 0;
     int w_ = 0, h_ = 0, channels_ = 0;
-};
\ No newline at end of file
+};
+
+// Same-sized images as the layers of one GL_TEXTURE_2D_ARRAY: sprites drawn from any of
+// its layers share a batch (Renderer::drawSprite with a layer), where separate textures
+// would flush it on every switch. Linear filtering, no mipmaps. Main thread only.
+class TextureArray {
+   public:
+    TextureArray() = default;
+    ~TextureArray() { destroy(); }
+
+    // non-copyable, movable
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    TextureArray(TextureArray&& other) noexcept { *this = std::move(other); }
+    TextureArray& operator=(TextureArray&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            id_ = std::exchange(other.id_, 0);
+            w_ = other.w_;
+            h_ = other.h_;
+            layers_ = other.layers_;
+        }
+        return *this;
+    }
+
+    // layers of w x h RGBA8, contents undefined until set
+    bool create(int w, int h, int layers);
+    // false if the image is not w x h or layer is out of range
+    bool setLayer(int layer, const Image& image);
+    // w x h RGBA8 pixels, row 0 at the bottom (as they are stored in GL)
+    bool setLayer(int layer, const void* rgba);
+    void destroy();
+
+    GLuint id() const { return id_; }
+    int width() const { return w_; }
+    int height() const { return h_; }
+    int layers() const { return layers_; }
+    explicit operator bool() const { return id_ != 0; }
+
+   private:
+    bool setLayer(int layer, const void* pixels, GLenum format);
+
+    GLuint id_ = 0;
+    int w_ = 0, h_ = 0, layers_ = 0;
+};
\ No newline at end of file
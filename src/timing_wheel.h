@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Hashed timing wheel: scheduling is O(1) and each tick only visits the one bucket that
+// can hold entries due then. Entries further out than the wheel's span simply stay in
+// their bucket for more laps. Nothing is ever cancelled; callers drop stale entries
+// when they fire.
+class TimingWheel {
+   public:
+    static constexpr int kSlots = 512;
+
+    void schedule(std::uint32_t id, std::uint64_t due) {
+        buckets[due % kSlots].push_back({id, due});
+        ++count;
+    }
+
+    // Calls fn(id, due) for every entry due at or before tick in tick's bucket
+    template <class F>
+    void advance(std::uint64_t tick, F&& fn) {
+        std::vector<Entry>& bucket = buckets[tick % kSlots];
+        for (std::size_t i = 0; i < bucket.size();) {
+            if (bucket[i].due > tick) {
+                ++i;
+                continue;
+            }
+            const Entry e = bucket[i];
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            --count;
+            fn(e.id, e.due);
+        }
+    }
+
+    void clear() {
+        for (auto& b : buckets) b.clear();
+        count = 0;
+    }
+    int size() const { return count; }
+
+   private:
+    struct Entry {
+        std::uint32_t id;
+        std::uint64_t due;
+    };
+
+    std::vector<Entry> buckets[kSlots];
+    int count = 0;
+};
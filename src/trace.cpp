@@ -0,0 +1,149 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <print>
+#include <string>
+#include <vector>
+
+#include "alloc_tracker.h"
+
+// ----------------------------- buffers -------------------------------
+
+namespace {
+// single-producer ring: only the owning thread writes, dump() reads
+struct ThreadBuffer {
+    Trace::Event events[Trace::kEventsPerThread];
+    std::atomic<std::uint64_t> head{0};  // total events ever written
+    std::uint32_t tid = 0;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;  // only taken on thread registration and dump
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::uint32_t nextTid = 1;
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+thread_local ThreadBuffer* localBufferPtr = nullptr;
+thread_local std::string localName;  // applied when the buffer is created
+
+// buffers are created on first event (idle threads cost nothing) and owned
+// by the registry so events survive thread exit
+ThreadBuffer& localBuffer() {
+    if (!localBufferPtr) {
+        ALLOC_TAG(Static);
+        auto owned = std::make_unique<ThreadBuffer>();
+        Registry& r = registry();
+        std::lock_guard lock(r.mutex);
+        owned->tid = r.nextTid++;
+        owned->name = localName.empty() ? "thread " + std::to_string(owned->tid) : localName;
+        r.buffers.push_back(std::move(owned));
+        localBufferPtr = r.buffers.back().get();
+    }
+    return *localBufferPtr;
+}
+
+void writeEscaped(FILE* f, const char* s) {
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            std::fputc('\\', f);
+        std::fputc(*s, f);
+    }
+}
+}  // namespace
+
+// ----------------------------- trace ---------------------------------
+
+void Trace::setRecording(bool on) {
+#if ENABLE_TRACE
+    recordingFlag.store(on, std::memory_order_relaxed);
+#else
+    (void)on;
+#endif
+}
+
+void Trace::setThreadName(const char* name) {
+    localName = name;
+    if (localBufferPtr) {
+        std::lock_guard lock(registry().mutex);
+        localBufferPtr->name = name;
+    }
+}
+
+void Trace::record(const char* name, std::int64_t startNs, std::int64_t endNs) {
+    ThreadBuffer& b = localBuffer();
+    const std::uint64_t h = b.head.load(std::memory_order_relaxed);
+    b.events[h & (kEventsPerThread - 1)] = {name, startNs, endNs - startNs};
+    b.head.store(h + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const char* path) {
+    FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        std::println(stderr, "Could not open trace file at path {}", path);
+        return false;
+    }
+
+    Registry& r = registry();
+    std::lock_guard lock(r.mutex);
+
+    // timestamps relative to the earliest event so the viewer opens at zero
+    std::vector<Event> events;
+    std::vector<std::uint32_t> tids;
+    for (const auto& b : r.buffers) {
+        const std::uint64_t end = b->head.load(std::memory_order_acquire);
+        const std::uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+        const std::size_t first = events.size();
+        for (std::uint64_t i = begin; i < end; ++i) {
+            events.push_back(b->events[i & (kEventsPerThread - 1)]);
+            tids.push_back(b->tid);
+        }
+
+        // Best effort: the copy is plain reads racing the producer, so drop the slots it
+        // may have touched meanwhile, the one it is writing now (event after, which
+        // shares a slot with after - kEventsPerThread) included. The fence keeps the
+        // copy's reads ahead of the second head load.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = b->head.load(std::memory_order_relaxed);
+        const std::uint64_t safeBegin = after + 1 > kEventsPerThread ? after + 1 - kEventsPerThread : 0;
+        if (safeBegin > begin) {
+            const std::size_t torn = static_cast<std::size_t>(std::min(safeBegin - begin, end - begin));
+            events.erase(events.begin() + first, events.begin() + first + torn);
+            tids.erase(tids.begin() + first, tids.begin() + first + torn);
+        }
+    }
+
+    std::int64_t origin = INT64_MAX;
+    for (const Event& e : events) origin = std::min(origin, e.startNs);
+
+    std::print(f, "{{\"traceEvents\":[\n");
+    bool first = true;
+    for (const auto& b : r.buffers) {
+        std::print(f, "{}{{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"",
+                   first ? "" : ",\n", b->tid);
+        writeEscaped(f, b->name.c_str());
+        std::print(f, "\"}}}}");
+        first = false;
+    }
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        std::print(f, "{}{{\"ph\":\"X\",\"name\":\"", first ? "" : ",\n");
+        writeEscaped(f, e.name);
+        std::print(f, "\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", tids[i],
+                   static_cast<double>(e.startNs - origin) / 1000.0, static_cast<double>(e.durNs) / 1000.0);
+        first = false;
+    }
+    std::print(f, "\n],\"displayTimeUnit\":\"ms\"}}\n");
+
+    std::fclose(f);
+    std::println("Wrote {} trace events to {}", events.size(), path);
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Build with -DENABLE_TRACE=0 to compile every TRACE_SCOPE out of the binary.
+#ifndef ENABLE_TRACE
+#define ENABLE_TRACE 1
+#endif
+
+// Chrome trace / Perfetto recorder.
+// Each thread writes complete ("X") events into its own fixed-size ring buffer without locks;
+// dump() snapshots every ring and writes chrome://tracing compatible JSON.
+class Trace {
+   public:
+    static constexpr int kEventsPerThread = 1 << 14;  // power of two
+
+    struct Event {
+        const char* name;  // must outlive the trace (string literal)
+        std::int64_t startNs;
+        std::int64_t durNs;
+    };
+
+    // One relaxed load: this is all a disabled TRACE_SCOPE costs.
+    static bool recording() { return recordingFlag.load(std::memory_order_relaxed); }
+    static void setRecording(bool on);
+
+    // Label the calling thread in the exported trace.
+    static void setThreadName(const char* name);
+
+    static std::int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static void record(const char* name, std::int64_t startNs, std::int64_t endNs);
+
+    // Write everything currently in the rings as Chrome trace JSON. Threads may keep
+    // recording meanwhile; the oldest events they overwrite during the copy are left out.
+    static bool dump(const char* path);
+
+   private:
+    static inline std::atomic<bool> recordingFlag{false};
+};
+
+class TraceScope {
+   public:
+    explicit TraceScope(const char* name) : name(name), startNs(Trace::recording() ? Trace::nowNs() : 0) {}
+    ~TraceScope() {
+        if (startNs != 0) Trace::record(name, startNs, Trace::nowNs());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+   private:
+    const char* name;
+    std::int64_t startNs;
+};
+
+#if ENABLE_TRACE
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,319 @@
+#include "ui.h"
+
+#include <algorithm>
+
+#include "font.h"
+
+namespace {
+// rgb scaled, for hover / press feedback on a custom-colored button
+Color shade(Color c, float k) {
+    return {std::min(c.r * k, 1.f), std::min(c.g * k, 1.f), std::min(c.b * k, 1.f), c.a};
+}
+}  // namespace
+
+UiTree::UiTree(Font& font, UiStyle style) : font_(&font), style(style) {
+    add(UiKind::Panel, kNone, {0.f, 0.f, 0.f, 0.f});  // root: the whole window, draws nothing
+}
+
+// ----------------------------- building ------------------------------
+
+UiId UiTree::add(UiKind kind, UiId parent, Rect local) {
+    const auto id = static_cast<UiId>(nodes.size());
+    Node& n = nodes.emplace_back();
+    n.kind = kind;
+    n.parent = parent;
+    n.local = local;
+    if (parent != kNone) nodes[parent].children.push_back(id);
+    markLayout(id);
+    orderDirty = true;
+    return id;
+}
+
+UiId UiTree::addPanel(UiId parent, Rect rect) {
+    return add(UiKind::Panel, parent, rect);
+}
+
+UiId UiTree::addButton(UiId parent, Rect rect, std::string_view text) {
+    const UiId id = add(UiKind::Button, parent, rect);
+    nodes[id].text = text;
+    return id;
+}
+
+UiId UiTree::addLabel(UiId parent, Vec2 pos, std::string_view text) {
+    const UiId id = add(UiKind::Label, parent, {pos.x, pos.y, 0.f, 0.f});
+    nodes[id].text = text;
+    return id;
+}
+
+UiId UiTree::addGrid(UiId parent, Rect rect, int columns, Vec2 cell, float spacing) {
+    const UiId id = add(UiKind::Grid, parent, rect);
+    nodes[id].columns = std::max(columns, 1);
+    nodes[id].cell = cell;
+    nodes[id].spacing = spacing;
+    return id;
+}
+
+UiId UiTree::addTooltip(UiId target, std::string_view text) {
+    // under the root, so it is never clipped or covered by the target's siblings
+    const UiId id = add(UiKind::Tooltip, root(), {0.f, 0.f, 0.f, 0.f});
+    nodes[id].text = text;
+    nodes[id].target = target;
+    nodes[id].visible = false;
+    tooltips.push_back(id);
+    return id;
+}
+
+void UiTree::setText(UiId id, std::string_view text) {
+    Node& n = nodes[id];
+    if (n.text == text) return;
+    n.text = text;
+    // labels and tooltips are sized by their text
+    if (n.kind == UiKind::Label || n.kind == UiKind::Tooltip)
+        markLayout(id);
+    else
+        markVisual(id);
+}
+
+void UiTree::setRect(UiId id, Rect rect) {
+    Node& n = nodes[id];
+    if (n.local.x == rect.x && n.local.y == rect.y && n.local.w == rect.w && n.local.h == rect.h) return;
+    n.local = rect;
+    markLayout(id);
+}
+
+void UiTree::setColor(UiId id, Color color) {
+    Node& n = nodes[id];
+    if (n.customColor && n.color.r == color.r && n.color.g == color.g && n.color.b == color.b && n.color.a == color.a)
+        return;
+    n.color = color;
+    n.customColor = true;
+    markVisual(id);
+}
+
+void UiTree::setVisible(UiId id, bool visible) {
+    if (nodes[id].visible == visible) return;
+    nodes[id].visible = visible;
+    orderDirty = true;
+}
+
+void UiTree::markLayout(UiId id) {
+    if (nodes[id].layoutDirty) return;
+    nodes[id].layoutDirty = true;
+    dirtyLayout.push_back(id);
+}
+
+void UiTree::markVisual(UiId id) {
+    if (nodes[id].visualDirty) return;
+    nodes[id].visualDirty = true;
+    dirtyVisual.push_back(id);
+}
+
+bool UiTree::shown(UiId id) const {
+    for (; id != kNone; id = nodes[id].parent)
+        if (!nodes[id].visible) return false;
+    return true;
+}
+
+// ----------------------------- input ---------------------------------
+
+bool UiTree::pointer(Vec2 pos, bool down) {
+    clicked.clear();
+    if (pos == lastPointer && down == lastDown) return overUi;
+
+    // topmost node under the pointer, then the button it belongs to
+    UiId hit = kNone;
+    for (auto it = drawOrder.rbegin(); it != drawOrder.rend(); ++it) {
+        if (nodes[*it].kind != UiKind::Tooltip && contains(nodes[*it].screen, pos)) {
+            hit = *it;
+            break;
+        }
+    }
+    overUi = hit != kNone && hit != root();
+    UiId button = hit;
+    while (button != kNone && nodes[button].kind != UiKind::Button) button = nodes[button].parent;
+
+    if (button != hoveredNode) {
+        for (const UiId id : {hoveredNode, button}) {
+            if (id == kNone) continue;
+            nodes[id].hovered = id == button;
+            markVisual(id);
+        }
+        for (const UiId t : tooltips) setVisible(t, nodes[t].target == button);
+        hoveredNode = button;
+    }
+
+    if (down && !lastDown && hoveredNode != kNone) {
+        pressedNode = hoveredNode;
+        nodes[pressedNode].pressed = true;
+        markVisual(pressedNode);
+    } else if (!down && lastDown && pressedNode != kNone) {
+        nodes[pressedNode].pressed = false;
+        markVisual(pressedNode);
+        if (pressedNode == hoveredNode) clicked.push_back(pressedNode);
+        pressedNode = kNone;
+    }
+
+    lastPointer = pos;
+    lastDown = down;
+    return overUi;
+}
+
+// ----------------------------- update --------------------------------
+
+void UiTree::update(Vec2 viewport) {
+    if (viewport != this->viewport) {
+        this->viewport = viewport;
+        pixelToClip = (viewport.x > 0.f && viewport.y > 0.f) ? Vec2{2.f / viewport.x, 2.f / viewport.y} : Vec2{};
+        markLayout(root());  // every vertex is in clip space
+    }
+    if (dirtyLayout.empty() && dirtyVisual.empty() && !orderDirty) return;
+    rebuiltNodes = 0;
+
+    if (!dirtyLayout.empty()) {
+        // by index, as layout() may not add to the list but the list may hold a node
+        // whose ancestor's layout already covered it
+        for (std::size_t i = 0; i < dirtyLayout.size(); ++i)
+            if (nodes[dirtyLayout[i]].layoutDirty) layout(dirtyLayout[i]);
+        dirtyLayout.clear();
+        // tooltips follow their targets wherever those moved
+        for (const UiId t : tooltips) layout(t);
+    }
+
+    for (const UiId id : dirtyVisual) {
+        Node& n = nodes[id];
+        n.visualDirty = false;
+        const std::size_t before = n.quads.size();
+        build(id);
+        ++rebuiltNodes;
+        if (orderDirty || !shown(id)) continue;
+        if (n.quads.size() != before) {
+            orderDirty = true;
+            continue;
+        }
+        // same shape: patch in place, and only this range needs uploading
+        std::copy(n.quads.begin(), n.quads.end(), verts.begin() + n.firstVertex);
+        const auto end = n.firstVertex + static_cast<std::uint32_t>(n.quads.size());
+        if (dirtyFrom == dirtyTo) {
+            dirtyFrom = n.firstVertex;
+            dirtyTo = end;
+        } else {
+            dirtyFrom = std::min(dirtyFrom, n.firstVertex);
+            dirtyTo = std::max(dirtyTo, end);
+        }
+    }
+    dirtyVisual.clear();
+
+    if (orderDirty) concatenate();
+}
+
+void UiTree::layout(UiId id) {
+    Node& n = nodes[id];
+    const Rect parent = n.parent == kNone ? Rect{0.f, 0.f, viewport.x, viewport.y} : nodes[n.parent].screen;
+
+    if (n.kind == UiKind::Tooltip) {
+        const Rect target = nodes[n.target].screen;
+        const Vec2 text = font_->measure(n.text, style.textSize);
+        n.screen = {target.x + target.w * 0.5f, target.y + target.h + style.padding, text.x + 2.f * style.padding,
+                    text.y + 2.f * style.padding};
+    } else if (n.parent != kNone && nodes[n.parent].kind == UiKind::Grid) {
+        const Node& grid = nodes[n.parent];
+        const auto index = static_cast<int>(std::find(grid.children.begin(), grid.children.end(), id) -
+                                            grid.children.begin());
+        const Vec2 pitch = grid.cell + Vec2{grid.spacing, grid.spacing};
+        n.screen = {parent.x + grid.spacing + static_cast<float>(index % grid.columns) * pitch.x,
+                    parent.y + grid.spacing + static_cast<float>(index / grid.columns) * pitch.y, grid.cell.x,
+                    grid.cell.y};
+    } else if (n.kind == UiKind::Label) {
+        const Vec2 text = font_->measure(n.text, style.textSize);
+        n.screen = {parent.x + n.local.x, parent.y + n.local.y, text.x, text.y};
+    } else if (n.parent == kNone) {
+        n.screen = parent;
+    } else {
+        n.screen = {parent.x + n.local.x, parent.y + n.local.y, n.local.w, n.local.h};
+    }
+
+    n.layoutDirty = false;
+    markVisual(id);
+    for (const UiId c : nodes[id].children) layout(c);
+}
+
+void UiTree::build(UiId id) {
+    Node& n = nodes[id];
+    n.quads.clear();
+    const Rect solid = font_->solidUV();
+    const Color white{1.f, 1.f, 1.f, 1.f};
+
+    switch (n.kind) {
+        case UiKind::Panel:
+        case UiKind::Grid:
+            if (id != root()) appendQuad(n.quads, n.screen, solid, n.customColor ? n.color : style.panel, false);
+            break;
+        case UiKind::Button: {
+            Color fill = n.customColor ? n.color : style.button;
+            if (n.pressed)
+                fill = n.customColor ? shade(fill, 0.75f) : style.pressed;
+            else if (n.hovered)
+                fill = n.customColor ? shade(fill, 1.25f) : style.hovered;
+            appendQuad(n.quads, n.screen, solid, fill, false);
+            const Vec2 text = font_->measure(n.text, style.textSize);
+            appendText(n.quads, n.text, center(n.screen) - text * 0.5f, style.text);
+            break;
+        }
+        case UiKind::Label:
+            appendText(n.quads, n.text, {n.screen.x, n.screen.y}, n.customColor ? n.color : style.text);
+            break;
+        case UiKind::Tooltip:
+            appendQuad(n.quads, n.screen, solid, style.tooltip, false);
+            appendText(n.quads, n.text, {n.screen.x + style.padding, n.screen.y + style.padding}, white);
+            break;
+    }
+}
+
+void UiTree::appendQuad(std::vector<SpriteBatch::Vertex>& out, Rect px, Rect uv, Color color, bool sdf) const {
+    const float x0 = -1.f + px.x * pixelToClip.x, x1 = x0 + px.w * pixelToClip.x;
+    const float top = 1.f - px.y * pixelToClip.y, bottom = top - px.h * pixelToClip.y;
+    const float u0 = uv.x, u1 = uv.x + uv.w;
+    const float v0 = uv.y, v1 = uv.y + uv.h;  // v up
+    const float d = sdf ? 1.f : 0.f;
+    // the sprite batch's corner order (RT, RB, LB, LT), so its index buffer applies
+    out.push_back({x1, top, u1, v1, color, d});
+    out.push_back({x1, bottom, u1, v0, color, d});
+    out.push_back({x0, bottom, u0, v0, color, d});
+    out.push_back({x0, top, u0, v1, color, d});
+}
+
+void UiTree::appendText(std::vector<SpriteBatch::Vertex>& out, std::string_view text, Vec2 pos, Color color) const {
+    const bool sdf = font_->mode() == FontMode::Sdf;
+    const float size = style.textSize;
+    for (const ShapedText::Quad& q : font_->shape(text).quads)
+        appendQuad(out, {pos.x + q.rect.x * size, pos.y + q.rect.y * size, q.rect.w * size, q.rect.h * size}, q.uv,
+                   color, sdf);
+}
+
+void UiTree::concatenate() {
+    verts.clear();
+    drawOrder.clear();
+    concatenate(root());
+    for (const UiId t : tooltips)
+        if (nodes[t].visible && shown(nodes[t].target)) concatenate(t);
+
+    orderDirty = false;
+    resized_ = true;
+    dirtyFrom = 0;
+    dirtyTo = static_cast<std::uint32_t>(verts.size());
+}
+
+void UiTree::concatenate(UiId id) {
+    Node& n = nodes[id];
+    if (!n.visible) return;
+    n.firstVertex = static_cast<std::uint32_t>(verts.size());
+    verts.insert(verts.end(), n.quads.begin(), n.quads.end());
+    drawOrder.push_back(id);
+    for (const UiId c : n.children)
+        if (nodes[c].kind != UiKind::Tooltip) concatenate(c);
+}
+
+void UiTree::markUploaded() {
+    resized_ = false;
+    dirtyFrom = dirtyTo = 0;
+}
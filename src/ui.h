@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sprite_batch.h"
+#include "util.h"
+
+class Font;
+
+using UiId = std::uint32_t;
+
+enum class UiKind : std::uint8_t {
+    Panel,    // flat rect, holds other nodes
+    Button,   // rect with centered text; hover / press colors, reports clicks
+    Label,    // text only
+    Grid,     // panel that places its children in equal cells, row by row (inventories)
+    Tooltip,  // text box shown next to its target while the pointer is over it
+};
+
+struct UiStyle {
+    Color panel = {0.12f, 0.12f, 0.14f, 0.85f};
+    Color button = {0.25f, 0.32f, 0.22f, 1.f};
+    Color hovered = {0.35f, 0.45f, 0.3f, 1.f};
+    Color pressed = {0.18f, 0.24f, 0.16f, 1.f};
+    Color text = {1.f, 1.f, 1.f, 1.f};
+    Color tooltip = {0.05f, 0.05f, 0.05f, 0.95f};
+    float textSize = 12.f;  // px, a glyph's height
+    float padding = 4.f;    // px
+};
+
+// Retained game UI. Nodes keep their layout and their quads (sprite batch vertices, in
+// clip space) between frames; changing a node only marks it dirty, and update() redoes
+// just the dirty nodes' layout and vertices. When the vertex count stays the same the
+// new ones are patched into place and only that range needs uploading, so a screen
+// where nothing changed costs a flag check (Renderer::drawUi then skips the upload too).
+//
+// Positions and sizes are window pixels from the top left, relative to the parent.
+// Everything draws with the font's atlas, in pre-order (later siblings on top), with
+// tooltips last. Node ids stay valid for the tree's lifetime; nodes are hidden rather
+// than removed.
+class UiTree {
+   public:
+    explicit UiTree(Font& font, UiStyle style = {});
+
+    UiId root() const { return 0; }
+
+    UiId addPanel(UiId parent, Rect rect);
+    UiId addButton(UiId parent, Rect rect, std::string_view text);
+    UiId addLabel(UiId parent, Vec2 pos, std::string_view text);
+    // rect.w / rect.h are ignored for a grid's children
+    UiId addGrid(UiId parent, Rect rect, int columns, Vec2 cell, float spacing);
+    UiId addTooltip(UiId target, std::string_view text);
+
+    // Each marks the node dirty only if the value actually changes
+    void setText(UiId id, std::string_view text);
+    void setRect(UiId id, Rect rect);
+    void setColor(UiId id, Color color);  // overrides the style's fill
+    void setVisible(UiId id, bool visible);
+    bool visible(UiId id) const { return nodes[id].visible; }
+    Rect screenRect(UiId id) const { return nodes[id].screen; }
+
+    // Pointer in window pixels. Updates hover / press state and records a click when the
+    // button is released over the node it went down on. Returns whether the pointer is
+    // over a visible panel, so the game can ignore it.
+    bool pointer(Vec2 pos, bool down);
+    // Buttons clicked by the last pointer() call
+    std::span<const UiId> clicks() const { return clicked; }
+
+    // Window size in pixels; a change rebuilds everything
+    void update(Vec2 viewport);
+
+    Font& font() const { return *font_; }
+    std::span<const SpriteBatch::Vertex> vertices() const { return verts; }  // four per quad
+    // Vertices changed since the last markUploaded(); resized means the array itself was
+    // rebuilt (upload all of it)
+    bool resized() const { return resized_; }
+    std::uint32_t dirtyBegin() const { return dirtyFrom; }
+    std::uint32_t dirtyEnd() const { return dirtyTo; }
+    void markUploaded();
+
+    int nodeCount() const { return static_cast<int>(nodes.size()); }
+    int lastRebuiltNodes() const { return rebuiltNodes; }  // by the last update that had work
+
+   private:
+    static constexpr UiId kNone = ~0u;
+
+    struct Node {
+        UiKind kind;
+        UiId parent;
+        std::vector<UiId> children;
+        Rect local;
+        Rect screen = {0.f, 0.f, 0.f, 0.f};
+        std::string text;
+        Color color;
+        bool customColor = false;
+        bool visible = true;
+        bool hovered = false, pressed = false;
+        bool layoutDirty = false, visualDirty = false;
+        // Grid
+        int columns = 1;
+        Vec2 cell = {0.f, 0.f};
+        float spacing = 0.f;
+        // Tooltip
+        UiId target = kNone;
+        // this node's quads, and where they sit in verts
+        std::vector<SpriteBatch::Vertex> quads;
+        std::uint32_t firstVertex = 0;
+    };
+
+    UiId add(UiKind kind, UiId parent, Rect local);
+    void markLayout(UiId id);
+    void markVisual(UiId id);
+    bool shown(UiId id) const;  // it and all its ancestors are visible
+    void layout(UiId id);       // it and its subtree
+    void build(UiId id);        // its quads from its state
+    void appendQuad(std::vector<SpriteBatch::Vertex>& out, Rect px, Rect uv, Color color, bool sdf) const;
+    void appendText(std::vector<SpriteBatch::Vertex>& out, std::string_view text, Vec2 pos, Color color) const;
+    void concatenate();
+    void concatenate(UiId id);
+
+    Font* font_;
+    UiStyle style;
+    std::vector<Node> nodes;
+    std::vector<UiId> tooltips;
+    std::vector<UiId> dirtyLayout, dirtyVisual;
+    bool orderDirty = true;  // quad counts or draw order changed: rebuild verts whole
+
+    std::vector<SpriteBatch::Vertex> verts;
+    std::vector<UiId> drawOrder;  // the nodes in verts, bottom to top
+    std::uint32_t dirtyFrom = 0, dirtyTo = 0;
+    bool resized_ = true;
+    Vec2 viewport = {0.f, 0.f};
+    Vec2 pixelToClip = {0.f, 0.f};
+    int rebuiltNodes = 0;
+
+    // pointer
+    Vec2 lastPointer = {-1.f, -1.f};
+    bool lastDown = false;
+    UiId hoveredNode = kNone, pressedNode = kNone;
+    bool overUi = false;
+    std::vector<UiId> clicked;
+};
@@ -6,12 +6,24 @@
 struct Vec2 {
     float x;
     float y;
+
+    constexpr Vec2& operator+=(Vec2 o) { x += o.x; y += o.y; return *this; }
+    constexpr Vec2& operator-=(Vec2 o) { x -= o.x; y -= o.y; return *this; }
+    constexpr Vec2& operator*=(float s) { x *= s; y *= s; return *this; }
+    constexpr Vec2& operator/=(float s) { x /= s; y /= s; return *this; }
+    constexpr bool operator==(const Vec2&) const = default;
 };
 
 struct Vec3 {
     float x;
     float y;
     float z;
+
+    constexpr Vec3& operator+=(Vec3 o) { x += o.x; y += o.y; z += o.z; return *this; }
+    constexpr Vec3& operator-=(Vec3 o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+    constexpr Vec3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+    constexpr Vec3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+    constexpr bool operator==(const Vec3&) const = default;
 };
 
 struct Vec4 {
@@ -19,8 +31,68 @@ struct Vec4 {
     float y;
     float z;
     float w;
+
+    constexpr Vec4& operator+=(Vec4 o) { x += o.x; y += o.y; z += o.z; w += o.w; return *this; }
+    constexpr Vec4& operator-=(Vec4 o) { x -= o.x; y -= o.y; z -= o.z; w -= o.w; return *this; }
+    constexpr Vec4& operator*=(float s) { x *= s; y *= s; z *= s; w *= s; return *this; }
+    constexpr Vec4& operator/=(float s) { x /= s; y /= s; z /= s; w /= s; return *this; }
+    constexpr bool operator==(const Vec4&) const = default;
 };
 
+// Arithmetic is component-wise; a * b between vectors is the component-wise product,
+// dot() the inner one
+constexpr Vec2 operator+(Vec2 a, Vec2 b) { return a += b; }
+constexpr Vec2 operator-(Vec2 a, Vec2 b) { return a -= b; }
+constexpr Vec2 operator-(Vec2 a) { return {-a.x, -a.y}; }
+constexpr Vec2 operator*(Vec2 a, float s) { return a *= s; }
+constexpr Vec2 operator*(float s, Vec2 a) { return a *= s; }
+constexpr Vec2 operator/(Vec2 a, float s) { return a /= s; }
+constexpr Vec2 operator*(Vec2 a, Vec2 b) { return {a.x * b.x, a.y * b.y}; }
+constexpr Vec2 operator/(Vec2 a, Vec2 b) { return {a.x / b.x, a.y / b.y}; }
+constexpr float dot(Vec2 a, Vec2 b) { return a.x * b.x + a.y * b.y; }
+constexpr float cross(Vec2 a, Vec2 b) { return a.x * b.y - a.y * b.x; }  // z of the 3D cross product
+constexpr Vec2 perp(Vec2 a) { return {-a.y, a.x}; }                       // rotated 90 degrees
+
+constexpr Vec3 operator+(Vec3 a, Vec3 b) { return a += b; }
+constexpr Vec3 operator-(Vec3 a, Vec3 b) { return a -= b; }
+constexpr Vec3 operator-(Vec3 a) { return {-a.x, -a.y, -a.z}; }
+constexpr Vec3 operator*(Vec3 a, float s) { return a *= s; }
+constexpr Vec3 operator*(float s, Vec3 a) { return a *= s; }
+constexpr Vec3 operator/(Vec3 a, float s) { return a /= s; }
+constexpr Vec3 operator*(Vec3 a, Vec3 b) { return {a.x * b.x, a.y * b.y, a.z * b.z}; }
+constexpr Vec3 operator/(Vec3 a, Vec3 b) { return {a.x / b.x, a.y / b.y, a.z / b.z}; }
+constexpr float dot(Vec3 a, Vec3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr Vec3 cross(Vec3 a, Vec3 b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+
+constexpr Vec4 operator+(Vec4 a, Vec4 b) { return a += b; }
+constexpr Vec4 operator-(Vec4 a, Vec4 b) { return a -= b; }
+constexpr Vec4 operator-(Vec4 a) { return {-a.x, -a.y, -a.z, -a.w}; }
+constexpr Vec4 operator*(Vec4 a, float s) { return a *= s; }
+constexpr Vec4 operator*(float s, Vec4 a) { return a *= s; }
+constexpr Vec4 operator/(Vec4 a, float s) { return a /= s; }
+constexpr Vec4 operator*(Vec4 a, Vec4 b) { return {a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w}; }
+constexpr Vec4 operator/(Vec4 a, Vec4 b) { return {a.x / b.x, a.y / b.y, a.z / b.z, a.w / b.w}; }
+constexpr float dot(Vec4 a, Vec4 b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+template <class V>
+constexpr V lerp(V a, V b, float t) {
+    return a + (b - a) * t;
+}
+template <class V>
+constexpr float lengthSquared(V a) {
+    return dot(a, a);
+}
+template <class V>
+float length(V a) {
+    return sqrtf(dot(a, a));
+}
+// Zero stays zero rather than turning into NaNs
+template <class V>
+V normalize(V a) {
+    const float len = length(a);
+    return len > 0.f ? a / len : a;
+}
+
 // sprite related
 struct Rect {
     float x;
@@ -29,9 +101,134 @@ struct Rect {
     float h;
 };
 
+constexpr Vec2 center(Rect r) { return {r.x + r.w * 0.5f, r.y + r.h * 0.5f}; }
+// Half-open: a point on the right or bottom edge is outside, so tiled rects never share one
+constexpr bool contains(Rect r, Vec2 p) { return p.x >= r.x && p.x < r.x + r.w && p.y >= r.y && p.y < r.y + r.h; }
+// Rects that only touch do not overlap
+constexpr bool overlaps(Rect a, Rect b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
 struct Color {
     float r;
     float g;
     float b;
     float a;
-};
\ No newline at end of file
+};
+
+// ----------------------------- matrices ------------------------------
+
+// Column-major like GLSL (m[column][row]), so glUniformMatrix*fv takes them untransposed
+struct Mat3 {
+    float m[3][3];
+
+    static constexpr Mat3 identity() { return {{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}}; }
+
+    constexpr Vec3 operator*(Vec3 v) const {
+        return {m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z, m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+                m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z};
+    }
+    constexpr Mat3 operator*(const Mat3& o) const {
+        Mat3 r{};
+        for (int c = 0; c < 3; ++c)
+            for (int row = 0; row < 3; ++row)
+                r.m[c][row] = m[0][row] * o.m[c][0] + m[1][row] * o.m[c][1] + m[2][row] * o.m[c][2];
+        return r;
+    }
+    constexpr Mat3 transposed() const {
+        Mat3 r{};
+        for (int c = 0; c < 3; ++c)
+            for (int row = 0; row < 3; ++row) r.m[c][row] = m[row][c];
+        return r;
+    }
+    constexpr bool operator==(const Mat3&) const = default;
+    const float* data() const { return &m[0][0]; }
+};
+
+struct Mat4 {
+    float m[4][4];
+
+    static constexpr Mat4 identity() { return {{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}}}; }
+    static constexpr Mat4 translation(Vec3 t) {
+        Mat4 r = identity();
+        r.m[3][0] = t.x;
+        r.m[3][1] = t.y;
+        r.m[3][2] = t.z;
+        return r;
+    }
+    static constexpr Mat4 scale(Vec3 s) { return {{{s.x, 0, 0, 0}, {0, s.y, 0, 0}, {0, 0, s.z, 0}, {0, 0, 0, 1}}}; }
+    // Maps [left, right] x [bottom, top] to clip space; bottom = height, top = 0 gives y-down pixels
+    static constexpr Mat4 ortho(float left, float right, float bottom, float top, float zNear = -1.f,
+                                float zFar = 1.f) {
+        Mat4 r = identity();
+        r.m[0][0] = 2.f / (right - left);
+        r.m[1][1] = 2.f / (top - bottom);
+        r.m[2][2] = -2.f / (zFar - zNear);
+        r.m[3][0] = -(right + left) / (right - left);
+        r.m[3][1] = -(top + bottom) / (top - bottom);
+        r.m[3][2] = -(zFar + zNear) / (zFar - zNear);
+        return r;
+    }
+
+    constexpr Vec4 operator*(Vec4 v) const {
+        float r[4]{};
+        for (int row = 0; row < 4; ++row)
+            r[row] = m[0][row] * v.x + m[1][row] * v.y + m[2][row] * v.z + m[3][row] * v.w;
+        return {r[0], r[1], r[2], r[3]};
+    }
+    constexpr Mat4 operator*(const Mat4& o) const {
+        Mat4 r{};
+        for (int c = 0; c < 4; ++c)
+            for (int row = 0; row < 4; ++row)
+                r.m[c][row] = m[0][row] * o.m[c][0] + m[1][row] * o.m[c][1] + m[2][row] * o.m[c][2] +
+                              m[3][row] * o.m[c][3];
+        return r;
+    }
+    constexpr Mat4 transposed() const {
+        Mat4 r{};
+        for (int c = 0; c < 4; ++c)
+            for (int row = 0; row < 4; ++row) r.m[c][row] = m[row][c];
+        return r;
+    }
+    constexpr bool operator==(const Mat4&) const = default;
+    const float* data() const { return &m[0][0]; }
+};
+
+// 2D affine transform: p' = (a*x + c*y + tx, b*x + d*y + ty). Composes right to left like
+// matrices, so (parent * local).apply(p) == parent.apply(local.apply(p)).
+struct Transform2D {
+    float a = 1, b = 0, c = 0, d = 1;
+    float tx = 0, ty = 0;
+
+    static constexpr Transform2D translation(Vec2 t) { return {1, 0, 0, 1, t.x, t.y}; }
+    static constexpr Transform2D scale(Vec2 s) { return {s.x, 0, 0, s.y, 0, 0}; }
+    static Transform2D rotation(float radians) {
+        const float s = sinf(radians), co = cosf(radians);
+        return {co, s, -s, co, 0, 0};
+    }
+    // Scale, then rotate, then move: how a sprite is usually placed
+    static Transform2D trs(Vec2 t, float radians, Vec2 s) {
+        return translation(t) * rotation(radians) * scale(s);
+    }
+
+    constexpr Vec2 apply(Vec2 p) const { return {a * p.x + c * p.y + tx, b * p.x + d * p.y + ty}; }
+    // Directions ignore the translation
+    constexpr Vec2 applyVector(Vec2 v) const { return {a * v.x + c * v.y, b * v.x + d * v.y}; }
+
+    constexpr Transform2D operator*(const Transform2D& o) const {
+        return {a * o.a + c * o.b,        b * o.a + d * o.b,        // first column
+                a * o.c + c * o.d,        b * o.c + d * o.d,        // second column
+                a * o.tx + c * o.ty + tx, b * o.tx + d * o.ty + ty};  // translation
+    }
+    constexpr float determinant() const { return a * d - b * c; }
+    // Undefined for a singular transform (determinant 0)
+    constexpr Transform2D inverse() const {
+        const float inv = 1.f / determinant();
+        const float ia = d * inv, ib = -b * inv, ic = -c * inv, id = a * inv;
+        return {ia, ib, ic, id, -(ia * tx + ic * ty), -(ib * tx + id * ty)};
+    }
+
+    constexpr Mat3 toMat3() const { return {{{a, b, 0}, {c, d, 0}, {tx, ty, 1}}}; }
+    constexpr Mat4 toMat4() const { return {{{a, b, 0, 0}, {c, d, 0, 0}, {0, 0, 1, 0}, {tx, ty, 0, 1}}}; }
+    constexpr bool operator==(const Transform2D&) const = default;
+};